@@ -5,7 +5,7 @@ import org.rehlds.flightrec.api.SimpleDecoderModule;
 public class RehldsDecodersModule extends SimpleDecoderModule {
 
     public RehldsDecodersModule() {
-        super("Rehlds decoders (built-in)", "0.2");
+        super("Rehlds decoders (built-in)", "0.3");
         registerDecoder(new FrameV1Decoder());
         registerDecoder(new FreeEntPrivateDataV1Decoder());
         registerDecoder(new AllocEntPrivateDataV1Decoder());
@@ -14,5 +14,6 @@ public class RehldsDecodersModule extends SimpleDecoderModule {
 
         registerDecoder(new LogV1Decoder());
         registerDecoder(new AllocEntPrivateDataV2Decoder());
+        registerDecoder(new FrameV3Decoder());
     }
 }
@@ -0,0 +1,557 @@
+/*
+*
+*    This program is free software; you can redistribute it and/or modify it
+*    under the terms of the GNU General Public License as published by the
+*    Free Software Foundation; either version 2 of the License, or (at
+*    your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful, but
+*    WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+*    General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program; if not, write to the Free Software Foundation,
+*    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+// Native decoder for rehlds flight recorder dumps (rehlds_flrec_dump output or a process core dump).
+// Mirrors the region scan and backward message walk of the Java decoder and prints per-frame timing
+// and private data allocation reports for the built-in rehlds messages.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+static const char* META_SIGNATURE = "REHLDS_FLIGHTREC_METAREHLDS_FLIGHTREC_METAREHLDS_FLIGHTREC_META:";
+static const char* DATA_SIGNATURE = "REHLDS_FLIGHTREC_DATAREHLDS_FLIGHTREC_DATAREHLDS_FLIGHTREC_DATA:";
+
+static const unsigned int META_REGION_HEADER = 128;
+static const unsigned int DATA_REGION_HEADER = 128;
+
+struct MessageDef {
+	std::string module;
+	std::string name;
+	uint32_t version;
+	bool inOut;
+};
+
+struct Message {
+	uint16_t id;
+	bool entrance;
+	const uint8_t* data;
+	unsigned int len;
+};
+
+struct FrameInfo {
+	int64_t frameId;
+	double realtime;
+	double wallStart;
+	double wallEnd;
+	bool hasEnd;
+	int allocs;
+	int frees;
+	int logLines;
+};
+
+struct Options {
+	const char* fileName;
+	bool printFrames;
+	bool printAllocs;
+	bool printLog;
+	double slowFrameMs;
+};
+
+static uint32_t g_Crc32cTable[256];
+
+static void Crc32c_Init() {
+	for (uint32_t i = 0; i < 256; i++) {
+		uint32_t crc = i;
+		for (int j = 0; j < 8; j++) {
+			crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78 : (crc >> 1);
+		}
+		g_Crc32cTable[i] = crc;
+	}
+}
+
+// Same as the engine's crc32c_t(0, ...): no initial value and no final xor
+static uint32_t Crc32c(const uint8_t* buf, size_t len) {
+	uint32_t crc = 0;
+	while (len--) {
+		crc = (crc >> 8) ^ g_Crc32cTable[(crc ^ *buf++) & 0xFF];
+	}
+	return crc;
+}
+
+template<typename T>
+static T ReadAt(const uint8_t* p) {
+	T v;
+	memcpy(&v, p, sizeof(T));
+	return v;
+}
+
+class CSizeBufReader {
+public:
+	CSizeBufReader(const uint8_t* data, size_t len) : m_Data(data), m_Len(len), m_Pos(0), m_Overflow(false) {
+	}
+
+	template<typename T>
+	T Read() {
+		if (m_Pos + sizeof(T) > m_Len) {
+			m_Overflow = true;
+			return T();
+		}
+
+		T v = ReadAt<T>(m_Data + m_Pos);
+		m_Pos += sizeof(T);
+		return v;
+	}
+
+	std::string ReadString() {
+		size_t start = m_Pos;
+		while (m_Pos < m_Len && m_Data[m_Pos]) {
+			m_Pos++;
+		}
+
+		if (m_Pos >= m_Len) {
+			m_Overflow = true;
+			return std::string((const char*)m_Data + start, m_Len - start);
+		}
+
+		return std::string((const char*)m_Data + start, (m_Pos++) - start);
+	}
+
+	bool IsOverflowed() const {
+		return m_Overflow;
+	}
+
+private:
+	const uint8_t* m_Data;
+	size_t m_Len;
+	size_t m_Pos;
+	bool m_Overflow;
+};
+
+class CFlightRecDump {
+public:
+	bool Load(const char* fileName);
+	bool Parse();
+
+	const MessageDef* GetDef(uint16_t id) const {
+		std::map<uint16_t, MessageDef>::const_iterator itr = m_Defs.find(id);
+		return (itr == m_Defs.end()) ? NULL : &itr->second;
+	}
+
+	const std::vector<Message>& GetMessages() const {
+		return m_Messages;
+	}
+
+private:
+	// Returns the offset of the last region with the given signature and a valid header checksum, or -1
+	long FindRegion(const char* signature, uint32_t* regionSize) const;
+	bool ParseMeta(const uint8_t* meta, uint32_t regionSize);
+
+	std::vector<uint8_t> m_File;
+	std::map<uint16_t, MessageDef> m_Defs;
+	std::vector<Message> m_Messages;
+
+	uint32_t m_Wpos;
+	uint32_t m_LastMsgBeginPos;
+	uint16_t m_CurMessage;
+};
+
+bool CFlightRecDump::Load(const char* fileName) {
+	FILE* fl = fopen(fileName, "rb");
+	if (!fl) {
+		fprintf(stderr, "Could not open '%s'\n", fileName);
+		return false;
+	}
+
+	uint8_t buf[65536];
+	size_t read;
+	while ((read = fread(buf, 1, sizeof(buf), fl)) > 0) {
+		m_File.insert(m_File.end(), buf, buf + read);
+	}
+
+	fclose(fl);
+	return true;
+}
+
+long CFlightRecDump::FindRegion(const char* signature, uint32_t* regionSize) const {
+	size_t sigLen = strlen(signature);
+	long found = -1;
+
+	if (m_File.size() < sigLen + 12) {
+		return -1;
+	}
+
+	const uint8_t* base = &m_File[0];
+	for (size_t pos = 0; pos + sigLen + 12 <= m_File.size(); pos++) {
+		if (base[pos] != (uint8_t)signature[0] || memcmp(base + pos, signature, sigLen)) {
+			continue;
+		}
+
+		uint32_t size = ReadAt<uint32_t>(base + pos + sigLen + 4);
+		uint32_t crc = ReadAt<uint32_t>(base + pos + sigLen + 8);
+		if (crc != Crc32c(base + pos, sigLen + 8)) {
+			fprintf(stderr, "Region header at 0x%lx: checksum mismatch, skipped\n", (unsigned long)pos);
+			continue;
+		}
+
+		if (pos + size > m_File.size()) {
+			fprintf(stderr, "Region header at 0x%lx: region lays outside the file, skipped\n", (unsigned long)pos);
+			continue;
+		}
+
+		found = (long)pos;
+		*regionSize = size;
+	}
+
+	return found;
+}
+
+bool CFlightRecDump::ParseMeta(const uint8_t* meta, uint32_t regionSize) {
+	size_t sigLen = strlen(META_SIGNATURE);
+	CSizeBufReader header(meta + sigLen, META_REGION_HEADER - sigLen);
+	header.Read<uint32_t>(); // version
+	header.Read<uint32_t>(); // regionSize
+	header.Read<uint32_t>(); // headerCrc32
+	uint32_t numMessages = header.Read<uint32_t>();
+	uint32_t metaRegionPos = header.Read<uint32_t>();
+
+	m_Wpos = header.Read<uint32_t>();
+	m_LastMsgBeginPos = header.Read<uint32_t>();
+	m_CurMessage = header.Read<uint16_t>();
+
+	if (metaRegionPos > regionSize - META_REGION_HEADER) {
+		fprintf(stderr, "Corrupted meta region: definitions size %u\n", metaRegionPos);
+		return false;
+	}
+
+	CSizeBufReader defs(meta + META_REGION_HEADER, metaRegionPos);
+	for (uint32_t i = 0; i < numMessages; i++) {
+		uint8_t kind = defs.Read<uint8_t>();
+		if (kind != 1) { // MRT_MESSAGE_DEF
+			fprintf(stderr, "Invalid meta definition type %u\n", kind);
+			return false;
+		}
+
+		MessageDef def;
+		uint16_t id = defs.Read<uint16_t>();
+		def.module = defs.ReadString();
+		def.name = defs.ReadString();
+		def.version = defs.Read<uint32_t>();
+		def.inOut = defs.Read<uint8_t>() != 0;
+
+		if (defs.IsOverflowed()) {
+			fprintf(stderr, "Corrupted meta region: truncated definition #%u\n", i);
+			return false;
+		}
+
+		m_Defs[id] = def;
+	}
+
+	return true;
+}
+
+bool CFlightRecDump::Parse() {
+	uint32_t metaSize, dataSize;
+	long metaPos = FindRegion(META_SIGNATURE, &metaSize);
+	long dataPos = FindRegion(DATA_SIGNATURE, &dataSize);
+	if (metaPos < 0 || dataPos < 0) {
+		fprintf(stderr, "No valid flight recorder regions found\n");
+		return false;
+	}
+
+	if (metaSize < META_REGION_HEADER || dataSize < DATA_REGION_HEADER || !ParseMeta(&m_File[metaPos], metaSize)) {
+		return false;
+	}
+
+	const uint8_t* data = &m_File[dataPos];
+	int32_t prevItrLastPos = ReadAt<int32_t>(data + strlen(DATA_SIGNATURE) + 12);
+	const uint8_t* flightData = data + DATA_REGION_HEADER;
+	int32_t flightDataSize = dataSize - DATA_REGION_HEADER;
+	int32_t wpos = (int32_t)m_Wpos;
+
+	if (wpos > flightDataSize || prevItrLastPos > flightDataSize) {
+		fprintf(stderr, "Corrupted recorder state: wpos=%d prevItrLastPos=%d\n", wpos, prevItrLastPos);
+		return false;
+	}
+
+	// Each message is [opcode:2][data][length of opcode + data:2]; walk backwards from the write position,
+	// then from the end of the previous pass through the region down to the write position
+	int32_t curMsgPos = (m_CurMessage == 0) ? wpos : (int32_t)m_LastMsgBeginPos;
+	curMsgPos -= 2;
+	bool flippedToEnd = false;
+
+	while (true) {
+		if (flippedToEnd && curMsgPos <= wpos) {
+			break;
+		}
+
+		if (curMsgPos <= 0) {
+			if (prevItrLastPos == -1 || flippedToEnd) {
+				break;
+			}
+
+			curMsgPos = prevItrLastPos - 2;
+			flippedToEnd = true;
+			continue;
+		}
+
+		uint16_t msgLen = ReadAt<uint16_t>(flightData + curMsgPos);
+		int32_t msgStartPos = curMsgPos - msgLen;
+		if (msgLen < 2 || msgStartPos < 0) {
+			fprintf(stderr, "Corrupted data region: msgLen=%u at %d\n", msgLen, curMsgPos);
+			break;
+		}
+
+		if (flippedToEnd && msgStartPos < wpos) {
+			break;
+		}
+
+		uint16_t opc = ReadAt<uint16_t>(flightData + msgStartPos);
+		Message msg;
+		msg.id = opc & 0x7FFF;
+		msg.entrance = (opc & 0x8000) != 0;
+		msg.data = flightData + msgStartPos + 2;
+		msg.len = msgLen - 2;
+		m_Messages.push_back(msg);
+
+		curMsgPos = msgStartPos - 2;
+	}
+
+	std::reverse(m_Messages.begin(), m_Messages.end());
+	return true;
+}
+
+static double Percentile(std::vector<double> values, double fraction) {
+	if (values.empty()) {
+		return 0.0;
+	}
+
+	size_t idx = (size_t)(fraction * (values.size() - 1) + 0.5);
+	std::nth_element(values.begin(), values.begin() + idx, values.end());
+	return values[idx];
+}
+
+static void PrintTimeStats(const char* title, const std::vector<double>& values) {
+	if (values.empty()) {
+		return;
+	}
+
+	double sum = 0.0, maxVal = values[0], minVal = values[0];
+	for (size_t i = 0; i < values.size(); i++) {
+		sum += values[i];
+		maxVal = std::max(maxVal, values[i]);
+		minVal = std::min(minVal, values[i]);
+	}
+
+	printf("  %-16s min %8.3f  mean %8.3f  p50 %8.3f  p99 %8.3f  max %8.3f ms\n", title,
+		minVal, sum / values.size(), Percentile(values, 0.50), Percentile(values, 0.99), maxVal);
+}
+
+static bool IsMessage(const MessageDef* def, const char* name) {
+	return def && def->module == "rehlds" && def->name == name;
+}
+
+static int Decode(const CFlightRecDump& dump, const Options& opts) {
+	const std::vector<Message>& messages = dump.GetMessages();
+
+	std::vector<FrameInfo> frames;
+	std::map<uint16_t, int> msgCounts;
+	std::map<uint32_t, int32_t> liveAllocs;
+	std::map<int32_t, int> allocSizes;
+	int64_t totalAllocs = 0, totalFrees = 0, unknownFrees = 0, allocBytes = 0;
+	FrameInfo* curFrame = NULL;
+
+	for (size_t i = 0; i < messages.size(); i++) {
+		const Message& msg = messages[i];
+		const MessageDef* def = dump.GetDef(msg.id);
+		CSizeBufReader sb(msg.data, msg.len);
+		msgCounts[msg.id]++;
+
+		if (IsMessage(def, "Frame") && def->version >= 2) {
+			int64_t frameId = sb.Read<int64_t>();
+			if (msg.entrance) {
+				FrameInfo frame;
+				memset(&frame, 0, sizeof(frame));
+				frame.frameId = frameId;
+				frame.realtime = sb.Read<double>();
+				frame.wallStart = (def->version >= 3) ? sb.Read<double>() : 0.0;
+				frames.push_back(frame);
+				curFrame = &frames.back();
+			} else if (curFrame && curFrame->frameId == frameId) {
+				curFrame->wallEnd = (def->version >= 3) ? sb.Read<double>() : 0.0;
+				curFrame->hasEnd = def->version >= 3;
+				curFrame = NULL;
+			}
+		} else if (IsMessage(def, "AllocEntPrivateData") && def->version == 2) {
+			uint32_t ptr = sb.Read<uint32_t>();
+			int32_t size = sb.Read<int32_t>();
+			totalAllocs++;
+			allocBytes += size;
+			allocSizes[size]++;
+			liveAllocs[ptr] = size;
+			if (curFrame) {
+				curFrame->allocs++;
+			}
+
+			if (opts.printAllocs) {
+				printf("alloc 0x%08x %d\n", ptr, size);
+			}
+		} else if (IsMessage(def, "FreeEntPrivateData")) {
+			uint32_t ptr = sb.Read<uint32_t>();
+			totalFrees++;
+			if (!liveAllocs.erase(ptr)) {
+				unknownFrees++;
+			}
+			if (curFrame) {
+				curFrame->frees++;
+			}
+
+			if (opts.printAllocs) {
+				printf("free  0x%08x\n", ptr);
+			}
+		} else if (IsMessage(def, "Log")) {
+			std::string prefix = sb.ReadString();
+			std::string text = sb.ReadString();
+			if (curFrame) {
+				curFrame->logLines++;
+			}
+
+			if (opts.printLog) {
+				printf("[%s] %s%s", prefix.c_str(), text.c_str(), (!text.empty() && text[text.length() - 1] == '\n') ? "" : "\n");
+			}
+		}
+
+		if (sb.IsOverflowed()) {
+			fprintf(stderr, "Message #%u is shorter than its definition requires\n", (unsigned int)i);
+		}
+	}
+
+	printf("Messages: %u\n", (unsigned int)messages.size());
+	for (std::map<uint16_t, int>::const_iterator itr = msgCounts.begin(); itr != msgCounts.end(); ++itr) {
+		const MessageDef* def = dump.GetDef(itr->first);
+		if (def) {
+			printf("  %s:%s v%u%*s %d\n", def->module.c_str(), def->name.c_str(), def->version,
+				(int)(30 - def->module.length() - def->name.length()), "", itr->second);
+		} else {
+			printf("  <unknown #%u>%*s %d\n", itr->first, 22, "", itr->second);
+		}
+	}
+
+	std::vector<double> durations, intervals;
+	for (size_t i = 0; i < frames.size(); i++) {
+		const FrameInfo& frame = frames[i];
+		if (frame.hasEnd) {
+			durations.push_back((frame.wallEnd - frame.wallStart) * 1000.0);
+		}
+		if (i > 0) {
+			intervals.push_back((frame.realtime - frames[i - 1].realtime) * 1000.0);
+		}
+	}
+
+	printf("\nFrames: %u (%llu .. %llu)\n", (unsigned int)frames.size(),
+		frames.empty() ? 0ULL : (unsigned long long)frames.front().frameId,
+		frames.empty() ? 0ULL : (unsigned long long)frames.back().frameId);
+	PrintTimeStats("duration", durations);
+	PrintTimeStats("interval", intervals);
+
+	if (durations.empty() && !frames.empty()) {
+		printf("  (no frame durations: the dump was written by a server with Frame v2 messages)\n");
+	}
+
+	if (opts.printFrames) {
+		printf("\nframeId,realtime,durationMs,allocs,frees,logLines\n");
+		for (size_t i = 0; i < frames.size(); i++) {
+			const FrameInfo& frame = frames[i];
+			printf("%lld,%.6f,%.3f,%d,%d,%d\n", (long long)frame.frameId, frame.realtime,
+				frame.hasEnd ? (frame.wallEnd - frame.wallStart) * 1000.0 : 0.0, frame.allocs, frame.frees, frame.logLines);
+		}
+	} else if (!durations.empty()) {
+		int slowFrames = 0;
+		for (size_t i = 0; i < frames.size(); i++) {
+			const FrameInfo& frame = frames[i];
+			double duration = (frame.wallEnd - frame.wallStart) * 1000.0;
+			if (!frame.hasEnd || duration < opts.slowFrameMs) {
+				continue;
+			}
+
+			if (!slowFrames++) {
+				printf("  frames slower than %.1f ms:\n", opts.slowFrameMs);
+			}
+			printf("    #%lld  %8.3f ms  allocs %d  frees %d  log lines %d\n",
+				(long long)frame.frameId, duration, frame.allocs, frame.frees, frame.logLines);
+		}
+	}
+
+	printf("\nPrivate data: %lld allocs (%lld bytes), %lld frees (%lld of blocks allocated before the window), %u live\n",
+		(long long)totalAllocs, (long long)allocBytes, (long long)totalFrees, (long long)unknownFrees, (unsigned int)liveAllocs.size());
+
+	std::vector<std::pair<int, int32_t> > bySize;
+	for (std::map<int32_t, int>::const_iterator itr = allocSizes.begin(); itr != allocSizes.end(); ++itr) {
+		bySize.push_back(std::make_pair(itr->second, itr->first));
+	}
+	std::sort(bySize.rbegin(), bySize.rend());
+
+	for (size_t i = 0; i < bySize.size() && i < 10; i++) {
+		printf("  %8d bytes x %d\n", bySize[i].second, bySize[i].first);
+	}
+
+	return 0;
+}
+
+static void PrintUsage() {
+	printf("Usage: flightrec_decoder [-frames] [-allocs] [-log] [-slow <ms>] <dump file>\n");
+	printf("  -frames      print a CSV line per frame\n");
+	printf("  -allocs      print every private data alloc/free\n");
+	printf("  -log         print recorded console and log lines\n");
+	printf("  -slow <ms>   list frames longer than this (default 20)\n");
+}
+
+int main(int argc, char* argv[]) {
+	Options opts;
+	opts.fileName = NULL;
+	opts.printFrames = false;
+	opts.printAllocs = false;
+	opts.printLog = false;
+	opts.slowFrameMs = 20.0;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-frames")) {
+			opts.printFrames = true;
+		} else if (!strcmp(argv[i], "-allocs")) {
+			opts.printAllocs = true;
+		} else if (!strcmp(argv[i], "-log")) {
+			opts.printLog = true;
+		} else if (!strcmp(argv[i], "-slow") && i + 1 < argc) {
+			opts.slowFrameMs = atof(argv[++i]);
+		} else if (argv[i][0] != '-' && !opts.fileName) {
+			opts.fileName = argv[i];
+		} else {
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (!opts.fileName) {
+		PrintUsage();
+		return 1;
+	}
+
+	Crc32c_Init();
+
+	CFlightRecDump dump;
+	if (!dump.Load(opts.fileName) || !dump.Parse()) {
+		return 2;
+	}
+
+	return Decode(dump, opts);
+}
@@ -52,4 +52,22 @@ void MD5Final(unsigned char digest[16], MD5Context_t *ctx);
 void MD5Transform(unsigned int buf[4], const unsigned int in[16]);
 
 BOOL MD5_Hash_File(unsigned char digest[16], char *pszFileName, BOOL bUsefopen, BOOL bSeed, unsigned int seed[4]);
+
+#ifdef REHLDS_OPT_PEDANTIC
+typedef enum filehashtype_e
+{
+	FILEHASH_MD5,
+	FILEHASH_MAPCRC,
+} filehashtype_t;
+
+typedef struct filehash_s filehash_t;
+
+BOOL MD5_Hash_LocalFile(unsigned char digest[16], const char *pszLocalPath);
+filehash_t *FileHash_Lookup(const char *pszFileName, filehashtype_t type, qboolean *upToDate);
+void FileHash_StoreMD5(filehash_t *h, const unsigned char digest[16]);
+const unsigned char *FileHash_MD5(filehash_t *h);
+BOOL MD5_Hash_FileCached(unsigned char digest[16], char *pszFileName);
+int CRC_MapFileCached(CRC32_t *crcvalue, char *pszFileName);
+void FileHash_Stats(unsigned int *hits, unsigned int *misses);
+#endif // REHLDS_OPT_PEDANTIC
 char *MD5_Print(unsigned char hash[16]);
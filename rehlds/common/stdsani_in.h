@@ -0,0 +1,5 @@
+// Standard library headers included after mathlib.h or basetypes.h must not see their min and max macros
+#pragma push_macro("min")
+#pragma push_macro("max")
+#undef min
+#undef max
@@ -0,0 +1,2 @@
+#pragma pop_macro("max")
+#pragma pop_macro("min")
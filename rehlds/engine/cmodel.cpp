@@ -150,6 +150,207 @@ void CM_FreePAS(void)
 	gPVS = 0;
 }
 
+#ifdef REHLDS_OPT_PEDANTIC
+cvar_t sv_vis_diskcache = { "sv_vis_diskcache", "0", 0, 0.0f, NULL };
+
+#define VISCACHE_MAGIC		(('S' << 24) | ('I' << 16) | ('V' << 8) | 'R')
+#define VISCACHE_VERSION	1
+
+typedef struct viscacheheader_s
+{
+	int magic;
+	int version;
+	CRC32_t mapCRC;
+	int numleafs;
+	int rowbytes;
+} viscacheheader_t;
+
+typedef struct calcpas_s
+{
+	model_t *model;
+	int rows;
+	int count;
+	int rowwords;
+	int vcount[MAX_PARALLEL_THREADS];
+	int acount[MAX_PARALLEL_THREADS];
+} calcpas_t;
+
+void CM_VisCacheFileName(model_t *pModel, char *out, int size)
+{
+	char base[MAX_PATH];
+
+	COM_StripExtension(pModel->name, base);
+	Q_snprintf(out, size, "%s.viscache", base);
+	out[size - 1] = 0;
+}
+
+qboolean CM_LoadVisCache(model_t *pModel, CRC32_t mapCRC, int rowbytes)
+{
+	char name[MAX_PATH];
+	viscacheheader_t header;
+	int count = pModel->numleafs + 1;
+
+	CM_VisCacheFileName(pModel, name, sizeof(name));
+	FileHandle_t file = FS_Open(name, "rb");
+	if (!file)
+		return FALSE;
+
+	if (FS_Size(file) != sizeof(header) + 2 * rowbytes * count
+		|| FS_Read(&header, sizeof(header), 1, file) != sizeof(header)
+		|| header.magic != VISCACHE_MAGIC || header.version != VISCACHE_VERSION || header.mapCRC != mapCRC
+		|| header.numleafs != pModel->numleafs || header.rowbytes != rowbytes)
+	{
+		FS_Close(file);
+		return FALSE;
+	}
+
+	gPVS = (byte *)Mem_Malloc(rowbytes * count);
+	gPAS = (byte *)Mem_Malloc(rowbytes * count);
+	if (FS_Read(gPVS, rowbytes * count, 1, file) != rowbytes * count || FS_Read(gPAS, rowbytes * count, 1, file) != rowbytes * count)
+	{
+		FS_Close(file);
+		CM_FreePAS();
+		return FALSE;
+	}
+
+	FS_Close(file);
+	gPVSRowBytes = rowbytes;
+	Con_DPrintf("Loaded PVS/PAS from %s\n", name);
+	return TRUE;
+}
+
+void CM_SaveVisCache(model_t *pModel, CRC32_t mapCRC)
+{
+	char name[MAX_PATH];
+	viscacheheader_t header;
+	int count = pModel->numleafs + 1;
+
+	CM_VisCacheFileName(pModel, name, sizeof(name));
+	FileHandle_t file = FS_Open(name, "wb");
+	if (!file)
+	{
+		Con_DPrintf("%s: couldn't write %s\n", __FUNCTION__, name);
+		return;
+	}
+
+	header.magic = VISCACHE_MAGIC;
+	header.version = VISCACHE_VERSION;
+	header.mapCRC = mapCRC;
+	header.numleafs = pModel->numleafs;
+	header.rowbytes = gPVSRowBytes;
+
+	FS_Write(&header, sizeof(header), 1, file);
+	FS_Write(gPVS, gPVSRowBytes * count, 1, file);
+	FS_Write(gPAS, gPVSRowBytes * count, 1, file);
+	FS_Close(file);
+}
+
+void CM_DecompressPVSRows(void *arg, int first, int last, int thread)
+{
+	calcpas_t *ctx = (calcpas_t *)arg;
+	unsigned char *scan = &gPVS[first * gPVSRowBytes];
+
+	for (int i = first; i < last; i++, scan += gPVSRowBytes)
+	{
+		CM_DecompressPVS(ctx->model->leafs[i].compressed_vis, scan, ctx->rows);
+
+		if (i == 0)
+			continue;
+
+		for (int j = 0; j < ctx->count; j++)
+		{
+			if (scan[j >> 3] & (1 << (j & 7)))
+				ctx->vcount[thread]++;
+		}
+	}
+}
+
+void CM_BuildPASRows(void *arg, int first, int last, int thread)
+{
+	calcpas_t *ctx = (calcpas_t *)arg;
+	unsigned char *scan = &gPVS[first * gPVSRowBytes];
+	unsigned int *dest = (unsigned int *)&gPAS[first * gPVSRowBytes];
+
+	for (int i = first; i < last; i++, scan += gPVSRowBytes, dest += ctx->rowwords)
+	{
+		Q_memcpy(dest, scan, gPVSRowBytes);
+
+		for (int j = 0; j < gPVSRowBytes; j++)
+		{
+			int bitbyte = scan[j];
+			if (bitbyte == 0)
+				continue;
+
+			for (int k = 0; k < 8; k++)
+			{
+				if (!(bitbyte & (1 << k)))
+					continue;
+
+				int index = j * 8 + k + 1;
+				if (index >= ctx->count)
+					continue;
+
+				const unsigned int *src = (const unsigned int *)&gPVS[index * gPVSRowBytes];
+				int l = 0;
+				for (; l + 4 <= ctx->rowwords; l += 4)
+					_mm_storeu_si128((__m128i *)&dest[l], _mm_or_si128(_mm_loadu_si128((const __m128i *)&dest[l]), _mm_loadu_si128((const __m128i *)&src[l])));
+				for (; l < ctx->rowwords; l++)
+					dest[l] |= src[l];
+			}
+		}
+
+		if (i == 0)
+			continue;
+
+		for (int j = 0; j < ctx->count; j++)
+		{
+			if (((byte *)dest)[j >> 3] & (1 << (j & 7)))
+				ctx->acount[thread]++;
+		}
+	}
+}
+
+// Rows are independent, so both passes are split across threads; PAS rows only read the fully decompressed gPVS.
+// The result is saved next to the map keyed by its CRC when sv_vis_diskcache is set
+void CM_CalcPAS(model_t *pModel)
+{
+	calcpas_t ctx;
+	int vcount, acount;
+
+	Con_DPrintf("Building PAS...\n");
+	CM_FreePAS();
+
+	Q_memset(&ctx, 0, sizeof(ctx));
+	ctx.model = pModel;
+	ctx.rows = (pModel->numleafs + 7) / 8;
+	ctx.count = pModel->numleafs + 1;
+	int actualRowBytes = (ctx.rows + 3) & 0xFFFFFFFC;	// 4-byte align
+	ctx.rowwords = actualRowBytes / 4;
+
+	qboolean useDiskCache = (sv_vis_diskcache.value != 0.0f && g_psvs.maxclients > 1) ? TRUE : FALSE;
+	if (useDiskCache && CM_LoadVisCache(pModel, g_psv.worldmapCRC, actualRowBytes))
+		return;
+
+	gPVSRowBytes = actualRowBytes;
+	gPVS = (byte *)Mem_Calloc(gPVSRowBytes, ctx.count);
+	gPAS = (byte *)Mem_Calloc(gPVSRowBytes, ctx.count);
+
+	Sys_ParallelFor(ctx.count, 64, CM_DecompressPVSRows, &ctx);
+	Sys_ParallelFor(ctx.count, 16, CM_BuildPASRows, &ctx);
+
+	vcount = acount = 0;
+	for (int i = 0; i < MAX_PARALLEL_THREADS; i++)
+	{
+		vcount += ctx.vcount[i];
+		acount += ctx.acount[i];
+	}
+
+	Con_DPrintf("Average leaves visible / audible / total: %i / %i / %i\n", vcount / ctx.count, acount / ctx.count, ctx.count);
+
+	if (useDiskCache)
+		CM_SaveVisCache(pModel, g_psv.worldmapCRC);
+}
+#else // REHLDS_OPT_PEDANTIC
 /* <83fd> ../engine/cmodel.c:139 */
 void CM_CalcPAS(model_t *pModel)
 {
@@ -252,6 +453,7 @@ void CM_CalcPAS(model_t *pModel)
 
 	Con_DPrintf("Average leaves visible / audible / total: %i / %i / %i\n", vcount / count, acount / count, count);
 }
+#endif // REHLDS_OPT_PEDANTIC
 
 /* <858a> ../engine/cmodel.c:218 */
 qboolean CM_HeadnodeVisible(mnode_t *node, unsigned char *visbits, int *first_visible_leafnum)
@@ -62,6 +62,16 @@ unsigned char *CM_LeafPVS(int leafnum);
 unsigned char *CM_LeafPAS(int leafnum);
 void CM_FreePAS(void);
 void CM_CalcPAS(model_t *pModel);
+
+#ifdef REHLDS_OPT_PEDANTIC
+extern cvar_t sv_vis_diskcache;
+
+void CM_VisCacheFileName(model_t *pModel, char *out, int size);
+qboolean CM_LoadVisCache(model_t *pModel, CRC32_t mapCRC, int rowbytes);
+void CM_SaveVisCache(model_t *pModel, CRC32_t mapCRC);
+void CM_DecompressPVSRows(void *arg, int first, int last, int thread);
+void CM_BuildPASRows(void *arg, int first, int last, int thread);
+#endif // REHLDS_OPT_PEDANTIC
 qboolean CM_HeadnodeVisible(mnode_t *node, unsigned char *visbits, int *first_visible_leafnum);
 
 #endif // CMODEL_H
@@ -338,8 +338,8 @@ Handles byte ordering and avoids alignment errors
 ==============================================================================
 */
 
-int msg_badread;
-int msg_readcount;
+MSG_THREADLOCAL int msg_badread;
+MSG_THREADLOCAL int msg_readcount;
 
 // Some bit tables...
 const uint32 BITTABLE[] =
@@ -497,7 +497,7 @@ typedef struct bf_read_s
 } bf_read_t;
 
 // Bit field reading/writing storage.
-bf_read_t bfread;
+MSG_THREADLOCAL bf_read_t bfread;
 ALIGN16 bf_write_t bfwrite;
 
 
@@ -661,6 +661,18 @@ void MSG_WriteBits(uint32 data, int numbits)
 
 #endif //defined(REHLDS_FIXES)
 
+#ifdef REHLDS_OPT_PEDANTIC
+// Number of bits written since the start of the bit writing buffer, pending ones included
+int MSG_BitsWritten(void)
+{
+#if defined(REHLDS_FIXES)
+	return bfwrite.pbuf->cursize * 8 + bfwrite.nCurOutputBit;
+#else // defined(REHLDS_FIXES)
+	return (bfwrite.pOutByte - bfwrite.pbuf->data) * 8 + bfwrite.nCurOutputBit;
+#endif // defined(REHLDS_FIXES)
+}
+#endif // REHLDS_OPT_PEDANTIC
+
 NOXREF qboolean MSG_IsBitWriting(void)
 {
 	NOXREFCHECK;
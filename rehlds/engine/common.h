@@ -79,11 +79,18 @@ extern char gpszProductString[32];
 typedef struct bf_read_s bf_read_t;
 typedef struct bf_write_s bf_write_t;
 
-extern bf_read_t bfread;
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(HOOK_ENGINE)
+// Message reading state is per thread, so SV_PredecodeMove workers can parse client packets of their own
+#define MSG_THREADLOCAL THREAD_LOCAL
+#else
+#define MSG_THREADLOCAL
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(HOOK_ENGINE)
+
+extern MSG_THREADLOCAL bf_read_t bfread;
 extern bf_write_t bfwrite;
 
-extern int msg_badread;
-extern int msg_readcount;
+extern MSG_THREADLOCAL int msg_badread;
+extern MSG_THREADLOCAL int msg_readcount;
 
 extern qboolean bigendien;
 
@@ -204,6 +211,9 @@ void COM_BitOpsInit(void);
 void MSG_WriteOneBit(int nValue);
 void MSG_StartBitWriting(sizebuf_t *buf);
 NOXREF qboolean MSG_IsBitWriting(void);
+#ifdef REHLDS_OPT_PEDANTIC
+int MSG_BitsWritten(void);
+#endif // REHLDS_OPT_PEDANTIC
 void MSG_EndBitWriting(sizebuf_t *buf);
 void MSG_WriteBits(uint32 data, int numbits);
 void MSG_WriteSBits(int data, int numbits);
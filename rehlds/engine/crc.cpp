@@ -565,6 +565,164 @@ BOOL MD5_Hash_File(unsigned char digest[16], char *pszFileName, BOOL bUsefopen,
 	return 0;
 }
 
+#ifdef REHLDS_OPT_PEDANTIC
+// Hashes a file outside of the engine filesystem, safe to call from worker threads.
+// Matches MD5_Hash_File for plain files: fails on empty ones
+BOOL MD5_Hash_LocalFile(unsigned char digest[16], const char *pszLocalPath)
+{
+	FILE *fp = fopen(pszLocalPath, "rb");
+	if (!fp)
+		return FALSE;
+
+	MD5Context_t ctx;
+	Q_memset(&ctx, 0, sizeof(ctx));
+	MD5Init(&ctx);
+
+	byte chunk[16384];
+	size_t total = 0;
+	size_t nBytesRead;
+	while ((nBytesRead = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+	{
+		MD5Update(&ctx, chunk, nBytesRead);
+		total += nBytesRead;
+	}
+
+	BOOL ok = (!ferror(fp) && total > 0) ? TRUE : FALSE;
+	fclose(fp);
+
+	if (ok)
+		MD5Final(digest, &ctx);
+
+	return ok;
+}
+
+// File hashes that survive map changes. An entry is reused while the file keeps its size and modification time
+typedef struct filehash_s
+{
+	char name[MAX_PATH];
+	filehashtype_t type;
+	unsigned int size;
+	int32 filetime;
+	union
+	{
+		unsigned char md5[16];
+		CRC32_t crc;
+	};
+	struct filehash_s *next;
+} filehash_t;
+
+#define FILEHASH_BUCKETS	256
+
+static filehash_t *g_FileHashes[FILEHASH_BUCKETS];
+static unsigned int g_FileHashHits;
+static unsigned int g_FileHashMisses;
+
+static filehash_t *FileHash_Find(const char *pszFileName, filehashtype_t type, unsigned int *bucket)
+{
+	CRC32_t crc;
+	CRC32_Init(&crc);
+	for (const char *c = pszFileName; *c; c++)
+		CRC32_ProcessByte(&crc, tolower(*c));
+
+	*bucket = CRC32_Final(crc) & (FILEHASH_BUCKETS - 1);
+	for (filehash_t *h = g_FileHashes[*bucket]; h; h = h->next)
+	{
+		if (h->type == type && !Q_stricmp(h->name, pszFileName))
+			return h;
+	}
+
+	return NULL;
+}
+
+// Returns the cached entry if it is still up to date, otherwise a (possibly new) entry to be filled by FileHash_Store
+filehash_t *FileHash_Lookup(const char *pszFileName, filehashtype_t type, qboolean *upToDate)
+{
+	unsigned int bucket;
+	unsigned int size = FS_FileSize(pszFileName);
+	int32 filetime = FS_GetFileTime(pszFileName);
+
+	filehash_t *h = FileHash_Find(pszFileName, type, &bucket);
+	if (h && h->size == size && h->filetime == filetime && filetime != -1 && filetime != 0)
+	{
+		g_FileHashHits++;
+		*upToDate = TRUE;
+		return h;
+	}
+
+	g_FileHashMisses++;
+	*upToDate = FALSE;
+
+	if (!h)
+	{
+		h = (filehash_t *)Mem_ZeroMalloc(sizeof(filehash_t));
+		Q_strncpy(h->name, pszFileName, sizeof(h->name) - 1);
+		h->name[sizeof(h->name) - 1] = 0;
+		h->type = type;
+		h->next = g_FileHashes[bucket];
+		g_FileHashes[bucket] = h;
+	}
+
+	// not valid until stored
+	h->size = size;
+	h->filetime = 0;
+	return h;
+}
+
+void FileHash_StoreMD5(filehash_t *h, const unsigned char digest[16])
+{
+	Q_memcpy(h->md5, digest, sizeof(h->md5));
+	h->filetime = FS_GetFileTime(h->name);
+}
+
+const unsigned char *FileHash_MD5(filehash_t *h)
+{
+	return h->md5;
+}
+
+BOOL MD5_Hash_FileCached(unsigned char digest[16], char *pszFileName)
+{
+	qboolean upToDate;
+	filehash_t *h = FileHash_Lookup(pszFileName, FILEHASH_MD5, &upToDate);
+	if (upToDate)
+	{
+		Q_memcpy(digest, h->md5, 16);
+		return TRUE;
+	}
+
+	if (!MD5_Hash_File(digest, pszFileName, FALSE, FALSE, NULL))
+		return FALSE;
+
+	FileHash_StoreMD5(h, digest);
+	return TRUE;
+}
+
+// CRC32_Init + CRC_MapFile
+int CRC_MapFileCached(CRC32_t *crcvalue, char *pszFileName)
+{
+	qboolean upToDate;
+	filehash_t *h = FileHash_Lookup(pszFileName, FILEHASH_MAPCRC, &upToDate);
+	if (upToDate)
+	{
+		*crcvalue = h->crc;
+		return 1;
+	}
+
+	CRC32_Init(crcvalue);
+	if (!CRC_MapFile(crcvalue, pszFileName))
+		return 0;
+
+	h->crc = *crcvalue;
+	h->filetime = FS_GetFileTime(pszFileName);
+	return 1;
+}
+
+void FileHash_Stats(unsigned int *hits, unsigned int *misses)
+{
+	*hits = g_FileHashHits;
+	*misses = g_FileHashMisses;
+}
+#endif // REHLDS_OPT_PEDANTIC
+
 /* <1998b> ../engine/crc.c:762 */
 char *MD5_Print(unsigned char hash[16])
 {
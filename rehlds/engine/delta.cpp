@@ -67,6 +67,34 @@ delta_definition_list_t *g_defs;
 delta_encoder_t *g_encoders;
 delta_registry_t *g_deltaregistry;
 
+#ifdef REHLDS_OPT_PEDANTIC
+cvar_t sv_delta_stats = { "sv_delta_stats", "0", 0, 0.0f, NULL };
+
+// While set, DELTA_WriteDelta stats go here instead of the description
+delta_record_t *g_DeltaStatsRecord;
+
+// While set, DELTA_ParseDelta leaves the received field bits here instead of counting them.
+// Per thread: packets parsed ahead on workers are counted when the main thread takes them
+THREAD_LOCAL int *g_DeltaParseBits;
+
+#define DELTA_STATS_MAX_CLASSES 512
+
+// Packet entity bits by classname. The key is the pr_strings pointer, the text is copied
+// because the string may be freed with the map that allocated it
+typedef struct delta_classstats_s
+{
+	const char *key;
+	char classname[32];
+	int64 writes;
+	int64 unchanged;
+	int64 bits;
+} delta_classstats_t;
+
+static delta_classstats_t g_DeltaClassStats[DELTA_STATS_MAX_CLASSES];
+static delta_classstats_t g_DeltaClassStatsOther;
+static int g_DeltaClassStatsCount;
+#endif // REHLDS_OPT_PEDANTIC
+
 #endif // Defines_and_Variables_region
 
 #ifndef Delta_definitions_region
@@ -88,18 +116,26 @@ static delta_definition_t g_DeltaDataDefinition[] =
 
 static delta_description_t g_MetaDescription[] =
 {
-	{ DT_INTEGER, DELTA_D_DEF(fieldType), 1, 32, 1.0, 1.0, 0, 0, 0 },
-	{ DT_STRING, DELTA_D_DEF(fieldName), 1, 1, 1.0, 1.0, 0, 0, 0 },
-	{ DT_INTEGER, DELTA_D_DEF(fieldOffset), 1, 16, 1.0, 1.0, 0, 0, 0 },
-	{ DT_INTEGER, DELTA_D_DEF(fieldSize), 1, 8, 1.0, 1.0, 0, 0, 0 },
-	{ DT_INTEGER, DELTA_D_DEF(significant_bits), 1, 8, 1.0, 1.0, 0, 0, 0 },
-	{ DT_FLOAT, DELTA_D_DEF(premultiply), 1, 32, 4000.0, 1.0, 0, 0, 0 },
-	{ DT_FLOAT, DELTA_D_DEF(postmultiply), 1, 32, 4000.0, 1.0, 0, 0, 0 },
+	{ DT_INTEGER, DELTA_D_DEF(fieldType), 1, 32, 1.0, 1.0, 0, {} },
+	{ DT_STRING, DELTA_D_DEF(fieldName), 1, 1, 1.0, 1.0, 0, {} },
+	{ DT_INTEGER, DELTA_D_DEF(fieldOffset), 1, 16, 1.0, 1.0, 0, {} },
+	{ DT_INTEGER, DELTA_D_DEF(fieldSize), 1, 8, 1.0, 1.0, 0, {} },
+	{ DT_INTEGER, DELTA_D_DEF(significant_bits), 1, 8, 1.0, 1.0, 0, {} },
+	{ DT_FLOAT, DELTA_D_DEF(premultiply), 1, 32, 4000.0, 1.0, 0, {} },
+	{ DT_FLOAT, DELTA_D_DEF(postmultiply), 1, 32, 4000.0, 1.0, 0, {} },
 };
 
 delta_t g_MetaDelta[] =
 {
-	{ 0, ARRAYSIZE(g_MetaDescription), "", NULL, g_MetaDescription },
+	{
+		0, ARRAYSIZE(g_MetaDescription), "", NULL, g_MetaDescription,
+#ifdef REHLDS_FIXES
+		NULL,
+#endif
+#ifdef REHLDS_OPT_PEDANTIC
+		{},
+#endif // REHLDS_OPT_PEDANTIC
+	},
 };
 
 static delta_definition_t g_EventDataDefinition[] =
@@ -631,6 +667,11 @@ void DELTA_WriteMarkedFields(unsigned char *from, unsigned char *to, delta_t *pF
 	float f2;
 	int fieldCount = pFields->fieldCount;
 
+#ifdef REHLDS_OPT_PEDANTIC
+	bool stats = sv_delta_stats.value != 0.0f;
+	int fieldStart = 0;
+#endif // REHLDS_OPT_PEDANTIC
+
 	for (i = 0, pTest = pFields->pdd; i < fieldCount; i++, pTest++)
 	{
 #if defined (REHLDS_OPT_PEDANTIC) || defined (REHLDS_FIXES)
@@ -641,6 +682,11 @@ void DELTA_WriteMarkedFields(unsigned char *from, unsigned char *to, delta_t *pF
 			continue;
 #endif
 
+#ifdef REHLDS_OPT_PEDANTIC
+		if (stats)
+			fieldStart = MSG_BitsWritten();
+#endif // REHLDS_OPT_PEDANTIC
+
 		fieldSign = pTest->fieldType & DT_SIGNED;
 		fieldType = pTest->fieldType & ~DT_SIGNED;
 		switch (fieldType)
@@ -733,6 +779,27 @@ void DELTA_WriteMarkedFields(unsigned char *from, unsigned char *to, delta_t *pF
 			Con_Printf(__FUNCTION__ ": unknown send field type\n");
 			break;
 		}
+
+#ifdef REHLDS_OPT_PEDANTIC
+		if (stats)
+		{
+			if (g_DeltaStatsRecord)
+			{
+				delta_record_t *record = g_DeltaStatsRecord;
+				if (record->numfields < DELTA_RECORD_MAX_FIELDS)
+				{
+					record->field[record->numfields] = i;
+					record->bits[record->numfields] = MSG_BitsWritten() - fieldStart;
+					record->numfields++;
+				}
+			}
+			else
+			{
+				pTest->stats.sendcount++;
+				pTest->stats.sentbits += MSG_BitsWritten() - fieldStart;
+			}
+		}
+#endif // REHLDS_OPT_PEDANTIC
 	}
 }
 
@@ -784,6 +851,27 @@ qboolean _DELTA_WriteDelta(unsigned char *from, unsigned char *to, qboolean forc
 	int bytecount;
 	int bits[2];
 
+#ifdef REHLDS_OPT_PEDANTIC
+	int statsStart = -1;
+	if (sv_delta_stats.value != 0.0f)
+	{
+		if (g_DeltaStatsRecord)
+		{
+			g_DeltaStatsRecord->valid = TRUE;
+			g_DeltaStatsRecord->unchanged = sendfields ? FALSE : TRUE;
+		}
+		else
+		{
+			pFields->totals.writes++;
+			if (!sendfields)
+				pFields->totals.unchanged++;
+		}
+
+		if (sendfields || force)
+			statsStart = MSG_BitsWritten();
+	}
+#endif // REHLDS_OPT_PEDANTIC
+
 	if (sendfields || force)
 	{
 #if defined(REHLDS_OPT_PEDANTIC) || defined(REHLDS_FIXES)
@@ -801,7 +889,27 @@ qboolean _DELTA_WriteDelta(unsigned char *from, unsigned char *to, qboolean forc
 			MSG_WriteBits(( (byte*)bits )[i], 8);
 		}
 
+#ifdef REHLDS_OPT_PEDANTIC
+		int fieldsStart = statsStart != -1 ? MSG_BitsWritten() : 0;
+#endif // REHLDS_OPT_PEDANTIC
+
 		DELTA_WriteMarkedFields(from, to, pFields);
+
+#ifdef REHLDS_OPT_PEDANTIC
+		if (statsStart != -1)
+		{
+			if (g_DeltaStatsRecord)
+			{
+				g_DeltaStatsRecord->headerbits = fieldsStart - statsStart;
+				g_DeltaStatsRecord->fieldbits = MSG_BitsWritten() - fieldsStart;
+			}
+			else
+			{
+				pFields->totals.headerbits += fieldsStart - statsStart;
+				pFields->totals.fieldbits += MSG_BitsWritten() - fieldsStart;
+			}
+		}
+#endif // REHLDS_OPT_PEDANTIC
 	}
 
 	return 1;
@@ -836,6 +944,15 @@ int DELTA_ParseDelta(unsigned char *from, unsigned char *to, delta_t *pFields)
 		((byte*)bits)[i] = MSG_ReadBits(8);
 	}
 
+#ifdef REHLDS_OPT_PEDANTIC
+	int *parseBits = g_DeltaParseBits;
+	if (parseBits)
+	{
+		parseBits[0] = bits[0];
+		parseBits[1] = bits[1];
+	}
+#endif // REHLDS_OPT_PEDANTIC
+
 	for (i = 0, pTest = pFields->pdd; i < fieldCount; i++, pTest++)
 	{
 		fieldType = pTest->fieldType & ~DT_SIGNED;
@@ -868,6 +985,9 @@ int DELTA_ParseDelta(unsigned char *from, unsigned char *to, delta_t *pFields)
 			continue;
 		}
 
+#ifdef REHLDS_OPT_PEDANTIC
+		if (!parseBits)
+#endif // REHLDS_OPT_PEDANTIC
 		pTest->stats.receivedcount++;
 
 		fieldSign = pTest->fieldType & DT_SIGNED;
@@ -1559,7 +1679,14 @@ void DELTA_ClearStats(delta_t *p)
 		{
 			p->pdd[i].stats.sendcount = 0;
 			p->pdd[i].stats.receivedcount = 0;
+#ifdef REHLDS_OPT_PEDANTIC
+			p->pdd[i].stats.sentbits = 0;
+#endif // REHLDS_OPT_PEDANTIC
 		}
+
+#ifdef REHLDS_OPT_PEDANTIC
+		Q_memset(&p->totals, 0, sizeof(p->totals));
+#endif // REHLDS_OPT_PEDANTIC
 	}
 }
 
@@ -1573,6 +1700,12 @@ void DELTA_ClearStats_f(void)
 	{
 		DELTA_ClearStats(p->pdesc);
 	}
+
+#ifdef REHLDS_OPT_PEDANTIC
+	Q_memset(g_DeltaClassStats, 0, sizeof(g_DeltaClassStats));
+	Q_memset(&g_DeltaClassStatsOther, 0, sizeof(g_DeltaClassStatsOther));
+	g_DeltaClassStatsCount = 0;
+#endif // REHLDS_OPT_PEDANTIC
 }
 
 /* <23ece> ../engine/delta.c:2100 */
@@ -1586,9 +1719,20 @@ void DELTA_PrintStats(const char *name, delta_t *p)
 			delta_description_t *dt = p->pdd;
 			for (int i = 0; i < p->fieldCount; i++, dt++)
 			{
+#ifdef REHLDS_OPT_PEDANTIC
+				Con_Printf("  %02i % 10s:  s % 5i r % 5i b % 8lld\n", i + 1, dt->fieldName, dt->stats.sendcount, dt->stats.receivedcount, (long long)dt->stats.sentbits);
+#else // REHLDS_OPT_PEDANTIC
 				Con_Printf("  %02i % 10s:  s % 5i r % 5i\n", i + 1, dt->fieldName, dt->stats.sendcount, dt->stats.receivedcount);
+#endif // REHLDS_OPT_PEDANTIC
 			}
 		}
+#ifdef REHLDS_OPT_PEDANTIC
+		if (p->totals.writes)
+		{
+			Con_Printf("  writes %lld, unchanged %lld, header bits %lld, field bits %lld\n",
+				(long long)p->totals.writes, (long long)p->totals.unchanged, (long long)p->totals.headerbits, (long long)p->totals.fieldbits);
+		}
+#endif // REHLDS_OPT_PEDANTIC
 		Con_Printf("\n");
 	}
 }
@@ -1601,11 +1745,202 @@ void DELTA_DumpStats_f(void)
 		DELTA_PrintStats(dr->name, dr->pdesc);
 }
 
+#ifdef REHLDS_OPT_PEDANTIC
+void DELTA_StatsEntity(int entnum, int bits, qboolean unchanged)
+{
+	edict_t *ent = &g_psv.edicts[entnum];
+	const char *classname = ent->v.classname ? &pr_strings[ent->v.classname] : "";
+	delta_classstats_t *cs;
+
+	unsigned int h = ((unsigned int)(size_t)classname >> 2) & (DELTA_STATS_MAX_CLASSES - 1);
+	while (1)
+	{
+		cs = &g_DeltaClassStats[h];
+		if (!cs->key)
+		{
+			// Keep the probe sequences short, the rest is counted as one row
+			if (g_DeltaClassStatsCount >= DELTA_STATS_MAX_CLASSES * 3 / 4)
+			{
+				cs = &g_DeltaClassStatsOther;
+				break;
+			}
+
+			cs->key = classname;
+			Q_strncpy(cs->classname, classname, sizeof(cs->classname) - 1);
+			cs->classname[sizeof(cs->classname) - 1] = '\0';
+			g_DeltaClassStatsCount++;
+			break;
+		}
+
+		if (cs->key == classname && !Q_strncmp(cs->classname, classname, sizeof(cs->classname) - 1))
+			break;
+
+		h = (h + 1) & (DELTA_STATS_MAX_CLASSES - 1);
+	}
+
+	cs->writes++;
+	cs->bits += bits;
+	if (unchanged)
+		cs->unchanged++;
+}
+
+void DELTA_StatsBaseline(delta_t *pFields, int savedbits)
+{
+	pFields->totals.baselinesearches++;
+	if (savedbits > 0)
+	{
+		pFields->totals.baselinehits++;
+		pFields->totals.baselinesaved += savedbits;
+	}
+}
+
+void DELTA_StatsStartRecord(delta_record_t *record)
+{
+	Q_memset(record, 0, sizeof(*record));
+	g_DeltaStatsRecord = record;
+}
+
+void DELTA_StatsEndRecord(void)
+{
+	g_DeltaStatsRecord = NULL;
+}
+
+// Counts a recorded write as if DELTA_WriteDelta had run again
+void DELTA_StatsReplay(delta_t *pFields, const delta_record_t *record)
+{
+	if (!record->valid)
+		return;
+
+	pFields->totals.writes++;
+	if (record->unchanged)
+		pFields->totals.unchanged++;
+
+	pFields->totals.headerbits += record->headerbits;
+	pFields->totals.fieldbits += record->fieldbits;
+
+	for (int i = 0; i < record->numfields; i++)
+	{
+		delta_description_t *pTest = &pFields->pdd[record->field[i]];
+		pTest->stats.sendcount++;
+		pTest->stats.sentbits += record->bits[i];
+	}
+}
+
+void DELTA_StatsDeferParse(int *bits)
+{
+	g_DeltaParseBits = bits;
+}
+
+// Counts the fields of a deferred DELTA_ParseDelta
+void DELTA_StatsParseReplay(delta_t *pFields, const int *bits)
+{
+	for (int i = 0; i < pFields->fieldCount; i++)
+	{
+		if (bits[i > 31] & (1 << (i & 0x1F)))
+			pFields->pdd[i].stats.receivedcount++;
+	}
+}
+
+static double DELTA_StatsShare(int64 part, int64 total)
+{
+	return total ? part * 100.0 / total : 0.0;
+}
+
+void DELTA_WriteStatsCSV_f(void)
+{
+	const char *filename = Cmd_Argc() > 1 ? Cmd_Argv(1) : "delta_stats.csv";
+
+	FileHandle_t f = FS_Open(filename, "wt");
+	if (!f)
+	{
+		Con_Printf("Couldn't open \"%s\" for writing!\n", filename);
+		return;
+	}
+
+	FS_FPrintf(f, "kind,delta,name,count,unchanged,bits,header_bits,baseline_searches,baseline_hits,saved_bits,share\n");
+
+	int64 allbits = 0;
+	for (delta_registry_t *dr = g_deltaregistry; dr; dr = dr->next)
+	{
+		if (dr->pdesc)
+			allbits += dr->pdesc->totals.headerbits + dr->pdesc->totals.fieldbits;
+	}
+
+	// Descriptions share all delta-encoded bits, fields share the field bits of their description
+	for (delta_registry_t *dr = g_deltaregistry; dr; dr = dr->next)
+	{
+		delta_t *p = dr->pdesc;
+		if (!p)
+			continue;
+
+		delta_totals_t *t = &p->totals;
+		FS_FPrintf(f, "delta,%s,,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%.2f\n", dr->name,
+			(long long)t->writes, (long long)t->unchanged, (long long)t->fieldbits, (long long)t->headerbits,
+			(long long)t->baselinesearches, (long long)t->baselinehits, (long long)t->baselinesaved,
+			DELTA_StatsShare(t->headerbits + t->fieldbits, allbits));
+
+		for (int i = 0; i < p->fieldCount; i++)
+		{
+			delta_description_t *dt = &p->pdd[i];
+			FS_FPrintf(f, "field,%s,%s,%d,,%lld,,,,,%.2f\n", dr->name, dt->fieldName,
+				dt->stats.sendcount, (long long)dt->stats.sentbits, DELTA_StatsShare(dt->stats.sentbits, t->fieldbits));
+		}
+	}
+
+	// The same classname may sit under several keys (one per allocated string), merge them by text
+	static delta_classstats_t merged[DELTA_STATS_MAX_CLASSES + 1];
+	int numMerged = 0;
+	int64 entitybits = 0;
+
+	for (int i = 0; i <= DELTA_STATS_MAX_CLASSES; i++)
+	{
+		delta_classstats_t *cs = (i < DELTA_STATS_MAX_CLASSES) ? &g_DeltaClassStats[i] : &g_DeltaClassStatsOther;
+		if (!cs->writes)
+			continue;
+
+		const char *name = (i < DELTA_STATS_MAX_CLASSES) ? cs->classname : "<other>";
+		int j;
+		for (j = 0; j < numMerged; j++)
+		{
+			if (!Q_strcmp(merged[j].classname, name))
+				break;
+		}
+
+		if (j == numMerged)
+		{
+			Q_memset(&merged[j], 0, sizeof(merged[j]));
+			Q_strncpy(merged[j].classname, name, sizeof(merged[j].classname) - 1);
+			numMerged++;
+		}
+
+		merged[j].writes += cs->writes;
+		merged[j].unchanged += cs->unchanged;
+		merged[j].bits += cs->bits;
+		entitybits += cs->bits;
+	}
+
+	// Entity classes share the bits of all packet entities, headers included
+	for (int i = 0; i < numMerged; i++)
+	{
+		FS_FPrintf(f, "entity,,%s,%lld,%lld,%lld,,,,,%.2f\n", merged[i].classname,
+			(long long)merged[i].writes, (long long)merged[i].unchanged, (long long)merged[i].bits,
+			DELTA_StatsShare(merged[i].bits, entitybits));
+	}
+
+	FS_Close(f);
+	Con_Printf("Delta stats written to %s\n", filename);
+}
+#endif // REHLDS_OPT_PEDANTIC
+
 /* <254d4> ../engine/delta.c:2143 */
 void DELTA_Init(void)
 {
 	Cmd_AddCommand("delta_stats", DELTA_DumpStats_f);
 	Cmd_AddCommand("delta_clear", DELTA_ClearStats_f);
+#ifdef REHLDS_OPT_PEDANTIC
+	Cmd_AddCommand("delta_stats_csv", DELTA_WriteStatsCSV_f);
+	Cvar_RegisterVariable(&sv_delta_stats);
+#endif // REHLDS_OPT_PEDANTIC
 
 	DELTA_AddDefinition("clientdata_t", g_ClientDataDefinition, ARRAYSIZE(g_ClientDataDefinition));
 	DELTA_AddDefinition("weapon_data_t", g_WeaponDataDefinition, ARRAYSIZE(g_WeaponDataDefinition));
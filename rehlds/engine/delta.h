@@ -54,8 +54,40 @@ typedef struct delta_stats_s
 {
 	int sendcount;
 	int receivedcount;
+#ifdef REHLDS_OPT_PEDANTIC
+	int64 sentbits;		// counted together with sendcount while sv_delta_stats is set
+#endif // REHLDS_OPT_PEDANTIC
 } delta_stats_t;
 
+#ifdef REHLDS_OPT_PEDANTIC
+// Per description totals, only counted while sv_delta_stats is set
+typedef struct delta_totals_s
+{
+	int64 writes;			// DELTA_WriteDelta calls
+	int64 unchanged;		// calls that found no changed field
+	int64 headerbits;		// caller's header (entity number, baseline index) and the field mask
+	int64 fieldbits;
+	int64 baselinesearches;	// SV_FindBestBaseline calls
+	int64 baselinehits;		// a better baseline than the default one was found
+	int64 baselinesaved;	// bits saved by the better baselines, offset bits included
+} delta_totals_t;
+
+#define DELTA_RECORD_MAX_FIELDS 32
+
+// What one DELTA_WriteDelta would add to the stats, for callers that encode once and send the bits many times.
+// Fields past DELTA_RECORD_MAX_FIELDS still count in the totals, not per field
+typedef struct delta_record_s
+{
+	qboolean valid;
+	qboolean unchanged;
+	int headerbits;
+	int fieldbits;
+	int numfields;
+	unsigned char field[DELTA_RECORD_MAX_FIELDS];
+	unsigned short bits[DELTA_RECORD_MAX_FIELDS];
+} delta_record_t;
+#endif // REHLDS_OPT_PEDANTIC
+
 /* <bee2> ../engine/delta.h:45 */
 typedef struct delta_description_s
 {
@@ -84,6 +116,10 @@ typedef struct delta_s
 #ifdef REHLDS_FIXES
 	CDeltaJit* jit;
 #endif
+
+#ifdef REHLDS_OPT_PEDANTIC
+	delta_totals_t totals;
+#endif // REHLDS_OPT_PEDANTIC
 } delta_t;
 
 /* <23b2a> ../engine/delta.h:104 */
@@ -124,6 +160,10 @@ extern delta_encoder_t *g_encoders;
 extern delta_registry_t *g_deltaregistry;
 extern delta_t g_MetaDelta[];
 
+#ifdef REHLDS_OPT_PEDANTIC
+extern struct cvar_s sv_delta_stats;
+#endif // REHLDS_OPT_PEDANTIC
+
 
 delta_description_t *DELTA_FindField(delta_t *pFields, const char *pszField);
 int DELTA_FindFieldIndex(struct delta_s *pFields, const char *fieldname);
@@ -172,5 +212,17 @@ void DELTA_ClearStats(delta_t *p);
 void DELTA_ClearStats_f(void);
 void DELTA_PrintStats(const char *name, delta_t *p);
 void DELTA_DumpStats_f(void);
+
+#ifdef REHLDS_OPT_PEDANTIC
+void DELTA_StatsEntity(int entnum, int bits, qboolean unchanged);
+void DELTA_StatsBaseline(delta_t *pFields, int savedbits);
+void DELTA_StatsStartRecord(delta_record_t *record);
+void DELTA_StatsEndRecord(void);
+void DELTA_StatsReplay(delta_t *pFields, const delta_record_t *record);
+void DELTA_StatsDeferParse(int *bits);
+void DELTA_StatsParseReplay(delta_t *pFields, const int *bits);
+void DELTA_WriteStatsCSV_f(void);
+#endif // REHLDS_OPT_PEDANTIC
+
 void DELTA_Init(void);
 void DELTA_Shutdown(void);
@@ -1,5 +1,8 @@
 #include "precompiled.h"
+
+#include "stdsani_in.h"
 #include "jitasm.h"
+#include "stdsani_out.h"
 
 CDeltaJitRegistry g_DeltaJitRegistry;
 
@@ -28,6 +28,8 @@
 
 #include "precompiled.h"
 
+#include <atomic>
+
 /*
 * Globals initialization
 */
@@ -45,6 +47,417 @@ hash_pack_header_t hash_pack_header;
 
 #endif //HOOK_ENGINE
 
+#ifdef REHLDS_OPT_PEDANTIC
+hpakindex_t *g_HpakIndexes;
+
+static void HPAK_FreeIndex(hpakindex_t *idx)
+{
+	if (idx->dir.p_rgEntries)
+		Mem_Free(idx->dir.p_rgEntries);
+
+	if (idx->buckets)
+		Mem_Free(idx->buckets);
+
+	Mem_Free(idx);
+}
+
+static unsigned int HPAK_HashBucket(const unsigned char *hash)
+{
+	return hash[0] | (hash[1] << 8) | (hash[2] << 16) | (hash[3] << 24);
+}
+
+static void HPAK_BuildBuckets(hpakindex_t *idx)
+{
+	if (idx->buckets)
+		Mem_Free(idx->buckets);
+
+	idx->numbuckets = 16;
+	while (idx->numbuckets < idx->dir.nEntries * 2)
+		idx->numbuckets <<= 1;
+
+	idx->buckets = (int *)Mem_ZeroMalloc(idx->numbuckets * sizeof(int));
+	idx->livebytes = sizeof(hash_pack_header_t) + 4 + idx->dir.nEntries * sizeof(hash_pack_entry_t);
+
+	for (int i = 0; i < idx->dir.nEntries; i++)
+	{
+		hash_pack_entry_t *entry = &idx->dir.p_rgEntries[i];
+		idx->livebytes += entry->nFileLength;
+
+		// keep the first of duplicate hashes, like HPAK_FindResource
+		if (HPAK_IndexFind(idx, entry->resource.rgucMD5_hash) != -1)
+			continue;
+
+		unsigned int b = HPAK_HashBucket(entry->resource.rgucMD5_hash) & (idx->numbuckets - 1);
+		while (idx->buckets[b])
+			b = (b + 1) & (idx->numbuckets - 1);
+
+		idx->buckets[b] = i + 1;
+	}
+}
+
+int HPAK_IndexFind(hpakindex_t *idx, const unsigned char *hash)
+{
+	unsigned int b = HPAK_HashBucket(hash) & (idx->numbuckets - 1);
+	while (idx->buckets[b])
+	{
+		int i = idx->buckets[b] - 1;
+		if (!Q_memcmp(idx->dir.p_rgEntries[i].resource.rgucMD5_hash, hash, 16))
+			return i;
+
+		b = (b + 1) & (idx->numbuckets - 1);
+	}
+
+	return -1;
+}
+
+void HPAK_InvalidateIndex(const char *name)
+{
+	for (hpakindex_t **link = &g_HpakIndexes; *link; link = &(*link)->next)
+	{
+		if (!Q_stricmp((*link)->name, name))
+		{
+			hpakindex_t *idx = *link;
+			*link = idx->next;
+			HPAK_FreeIndex(idx);
+			return;
+		}
+	}
+}
+
+// Returns the directory of the HPAK, reading it only if the file changed.
+// NULL if the file is missing or not a valid HPAK, callers then take the original path and its messages
+hpakindex_t *HPAK_GetIndex(const char *name)
+{
+	HPAK_PollCompaction();
+
+	int32 filetime = FS_GetFileTime(name);
+	int filesize = FS_FileSize(name);
+
+	hpakindex_t *idx;
+	for (idx = g_HpakIndexes; idx; idx = idx->next)
+	{
+		if (!Q_stricmp(idx->name, name))
+			break;
+	}
+
+	if (idx && idx->filesize == filesize && idx->filetime == filetime && filetime != -1 && filetime != 0)
+		return idx;
+
+	HPAK_InvalidateIndex(name);
+
+	FileHandle_t fp = FS_Open(name, "rb");
+	if (!fp)
+		return NULL;
+
+	hash_pack_header_t header;
+	hash_pack_directory_t dir;
+	FS_Read(&header, sizeof(hash_pack_header_t), 1, fp);
+	if (Q_strncmp(header.szFileStamp, "HPAK", sizeof(header.szFileStamp)) || header.version != HASHPAK_VERSION)
+	{
+		FS_Close(fp);
+		return NULL;
+	}
+
+	FS_Seek(fp, header.nDirectoryOffset, FILESYSTEM_SEEK_HEAD);
+	FS_Read(&dir.nEntries, 4, 1, fp);
+	if (dir.nEntries < 1 || (unsigned int)dir.nEntries > MAX_FILE_ENTRIES)
+	{
+		FS_Close(fp);
+		return NULL;
+	}
+
+	dir.p_rgEntries = (hash_pack_entry_t *)Mem_ZeroMalloc(sizeof(hash_pack_entry_t) * dir.nEntries);
+	FS_Read(dir.p_rgEntries, sizeof(hash_pack_entry_t) * dir.nEntries, 1, fp);
+	FS_Close(fp);
+
+	idx = (hpakindex_t *)Mem_ZeroMalloc(sizeof(hpakindex_t));
+	Q_strncpy(idx->name, name, sizeof(idx->name) - 1);
+	idx->name[sizeof(idx->name) - 1] = 0;
+	idx->filesize = filesize;
+	idx->filetime = filetime;
+	idx->header = header;
+	idx->dir = dir;
+	HPAK_BuildBuckets(idx);
+
+	// The directory may have been written with room for more entries, it ends at the next lump or the end of the file
+	idx->dircapacity = filesize - header.nDirectoryOffset;
+	for (int i = 0; i < dir.nEntries; i++)
+	{
+		int gap = dir.p_rgEntries[i].nOffset - header.nDirectoryOffset;
+		if (gap > 0 && gap < idx->dircapacity)
+			idx->dircapacity = gap;
+	}
+
+	idx->next = g_HpakIndexes;
+	g_HpakIndexes = idx;
+	return idx;
+}
+
+// Writes the directory where the header doesn't point, then points the header at it.
+// Until the header write the file still describes the previous directory. Directories
+// alternate between two regions; a region that is too small is replaced by one at the end
+// of the file with room for twice the entries, so appends leave O(entries) unused bytes in total
+static qboolean HPAK_CommitDirectory(hpakindex_t *idx, FileHandle_t fp, hash_pack_directory_t *newdir)
+{
+	int needed = 4 + sizeof(hash_pack_entry_t) * newdir->nEntries;
+	int dirOffset;
+	int dirCapacity;
+
+	if (idx->spareoffset && idx->sparecapacity >= needed)
+	{
+		dirOffset = idx->spareoffset;
+		dirCapacity = idx->sparecapacity;
+		FS_Seek(fp, dirOffset, FILESYSTEM_SEEK_HEAD);
+		FS_Write(&newdir->nEntries, 4, 1, fp);
+		FS_Write(newdir->p_rgEntries, sizeof(hash_pack_entry_t) * newdir->nEntries, 1, fp);
+	}
+	else
+	{
+		FS_Seek(fp, 0, FILESYSTEM_SEEK_TAIL);
+		dirOffset = FS_Tell(fp);
+		dirCapacity = 4 + sizeof(hash_pack_entry_t) * newdir->nEntries * 2;
+		FS_Write(&newdir->nEntries, 4, 1, fp);
+		FS_Write(newdir->p_rgEntries, sizeof(hash_pack_entry_t) * newdir->nEntries, 1, fp);
+
+		hash_pack_entry_t unused;
+		Q_memset(&unused, 0, sizeof(unused));
+		for (int i = 0; i < newdir->nEntries; i++)
+			FS_Write(&unused, sizeof(unused), 1, fp);
+	}
+	FS_Flush(fp);
+
+	hash_pack_header_t header = idx->header;
+	header.nDirectoryOffset = dirOffset;
+	FS_Seek(fp, 0, FILESYSTEM_SEEK_HEAD);
+	FS_Write(&header, sizeof(hash_pack_header_t), 1, fp);
+	FS_Close(fp);
+
+	idx->spareoffset = idx->header.nDirectoryOffset;
+	idx->sparecapacity = idx->dircapacity;
+	idx->dircapacity = dirCapacity;
+
+	Mem_Free(idx->dir.p_rgEntries);
+	idx->dir = *newdir;
+	idx->header = header;
+	idx->filesize = FS_FileSize(idx->name);
+	idx->filetime = FS_GetFileTime(idx->name);
+	HPAK_BuildBuckets(idx);
+	return TRUE;
+}
+
+// HPAK_AddLump without rewriting the file: the lump and a new directory are appended
+qboolean HPAK_AppendLump(const char *name, struct resource_s *pResource, void *pData, FileHandle_t fpSource)
+{
+	hpakindex_t *idx = HPAK_GetIndex(name);
+	if (!idx)
+		return FALSE;
+
+	if (HPAK_IndexFind(idx, pResource->rgucMD5_hash) != -1)
+		return TRUE;
+
+	if (idx->dir.nEntries >= MAX_FILE_ENTRIES)
+		return FALSE;
+
+	FileHandle_t fp = FS_Open(name, "r+b");
+	if (!fp)
+		return FALSE;
+
+	hash_pack_directory_t newdir;
+	newdir.nEntries = idx->dir.nEntries + 1;
+	newdir.p_rgEntries = (hash_pack_entry_t *)Mem_ZeroMalloc(sizeof(hash_pack_entry_t) * newdir.nEntries);
+	Q_memcpy(newdir.p_rgEntries, idx->dir.p_rgEntries, sizeof(hash_pack_entry_t) * idx->dir.nEntries);
+
+	hash_pack_entry_t *pNewEntry = &newdir.p_rgEntries[newdir.nEntries - 1];
+	Q_memcpy(&pNewEntry->resource, pResource, sizeof(resource_t));
+
+	FS_Seek(fp, 0, FILESYSTEM_SEEK_TAIL);
+	pNewEntry->nOffset = FS_Tell(fp);
+	pNewEntry->nFileLength = pResource->nDownloadSize;
+
+	if (pData)
+		FS_Write(pData, pResource->nDownloadSize, 1, fp);
+	else
+		COM_CopyFileChunk(fp, fpSource, pResource->nDownloadSize);
+
+	return HPAK_CommitDirectory(idx, fp, &newdir);
+}
+
+// HPAK_RemoveLump without rewriting the file: a directory without the lump is appended
+qboolean HPAK_AppendRemoval(const char *name, struct resource_s *pResource)
+{
+	hpakindex_t *idx = HPAK_GetIndex(name);
+	if (!idx || idx->dir.nEntries == 1 || HPAK_IndexFind(idx, pResource->rgucMD5_hash) == -1)
+		return FALSE;
+
+	FileHandle_t fp = FS_Open(name, "r+b");
+	if (!fp)
+		return FALSE;
+
+	Con_Printf("Removing %s from HPAK %s.\n", pResource->szFileName, name);
+
+	hash_pack_directory_t newdir;
+	newdir.nEntries = 0;
+	newdir.p_rgEntries = (hash_pack_entry_t *)Mem_Malloc(sizeof(hash_pack_entry_t) * (idx->dir.nEntries - 1));
+	for (int i = 0; i < idx->dir.nEntries; i++)
+	{
+		hash_pack_entry_t *entry = &idx->dir.p_rgEntries[i];
+		if (Q_memcmp(entry->resource.rgucMD5_hash, pResource->rgucMD5_hash, 16))
+			Q_memcpy(&newdir.p_rgEntries[newdir.nEntries++], entry, sizeof(hash_pack_entry_t));
+	}
+
+	if (newdir.nEntries == 0)
+	{
+		// every entry had that hash
+		FS_Close(fp);
+		Mem_Free(newdir.p_rgEntries);
+		return FALSE;
+	}
+
+	return HPAK_CommitDirectory(idx, fp, &newdir);
+}
+
+// Copies the live lumps of an HPAK into a new file on the async worker.
+// The result replaces the HPAK only if the file wasn't written meanwhile
+typedef struct hpakcompaction_s
+{
+	char name[MAX_PATH];
+	char srcpath[MAX_PATH];
+	char tmppath[MAX_PATH];
+	int filesize;
+	int32 filetime;
+	hash_pack_header_t header;
+	hash_pack_directory_t dir;
+	qboolean ok;
+	std::atomic<int> done;
+} hpakcompaction_t;
+
+hpakcompaction_t *g_HpakCompaction;
+
+static void HPAK_CompactWorker(void *arg)
+{
+	hpakcompaction_t *job = (hpakcompaction_t *)arg;
+	FILE *src = fopen(job->srcpath, "rb");
+	FILE *dst = src ? fopen(job->tmppath, "wb") : NULL;
+
+	job->ok = (src && dst) ? TRUE : FALSE;
+	if (job->ok)
+	{
+		byte chunk[4096];
+		fwrite(&job->header, sizeof(hash_pack_header_t), 1, dst);
+		for (int i = 0; i < job->dir.nEntries && job->ok; i++)
+		{
+			hash_pack_entry_t *entry = &job->dir.p_rgEntries[i];
+			fseek(src, entry->nOffset, SEEK_SET);
+			entry->nOffset = ftell(dst);
+
+			for (int remaining = entry->nFileLength; remaining > 0; )
+			{
+				int n = min(remaining, (int)sizeof(chunk));
+				if (fread(chunk, 1, n, src) != (size_t)n || fwrite(chunk, 1, n, dst) != (size_t)n)
+				{
+					job->ok = FALSE;
+					break;
+				}
+				remaining -= n;
+			}
+		}
+
+		job->header.nDirectoryOffset = ftell(dst);
+		fwrite(&job->dir.nEntries, 4, 1, dst);
+		fwrite(job->dir.p_rgEntries, sizeof(hash_pack_entry_t), job->dir.nEntries, dst);
+		fseek(dst, 0, SEEK_SET);
+		fwrite(&job->header, sizeof(hash_pack_header_t), 1, dst);
+		if (ferror(dst))
+			job->ok = FALSE;
+	}
+
+	if (src)
+		fclose(src);
+
+	if (dst)
+		fclose(dst);
+
+	job->done.store(1, std::memory_order_release);
+}
+
+// Rewrites the HPAK in the background once appends left enough unused space in it
+void HPAK_StartCompaction(const char *pakname)
+{
+	if (g_HpakCompaction)
+		return;
+
+	char name[MAX_PATH];
+	Q_snprintf(name, ARRAYSIZE(name), "%s", pakname);
+	name[ARRAYSIZE(name) - 1] = 0;
+	COM_DefaultExtension(name, HASHPAK_EXTENSION);
+	COM_FixSlashes(name);
+
+	hpakindex_t *idx = HPAK_GetIndex(name);
+	if (!idx)
+		return;
+
+	// The slack of both directory regions is reused by appends and doesn't count as unused
+	int dead = idx->filesize - idx->livebytes - idx->sparecapacity - (idx->dircapacity - (4 + idx->dir.nEntries * (int)sizeof(hash_pack_entry_t)));
+	if (dead < 65536 || dead < idx->filesize / 4)
+		return;
+
+	hpakcompaction_t *job = new hpakcompaction_t;
+	if (!FS_GetLocalPath(name, job->srcpath, sizeof(job->srcpath)))
+	{
+		delete job;
+		return;
+	}
+
+	Q_strncpy(job->name, name, sizeof(job->name) - 1);
+	job->name[sizeof(job->name) - 1] = 0;
+	COM_StripExtension(job->srcpath, job->tmppath);
+	COM_DefaultExtension(job->tmppath, ".hp3");
+	job->filesize = idx->filesize;
+	job->filetime = idx->filetime;
+	job->header = idx->header;
+	job->dir.nEntries = idx->dir.nEntries;
+	job->dir.p_rgEntries = (hash_pack_entry_t *)Mem_Malloc(sizeof(hash_pack_entry_t) * idx->dir.nEntries);
+	Q_memcpy(job->dir.p_rgEntries, idx->dir.p_rgEntries, sizeof(hash_pack_entry_t) * idx->dir.nEntries);
+	job->ok = FALSE;
+	job->done.store(0, std::memory_order_relaxed);
+
+	Con_DPrintf("Compacting %s (%i of %i bytes unused)\n", name, dead, idx->filesize);
+	g_HpakCompaction = job;
+	Sys_QueueAsync(HPAK_CompactWorker, job);
+}
+
+void HPAK_PollCompaction(void)
+{
+	hpakcompaction_t *job = g_HpakCompaction;
+	if (!job || !job->done.load(std::memory_order_acquire))
+		return;
+
+	g_HpakCompaction = NULL;
+	if (job->ok && (int)FS_FileSize(job->name) == job->filesize && FS_GetFileTime(job->name) == job->filetime)
+	{
+		// Replace in one step, a crash leaves either the old or the compacted file
+#ifdef _WIN32
+		if (!MoveFileExA(job->tmppath, job->srcpath, MOVEFILE_REPLACE_EXISTING))
+#else // _WIN32
+		if (rename(job->tmppath, job->srcpath))
+#endif // _WIN32
+		{
+			Con_Printf("ERROR: couldn't replace %s with its compacted copy\n", job->name);
+			remove(job->tmppath);
+		}
+
+		HPAK_InvalidateIndex(job->name);
+	}
+	else
+	{
+		remove(job->tmppath);
+	}
+
+	Mem_Free(job->dir.p_rgEntries);
+	delete job;
+}
+#endif // REHLDS_OPT_PEDANTIC
+
 /* <2a7cb> ../engine/hashpak.c:65 */
 qboolean HPAK_GetDataPointer(char *pakname, struct resource_s *pResource, unsigned char **pbuffer, int *bufsize)
 {
@@ -89,6 +502,42 @@ qboolean HPAK_GetDataPointer(char *pakname, struct resource_s *pResource, unsign
 #endif // REHLDS_FIXES
 
 	COM_DefaultExtension(name, HASHPAK_EXTENSION);
+
+#ifdef REHLDS_OPT_PEDANTIC
+	hpakindex_t *idx = HPAK_GetIndex(name);
+	if (idx)
+	{
+		int i = HPAK_IndexFind(idx, pResource->rgucMD5_hash);
+		if (i == -1)
+			return FALSE;
+
+		entry = &idx->dir.p_rgEntries[i];
+		if (pbuffer && entry->nFileLength > 0)
+		{
+			fp = FS_Open(name, "rb");
+			if (!fp)
+				return FALSE;
+
+			FS_Seek(fp, entry->nOffset, FILESYSTEM_SEEK_HEAD);
+			pbuf = (byte *)Mem_Malloc(entry->nFileLength);
+			if (!pbuf)
+			{
+				Con_Printf("Couln't allocate %i bytes for HPAK entry\n", entry->nFileLength);
+				FS_Close(fp);
+				return FALSE;
+			}
+
+			FS_Read(pbuf, entry->nFileLength, 1, fp);
+			FS_Close(fp);
+			*pbuffer = pbuf;
+			if (bufsize)
+				*bufsize = entry->nFileLength;
+		}
+
+		return TRUE;
+	}
+#endif // REHLDS_OPT_PEDANTIC
+
 	fp = FS_Open(name, "rb");
 	if (!fp)
 	{
@@ -292,6 +741,10 @@ void HPAK_AddLump(qboolean bUseQueue, char *pakname, struct resource_s *pResourc
 	Q_strncpy(szOriginalName, name, ARRAYSIZE(szOriginalName) - 1);
 	szOriginalName[ARRAYSIZE(szOriginalName) - 1] = 0;
 
+#ifdef REHLDS_OPT_PEDANTIC
+	if (HPAK_AppendLump(name, pResource, pData, fpSource))
+		return;
+#endif // REHLDS_OPT_PEDANTIC
 
 	iRead = FS_Open(name, "rb");
 
@@ -444,6 +897,11 @@ void HPAK_RemoveLump(char *pakname, resource_t *pResource)
 
 #endif // REHLDS_FIXES
 
+#ifdef REHLDS_OPT_PEDANTIC
+	if (HPAK_AppendRemoval(szOriginalName, pResource))
+		return;
+#endif // REHLDS_OPT_PEDANTIC
+
 	fp = FS_Open(szOriginalName, "rb");
 	if (!fp)
 	{
@@ -634,6 +1092,22 @@ qboolean HPAK_ResourceForHash(char *pakname, unsigned char *hash, struct resourc
 #endif // REHLDS_FIXES
 
 	COM_DefaultExtension(name, HASHPAK_EXTENSION);
+
+#ifdef REHLDS_OPT_PEDANTIC
+	hpakindex_t *idx = HPAK_GetIndex(name);
+	if (idx)
+	{
+		int i = HPAK_IndexFind(idx, hash);
+		if (i == -1)
+			return FALSE;
+
+		if (pResourceEntry)
+			Q_memcpy(pResourceEntry, &idx->dir.p_rgEntries[i].resource, sizeof(resource_t));
+
+		return TRUE;
+	}
+#endif // REHLDS_OPT_PEDANTIC
+
 	fp = FS_Open(name, "rb");
 	if (!fp)
 	{
@@ -1270,11 +1744,22 @@ void HPAK_CheckSize(char *pakname)
 	actualSize = 0.0f;
 	maxSize *= 1000000.0f;
 
-	hfile = FS_Open(fullname, "rb");
-	if (hfile)
+#ifdef REHLDS_OPT_PEDANTIC
+	// Space left by appends is given back by HPAK_StartCompaction, only the live bytes count
+	hpakindex_t *idx = HPAK_GetIndex(fullname);
+	if (idx)
+	{
+		actualSize = (float)idx->livebytes;
+	}
+	else
+#endif // REHLDS_OPT_PEDANTIC
 	{
-		actualSize = (float)FS_Size(hfile);
-		FS_Close(hfile);
+		hfile = FS_Open(fullname, "rb");
+		if (hfile)
+		{
+			actualSize = (float)FS_Size(hfile);
+			FS_Close(hfile);
+		}
 	}
 	if (actualSize >= maxSize)
 	{
@@ -87,6 +87,33 @@ extern hash_pack_queue_t *gp_hpak_queue;
 extern hash_pack_directory_t hash_pack_dir;
 extern hash_pack_header_t hash_pack_header;
 
+#ifdef REHLDS_OPT_PEDANTIC
+// Directory of an HPAK kept in memory, valid while the file keeps its size and time
+typedef struct hpakindex_s
+{
+	char name[MAX_PATH];
+	int filesize;
+	int32 filetime;
+	hash_pack_header_t header;
+	hash_pack_directory_t dir;
+	int *buckets;		// entry index + 1, open addressing on the first bytes of the MD5
+	int numbuckets;
+	int livebytes;		// header, lumps and directory; the rest of the file is space left by appends
+	int dircapacity;	// bytes reserved for the current directory, appends reuse the slack
+	int spareoffset;	// region of the previous directory, the next directory goes there if it fits
+	int sparecapacity;
+	struct hpakindex_s *next;
+} hpakindex_t;
+
+hpakindex_t *HPAK_GetIndex(const char *name);
+int HPAK_IndexFind(hpakindex_t *idx, const unsigned char *hash);
+void HPAK_InvalidateIndex(const char *name);
+qboolean HPAK_AppendLump(const char *name, struct resource_s *pResource, void *pData, FileHandle_t fpSource);
+qboolean HPAK_AppendRemoval(const char *name, struct resource_s *pResource);
+void HPAK_StartCompaction(const char *pakname);
+void HPAK_PollCompaction(void);
+#endif // REHLDS_OPT_PEDANTIC
+
 qboolean HPAK_GetDataPointer(char *pakname, struct resource_s *pResource, unsigned char **pbuffer, int *bufsize);
 qboolean HPAK_FindResource(hash_pack_directory_t *pDir, unsigned char *hash, struct resource_s *pResourceEntry);
 void HPAK_AddToQueue(char *pakname, struct resource_s *pResource, void *pData, FileHandle_t fpSource);
@@ -916,6 +916,10 @@ void _Host_Frame(float time)
 
 	host_times[1] = Sys_FloatTime();
 	SV_Frame();
+#ifdef REHLDS_OPT_PEDANTIC
+	// every host frame ends the profiler frame, SV_Frame returns early while no server is running
+	FrameProfile_EndFrame();
+#endif // REHLDS_OPT_PEDANTIC
 	host_times[2] = Sys_FloatTime();
 	SV_CheckForRcon();
 
@@ -952,6 +956,10 @@ void _Host_Frame(float time)
 
 	if (sv_stats.value == 1.0f)
 		Host_UpdateStats();
+#ifdef REHLDS_OPT_PEDANTIC
+	else
+		Q_memset(&g_HostCpuStats, 0, sizeof(g_HostCpuStats));
+#endif // REHLDS_OPT_PEDANTIC
 
 	if (host_killtime.value != 0.0 && host_killtime.value < g_psv.time)
 	{
@@ -962,6 +970,7 @@ void _Host_Frame(float time)
 	Rehlds_Security_Frame();
 
 #ifdef REHLDS_FLIGHT_REC
+	FR_FlushThreadBuffers();
 	if (rehlds_flrec_frame.string[0] != '0') {
 		FR_EndFrame(frameCounter);
 	}
@@ -1162,6 +1171,15 @@ int Host_Init(quakeparms_t *parms)
 	FR_Rehlds_Init();
 #endif //REHLDS_FLIGHT_REC
 
+	HookChains_Init();
+
+#ifdef REHLDS_OPT_PEDANTIC
+	Sched_Init();
+	FrameProfile_Init();
+	DllProfile_Init();
+	Metrics_Init();
+#endif // REHLDS_OPT_PEDANTIC
+
 	V_Init();
 	Chase_Init();
 	COM_Init(parms->basedir);
@@ -1286,6 +1304,10 @@ void Host_Shutdown(void)
 
 	SV_Shutdown();
 	//SystemWrapper_ShutDown();
+#ifdef REHLDS_OPT_PEDANTIC
+	Sched_Shutdown();
+	Metrics_Shutdown();
+#endif // REHLDS_OPT_PEDANTIC
 	NET_Shutdown();
 	S_Shutdown();
 	Con_Shutdown();
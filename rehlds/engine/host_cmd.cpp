@@ -28,11 +28,16 @@
 
 #include "precompiled.h"
 
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+#include <sys/resource.h>
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+
 /* <3d3ff> ../engine/host_cmd.c:4378 */
 typedef int(*SV_BLENDING_INTERFACE_FUNC)(int, struct sv_blending_interface_s **, struct server_studio_api_s *, float *, float *);
 
 vec3_t r_origin;
 double cpuPercent;
+RehldsCpuStats_t g_HostCpuStats;
 int32 startTime;
 int current_skill;
 CareerStateType g_careerState;
@@ -320,17 +325,94 @@ int Host_GetStartTime(void)
 	return startTime;
 }
 
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+int64 Host_ClockNs(clockid_t clock)
+{
+	struct timespec ts;
+	if (clock_gettime(clock, &ts) != 0)
+		return 0;
+
+	return (int64)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Samples process and per-thread CPU clocks and rusage counters, must run on the main thread
+void Host_SampleCpuStats(void)
+{
+	static int64 lastWall = 0;
+	static int64 lastProcess = 0;
+	static int64 lastMain = 0;
+	static int64 lastWorker = 0;
+	static int64 lastNet = 0;
+	static struct rusage lastUsage;
+	static int64 avgWall = 0;
+	static int64 avgProcess = 0;
+
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+
+	int64 wall = Host_ClockNs(CLOCK_MONOTONIC);
+	int64 process = Host_ClockNs(CLOCK_PROCESS_CPUTIME_ID);
+	int64 mainThread = Host_ClockNs(CLOCK_THREAD_CPUTIME_ID);
+	int64 worker = Sys_WorkerCpuTime();
+	int64 net = NET_ThreadCpuTime();
+
+	if (lastWall && wall > lastWall)
+	{
+		double elapsed = (double)(wall - lastWall);
+
+		g_HostCpuStats.interval = elapsed / 1000000000.0;
+		g_HostCpuStats.cpuPercent = (process - lastProcess) / elapsed;
+		g_HostCpuStats.mainThreadPercent = (mainThread - lastMain) / elapsed;
+		g_HostCpuStats.workerPercent = (worker - lastWorker) / elapsed;
+
+		// the network thread may have been restarted since the last sample
+		g_HostCpuStats.netThreadPercent = (net >= lastNet) ? (net - lastNet) / elapsed : net / elapsed;
+
+		g_HostCpuStats.voluntarySwitches = (int)(usage.ru_nvcsw - lastUsage.ru_nvcsw);
+		g_HostCpuStats.involuntarySwitches = (int)(usage.ru_nivcsw - lastUsage.ru_nivcsw);
+		g_HostCpuStats.minorFaults = (int)(usage.ru_minflt - lastUsage.ru_minflt);
+		g_HostCpuStats.majorFaults = (int)(usage.ru_majflt - lastUsage.ru_majflt);
+	}
+
+	// the stats CPU column keeps its old smoothing, averaged since a baseline moved every 5 seconds
+	if (avgWall && wall > avgWall)
+	{
+		cpuPercent = (process - avgProcess) / (double)(wall - avgWall);
+		if (cpuPercent > 0.999)
+			cpuPercent = 0.999;
+		else if (cpuPercent < 0.0)
+			cpuPercent = 0.0;
+	}
+
+	if (!avgWall || wall - avgWall > 5000000000LL)
+	{
+		avgWall = wall;
+		avgProcess = process;
+	}
+
+	lastWall = wall;
+	lastProcess = process;
+	lastMain = mainThread;
+	lastWorker = worker;
+	lastNet = net;
+	lastUsage = usage;
+}
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+
 /* <3e39a> ../engine/host_cmd.c:405 */
 void Host_UpdateStats(void)
 {
+	static float last = 0.0f;
+
+#if defined(_WIN32) || !defined(REHLDS_OPT_PEDANTIC)
 	uint32 runticks = 0;
 	uint32 cputicks = 0;
 
-	static float last = 0.0f;
 	static float lastAvg = 0.0f;
 
 	static uint64 lastcputicks = 0;
 	static uint64 lastrunticks = 0;
+#endif // defined(_WIN32) || !defined(REHLDS_OPT_PEDANTIC)
 
 #ifdef _WIN32
 
@@ -375,6 +457,21 @@ void Host_UpdateStats(void)
 			lastrunticks = FILETIME_TO_QWORD(UserTime) + FILETIME_TO_QWORD(KernelTime);
 			lastAvg = last;
 		}
+#ifdef REHLDS_OPT_PEDANTIC
+		g_HostCpuStats.interval = Sys_FloatTime() - last;
+		g_HostCpuStats.cpuPercent = cpuPercent;
+#endif // REHLDS_OPT_PEDANTIC
+		last = Sys_FloatTime();
+	}
+
+#elif defined(REHLDS_OPT_PEDANTIC)
+
+	if (!startTime)
+		startTime = Sys_FloatTime();
+
+	if (Sys_FloatTime() > last + 1.0f)
+	{
+		Host_SampleCpuStats();
 		last = Sys_FloatTime();
 	}
 
@@ -478,6 +575,20 @@ void Host_Stats_f(void)
 	char stats[512];
 	GetStatsString(stats, sizeof(stats));
 	Con_Printf("CPU   In    Out   Uptime  Users   FPS    Players\n%s\n", stats);
+
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+	if (g_HostCpuStats.interval > 0.0)
+	{
+		Con_Printf("Main  Work  Net   CtxSw(vol/invol) Faults(min/maj)\n%5.2f %5.2f %5.2f %7i/%-8i %7i/%i\n",
+			(float)(100.0 * g_HostCpuStats.mainThreadPercent),
+			(float)(100.0 * g_HostCpuStats.workerPercent),
+			(float)(100.0 * g_HostCpuStats.netThreadPercent),
+			g_HostCpuStats.voluntarySwitches,
+			g_HostCpuStats.involuntarySwitches,
+			g_HostCpuStats.minorFaults,
+			g_HostCpuStats.majorFaults);
+	}
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
 }
 
 /* <3d5c9> ../engine/host_cmd.c:626 */
@@ -656,15 +767,15 @@ void Host_Status_f(void)
 		Host_Status_Printf(conprint, log, "#%2i %8s %i %s", count++, va("\"%s\"", client->name), client->userid, val);
 		if (client->proxy)
 		{
-			const char *userInfo = Info_ValueForKey(client->userinfo, "hspecs");
+			const char *userInfo = SV_ClientInfoValueForKey(client->userinfo, "hspecs");
 			if (Q_strlen(userInfo))
 				hltv_specs = Q_atoi(userInfo);
 
-			userInfo = Info_ValueForKey(client->userinfo, "hslots");
+			userInfo = SV_ClientInfoValueForKey(client->userinfo, "hslots");
 			if (Q_strlen(userInfo))
 				hltv_slots = Q_atoi(userInfo);
 
-			userInfo = Info_ValueForKey(client->userinfo, "hdelay");
+			userInfo = SV_ClientInfoValueForKey(client->userinfo, "hdelay");
 			if (Q_strlen(userInfo))
 				hltv_delay = Q_atoi(userInfo);
 
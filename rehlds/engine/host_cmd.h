@@ -115,6 +115,7 @@ typedef struct TITLECOMMENT_s
 extern int r_dointerp;
 extern vec3_t r_origin;
 extern double cpuPercent;
+extern RehldsCpuStats_t g_HostCpuStats;
 extern int32 startTime;
 extern int current_skill;
 extern int gHostSpawnCount;
@@ -138,6 +139,10 @@ void Host_InitializeGameDLL(void);
 void Host_Motd_f(void);
 void Host_Motd_Write_f(void);
 int Host_GetStartTime(void);
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+int64 Host_ClockNs(clockid_t clock);
+void Host_SampleCpuStats(void);
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
 void Host_UpdateStats(void);
 void GetStatsString(char *buf, int bufSize);
 void Host_Stats_f(void);
@@ -106,6 +106,121 @@ const char* EXT_FUNC Info_ValueForKey(const char *s, const char *key)
 	return "";
 }
 
+#ifdef REHLDS_OPT_PEDANTIC
+static unsigned int Info_HashKey(const char *key, int len)
+{
+	unsigned int hash = 0;
+	for (int i = 0; i < len; i++)
+		hash = hash * 31 + (unsigned char)key[i];
+
+	return hash;
+}
+
+// Splits the string the same way Info_ValueForKey walks it
+static void Info_BuildCache(infocache_t *cache, const char *s)
+{
+	Q_strcpy(cache->raw, s);
+	cache->numkeys = 0;
+	Q_memset(cache->buckets, 0xFF, sizeof(cache->buckets));
+
+	const char *base = cache->raw;
+	const char *p = base;
+	while (*p)
+	{
+		if (*p == '\\')
+		{
+			p++;	// skip the slash
+		}
+
+		const char *key = p;
+		while (*p != '\\')
+		{
+			if (!*p)
+				goto done;	// key without a value
+
+			p++;
+		}
+
+		int keylen = p - key;
+		p++;	// skip the slash
+
+		const char *value = p;
+		while (*p && *p != '\\')
+			p++;
+
+		infocacheentry_t *entry = &cache->entries[cache->numkeys++];
+		entry->keyofs = key - base;
+		entry->keylen = min(keylen, MAX_KV_LEN);
+		entry->valueofs = value - base;
+		entry->valuelen = min((int)(p - value), MAX_KV_LEN);
+		entry->hash = Info_HashKey(key, entry->keylen);
+	}
+
+done:
+	// link in reverse so the first occurrence of a key is found first
+	for (int i = cache->numkeys - 1; i >= 0; i--)
+	{
+		infocacheentry_t *entry = &cache->entries[i];
+		int bucket = entry->hash & (INFO_CACHE_BUCKETS - 1);
+		entry->next = cache->buckets[bucket];
+		cache->buckets[bucket] = i;
+	}
+
+	cache->valid = TRUE;
+}
+
+void Info_InvalidateCache(infocache_t *cache)
+{
+	cache->valid = FALSE;
+}
+
+/*
+===============
+Info_CachedValueForKey
+
+Same result as Info_ValueForKey, answered from a parsed view of the string.
+The view is rebuilt only when the string differs from the one it was parsed from.
+===============
+*/
+const char *Info_CachedValueForKey(infocache_t *cache, const char *s, const char *key)
+{
+	static char value[INFO_MAX_BUFFER_VALUES][MAX_KV_LEN + 1];
+	static int valueindex;
+
+	if (!cache->valid || Q_strcmp(cache->raw, s))
+	{
+		if (Q_strlen(s) >= sizeof(cache->raw))
+		{
+			cache->valid = FALSE;
+			return Info_ValueForKey(s, key);
+		}
+
+		Info_BuildCache(cache, s);
+	}
+
+	int keylen = Q_strlen(key);
+	if (keylen > MAX_KV_LEN)
+		return "";
+
+	unsigned int hash = Info_HashKey(key, keylen);
+	for (int i = cache->buckets[hash & (INFO_CACHE_BUCKETS - 1)]; i != -1; i = cache->entries[i].next)
+	{
+		infocacheentry_t *entry = &cache->entries[i];
+		if (entry->hash != hash || entry->keylen != keylen || Q_memcmp(&cache->raw[entry->keyofs], key, keylen))
+			continue;
+
+		// hand out a copy, callers may hold or modify it
+		char *c = value[valueindex];
+		valueindex = (valueindex + 1) % INFO_MAX_BUFFER_VALUES;
+		Q_memcpy(c, &cache->raw[entry->valueofs], entry->valuelen);
+		c[entry->valuelen] = 0;
+		return c;
+	}
+
+	return "";
+}
+#endif // REHLDS_OPT_PEDANTIC
+
 /* <40e38> ../engine/info.c:72 */
 void Info_RemoveKey(char *s, const char *key)
 {
@@ -42,6 +42,30 @@
 
 #define INFO_MAX_BUFFER_VALUES 4
 
+#ifdef REHLDS_OPT_PEDANTIC
+#define INFO_CACHE_BUCKETS 32
+
+typedef struct infocacheentry_s
+{
+	short keyofs;
+	short keylen;
+	short valueofs;
+	short valuelen;
+	short next;
+	unsigned int hash;
+} infocacheentry_t;
+
+// Parsed and hashed view of an info string
+typedef struct infocache_s
+{
+	qboolean valid;
+	char raw[MAX_INFO_STRING];	// string the view was built from
+	int numkeys;
+	short buckets[INFO_CACHE_BUCKETS];
+	infocacheentry_t entries[MAX_INFO_STRING / 2];
+} infocache_t;
+#endif // REHLDS_OPT_PEDANTIC
+
 
 const char *Info_ValueForKey(const char *s, const char *key);
 void Info_RemoveKey(char *s, const char *key);
@@ -53,4 +77,9 @@ void Info_SetValueForKey(char *s, const char *key, const char *value, int maxsiz
 void Info_Print(const char *s);
 qboolean Info_IsValid(const char *s);
 
+#ifdef REHLDS_OPT_PEDANTIC
+void Info_InvalidateCache(infocache_t *cache);
+const char *Info_CachedValueForKey(infocache_t *cache, const char *s, const char *key);
+#endif // REHLDS_OPT_PEDANTIC
+
 #endif // INFO__H
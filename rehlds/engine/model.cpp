@@ -39,6 +39,16 @@ int ad_enabled;
 cachewad_t ad_wad;
 mod_known_info_t mod_known_info[MAX_KNOWN_MODELS];
 
+#ifdef REHLDS_OPT_PEDANTIC
+packedhull_t mod_packedhulls[MAX_PACKED_HULLS];
+int mod_numpackedhulls;
+
+cvar_t sv_modelcache_mb = { "sv_modelcache_mb", "0", 0, 0.0f, NULL };
+residentmodel_t *mod_resident;
+int mod_residentbytes;
+unsigned int mod_residentclock;
+#endif // REHLDS_OPT_PEDANTIC
+
 // values for model_t's needload
 #define NL_PRESENT		0
 #define NL_NEEDS_LOADED	1
@@ -125,6 +135,14 @@ void Mod_ClearAll(void)
 				mod->cache.data = NULL;
 		}
 	}
+
+#ifdef REHLDS_OPT_PEDANTIC
+	// packed hulls live on the hunk together with the brush models they were built from
+	Mod_ClearPackedHulls();
+
+	// files changed on disk between maps are picked up by the next load
+	Mod_ResidentUncheck();
+#endif // REHLDS_OPT_PEDANTIC
 }
 
 /* <5151a> ../engine/model.c:248 */
@@ -254,6 +272,203 @@ qboolean IsCZPlayerModel(uint32 crc, const char  * filename)
 	return 0;
 }
 
+#ifdef REHLDS_OPT_PEDANTIC
+static void Mod_ResidentFree(residentmodel_t **link)
+{
+	residentmodel_t *r = *link;
+	*link = r->next;
+	mod_residentbytes -= r->length;
+	Mem_Free(r->data);
+	Mem_Free(r);
+}
+
+// Drops least recently used files until 'needed' more bytes fit in the budget
+static void Mod_ResidentTrim(int budget, int needed)
+{
+	while (mod_resident && mod_residentbytes + needed > budget)
+	{
+		residentmodel_t **oldest = &mod_resident;
+		for (residentmodel_t **link = &mod_resident; *link; link = &(*link)->next)
+		{
+			if ((*link)->lastUsed < (*oldest)->lastUsed)
+				oldest = link;
+		}
+
+		Mod_ResidentFree(oldest);
+	}
+}
+
+static int Mod_ResidentBudget(void)
+{
+	int budget = (int)(sv_modelcache_mb.value * 1024.0f * 1024.0f);
+	if (budget <= 0)
+	{
+		// turned off, release everything
+		if (mod_resident)
+			Mod_ResidentFlush();
+
+		return 0;
+	}
+
+	return budget;
+}
+
+// Returns the entry for 'name'. The file on disk is checked for the same size and time
+// on the first lookup after Mod_ClearAll only, the entry is trusted for the rest of the map
+static residentmodel_t *Mod_ResidentFind(const char *name)
+{
+	for (residentmodel_t **link = &mod_resident; *link; link = &(*link)->next)
+	{
+		residentmodel_t *r = *link;
+		if (Q_stricmp(r->name, name))
+			continue;
+
+		if (!r->checked)
+		{
+			if ((int)FS_FileSize(name) != r->length || FS_GetFileTime(name) != r->filetime)
+			{
+				Mod_ResidentFree(link);
+				return NULL;
+			}
+
+			r->checked = TRUE;
+		}
+
+		r->lastUsed = ++mod_residentclock;
+		return r;
+	}
+
+	return NULL;
+}
+
+// Returns a private copy of the resident file, to be released with Mem_Free like COM_LoadFileForMe's buffer
+unsigned char *Mod_ResidentLoad(const char *name, int *length, CRC32_t *crc)
+{
+	if (!Mod_ResidentBudget())
+		return NULL;
+
+	residentmodel_t *r = Mod_ResidentFind(name);
+	if (!r)
+		return NULL;
+
+	unsigned char *buf = (unsigned char *)Mem_Malloc(r->length + 1);
+	Q_memcpy(buf, r->data, r->length + 1);
+	r->uses++;
+	*length = r->length;
+	*crc = r->crc;
+	return buf;
+}
+
+void Mod_ResidentStore(const char *name, const unsigned char *buf, int length)
+{
+	int budget = Mod_ResidentBudget();
+	if (!budget || length <= 4 || length > budget)
+		return;
+
+	uint32 ident = LittleLong(*(uint32 *)buf);
+	if (ident != 'TSDI' && ident != 'PSDI')
+		return;
+
+	int32 filetime = FS_GetFileTime(name);
+	if (filetime == -1 || filetime == 0 || (int)FS_FileSize(name) != length)
+		return;
+
+	if (Mod_ResidentFind(name))
+		return;
+
+	Mod_ResidentTrim(budget, length);
+
+	residentmodel_t *r = (residentmodel_t *)Mem_ZeroMalloc(sizeof(residentmodel_t));
+	Q_strncpy(r->name, name, sizeof(r->name) - 1);
+	r->name[sizeof(r->name) - 1] = 0;
+	r->data = (unsigned char *)Mem_Malloc(length + 1);
+	Q_memcpy(r->data, buf, length);
+	r->data[length] = 0;
+	r->length = length;
+	r->filetime = filetime;
+	r->checked = TRUE;
+	r->lastUsed = ++mod_residentclock;
+
+	CRC32_Init(&r->crc);
+	CRC32_ProcessBuffer(&r->crc, r->data, length);
+	r->crc = CRC32_Final(r->crc);
+
+	r->next = mod_resident;
+	mod_resident = r;
+	mod_residentbytes += length;
+}
+
+// R_GetStudioBounds for resident files, computed once per file
+qboolean Mod_ResidentStudioBounds(const char *name, float *mins, float *maxs, int *result)
+{
+	if (!Mod_ResidentBudget())
+		return FALSE;
+
+	residentmodel_t *r = Mod_ResidentFind(name);
+	if (!r)
+		return FALSE;
+
+	if (!r->boundsDone)
+	{
+		r->boundsResult = 0;
+		if (LittleLong(*(uint32 *)r->data) == 'TSDI')
+			r->boundsResult = R_StudioComputeBounds(r->data, mins, maxs);
+
+		Q_memcpy(r->mins, mins, sizeof(vec3_t));
+		Q_memcpy(r->maxs, maxs, sizeof(vec3_t));
+		r->boundsDone = TRUE;
+	}
+	else
+	{
+		Q_memcpy(mins, r->mins, sizeof(vec3_t));
+		Q_memcpy(maxs, r->maxs, sizeof(vec3_t));
+	}
+
+	*result = r->boundsResult;
+	return TRUE;
+}
+
+void Mod_ResidentFlush(void)
+{
+	while (mod_resident)
+		Mod_ResidentFree(&mod_resident);
+}
+
+void Mod_ResidentUncheck(void)
+{
+	for (residentmodel_t *r = mod_resident; r; r = r->next)
+		r->checked = FALSE;
+}
+
+void Mod_ResidentList_f(void)
+{
+	int count = 0;
+
+	Con_Printf("Resident models (least recently used last):\n");
+
+	// walk in descending lastUsed order
+	unsigned int bound = UINT_MAX;
+	while (true)
+	{
+		residentmodel_t *next = NULL;
+		for (residentmodel_t *r = mod_resident; r; r = r->next)
+		{
+			if (r->lastUsed < bound && (!next || r->lastUsed > next->lastUsed))
+				next = r;
+		}
+
+		if (!next)
+			break;
+
+		Con_Printf("%8.1f KB  %5u uses  %s\n", next->length / 1024.0f, next->uses, next->name);
+		bound = next->lastUsed;
+		count++;
+	}
+
+	Con_Printf("%i models, %.2f MB of %.2f MB\n", count, mod_residentbytes / (1024.0f * 1024.0f), sv_modelcache_mb.value);
+}
+#endif // REHLDS_OPT_PEDANTIC
+
 /* <513ce> ../engine/model.c:394 */
 model_t *Mod_LoadModel(model_t *mod, qboolean crash, qboolean trackCRC)
 {
@@ -289,7 +504,19 @@ model_t *Mod_LoadModel(model_t *mod, qboolean crash, qboolean trackCRC)
 		mod->name[sizeof(mod->name) - 1] = '\0';
 	}
 
+#ifdef REHLDS_OPT_PEDANTIC
+	CRC32_t residentCRC;
+	buf = Mod_ResidentLoad(mod->name, &length, &residentCRC);
+	qboolean resident = buf ? TRUE : FALSE;
+	if (!resident)
+	{
+		buf = COM_LoadFileForMe(mod->name, &length);
+		if (buf)
+			Mod_ResidentStore(mod->name, buf, length);
+	}
+#else // REHLDS_OPT_PEDANTIC
 	buf = COM_LoadFileForMe(mod->name, &length);
+#endif // REHLDS_OPT_PEDANTIC
 	if (!buf)
 	{
 		if (crash)
@@ -303,9 +530,16 @@ model_t *Mod_LoadModel(model_t *mod, qboolean crash, qboolean trackCRC)
 		mod_known_info_t *p = &mod_known_info[mod - mod_known];
 		if (p->shouldCRC)
 		{
-			CRC32_Init(&currentCRC);
-			CRC32_ProcessBuffer(&currentCRC, buf, length);
-			currentCRC = CRC32_Final(currentCRC);
+#ifdef REHLDS_OPT_PEDANTIC
+			if (resident)
+				currentCRC = residentCRC;
+			else
+#endif // REHLDS_OPT_PEDANTIC
+			{
+				CRC32_Init(&currentCRC);
+				CRC32_ProcessBuffer(&currentCRC, buf, length);
+				currentCRC = CRC32_Final(currentCRC);
+			}
 			if (p->firstCRCDone)
 			{
 				if (currentCRC != p->initialCRC)
@@ -1233,6 +1467,78 @@ void Mod_LoadPlanes(lump_t *l)
 	}
 }
 
+#ifdef REHLDS_OPT_PEDANTIC
+void Mod_ClearPackedHulls(void)
+{
+	Q_memset(mod_packedhulls, 0, sizeof(mod_packedhulls));
+	mod_numpackedhulls = 0;
+}
+
+packedclipnode_t *Mod_PackClipnodes(const dclipnode_t *clipnodes, int numnodes, const mplane_t *planes, int numplanes)
+{
+	packedclipnode_t *nodes;
+	packedhull_t *packed;
+	const mplane_t *plane;
+	int i;
+
+	if (!clipnodes || !planes || numnodes <= 0)
+		return NULL;
+
+	for (i = 0; i < mod_numpackedhulls; i++)
+	{
+		if (mod_packedhulls[i].clipnodes == clipnodes && mod_packedhulls[i].planes == planes)
+			return mod_packedhulls[i].nodes;
+	}
+
+	if (mod_numpackedhulls >= MAX_PACKED_HULLS)
+	{
+		Con_DPrintf("%s: too many packed hulls, %s will use unpacked clipnodes\n", __FUNCTION__, loadmodel ? loadmodel->name : "?");
+		return NULL;
+	}
+
+	for (i = 0; i < numnodes; i++)
+	{
+		// leave malformed hulls to the generic tracers so they fail the same way as before
+		if (clipnodes[i].planenum < 0 || clipnodes[i].planenum >= numplanes)
+			return NULL;
+	}
+
+	// two nodes per cache line
+	nodes = (packedclipnode_t *)Hunk_AllocName(numnodes * sizeof(packedclipnode_t) + 63, loadname);
+	nodes = (packedclipnode_t *)(((size_t)nodes + 63) & ~(size_t)63);
+
+	for (i = 0; i < numnodes; i++)
+	{
+		plane = &planes[clipnodes[i].planenum];
+		nodes[i].normal[0] = plane->normal[0];
+		nodes[i].normal[1] = plane->normal[1];
+		nodes[i].normal[2] = plane->normal[2];
+		nodes[i].dist = plane->dist;
+		nodes[i].type = plane->type;
+		nodes[i].children[0] = clipnodes[i].children[0];
+		nodes[i].children[1] = clipnodes[i].children[1];
+	}
+
+	packed = &mod_packedhulls[mod_numpackedhulls++];
+	packed->clipnodes = clipnodes;
+	packed->planes = planes;
+	packed->nodes = nodes;
+	packed->numnodes = numnodes;
+
+	return nodes;
+}
+
+void Mod_PackHulls(model_t *mod)
+{
+	// Mod_LoadPlanes allocates twice as many planes as the lump holds
+	int numplanes = mod->numplanes * 2;
+
+	// hull 0 is built from the render nodes, hulls 1..3 share the clipnodes lump
+	Mod_PackClipnodes(mod->hulls[0].clipnodes, mod->numnodes, mod->hulls[0].planes, numplanes);
+	Mod_PackClipnodes(mod->clipnodes, mod->numclipnodes, mod->hulls[1].planes, numplanes);
+}
+#endif // REHLDS_OPT_PEDANTIC
+
 /* <5229e> ../engine/model.c:1566 */
 float RadiusFromBounds(vec_t *mins, vec_t *maxs)
 {
@@ -1297,6 +1603,9 @@ void EXT_FUNC Mod_LoadBrushModel_internal(model_t *mod, void *buffer)
 	Mod_LoadClipnodes(&header->lumps[LUMP_CLIPNODES]);
 	Mod_LoadSubmodels(&header->lumps[LUMP_MODELS]);
 	Mod_MakeHull0();
+#ifdef REHLDS_OPT_PEDANTIC
+	Mod_PackHulls(mod);
+#endif // REHLDS_OPT_PEDANTIC
 	mod->numframes = 2;
 	mod->flags = 0;
 	i = 0;
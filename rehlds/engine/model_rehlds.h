@@ -69,6 +69,75 @@ extern int ad_enabled;
 extern cachewad_t ad_wad;
 extern mod_known_info_t mod_known_info[MAX_KNOWN_MODELS];
 
+#ifdef REHLDS_OPT_PEDANTIC
+#define MAX_PACKED_HULLS	32
+
+// Clipnode with its plane copied inline: hull traversal touches a single 32-byte
+// record per node instead of chasing dclipnode_t -> mplane_t
+typedef struct packedclipnode_s
+{
+	vec3_t			normal;
+	float			dist;
+	int				type;
+	int				children[2];
+	int				pad;
+} packedclipnode_t;
+
+// Maps a (clipnodes, planes) pair shared by the hulls of a brush model to its packed copy
+typedef struct packedhull_s
+{
+	const dclipnode_t	*clipnodes;
+	const mplane_t		*planes;
+	packedclipnode_t	*nodes;
+	int					numnodes;
+} packedhull_t;
+
+extern packedhull_t mod_packedhulls[MAX_PACKED_HULLS];
+extern int mod_numpackedhulls;
+
+void Mod_ClearPackedHulls(void);
+packedclipnode_t *Mod_PackClipnodes(const dclipnode_t *clipnodes, int numnodes, const mplane_t *planes, int numplanes);
+void Mod_PackHulls(model_t *mod);
+
+inline packedclipnode_t *Mod_FindPackedClipnodes(const hull_t *hull)
+{
+	for (int i = 0; i < mod_numpackedhulls; i++)
+	{
+		if (mod_packedhulls[i].clipnodes == hull->clipnodes && mod_packedhulls[i].planes == hull->planes)
+			return mod_packedhulls[i].nodes;
+	}
+
+	return NULL;
+}
+
+// Raw studio/sprite model file kept in memory across map changes (sv_modelcache_mb)
+typedef struct residentmodel_s
+{
+	char			name[64];
+	unsigned char	*data;
+	int				length;
+	int32			filetime;
+	qboolean		checked;	// size and time compared with the file on disk since the last Mod_ClearAll
+	CRC32_t			crc;
+	qboolean		boundsDone;
+	int				boundsResult;
+	vec3_t			mins;
+	vec3_t			maxs;
+	unsigned int	lastUsed;
+	unsigned int	uses;
+	struct residentmodel_s *next;
+} residentmodel_t;
+
+extern cvar_t sv_modelcache_mb;
+
+unsigned char *Mod_ResidentLoad(const char *name, int *length, CRC32_t *crc);
+void Mod_ResidentStore(const char *name, const unsigned char *buf, int length);
+qboolean Mod_ResidentStudioBounds(const char *name, float *mins, float *maxs, int *result);
+void Mod_ResidentFlush(void);
+void Mod_ResidentUncheck(void);
+void Mod_ResidentList_f(void);
+#endif // REHLDS_OPT_PEDANTIC
+
 void SW_Mod_Init(void);
 void *Mod_Extradata(model_t *mod);
 mleaf_t *Mod_PointInLeaf(vec_t *p, model_t *model);
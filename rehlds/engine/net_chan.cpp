@@ -28,6 +28,8 @@
 
 #include "precompiled.h"
 
+#include <atomic>
+
 
 int net_drop;
 
@@ -58,6 +60,180 @@ cvar_t sv_filetransfermaxsize;
 
 #endif //HOOK_ENGINE
 
+#ifdef REHLDS_OPT_PEDANTIC
+filebuffer_t *g_FileBuffers;
+
+filebuffer_t *Netchan_FindFileBuffer(const char *filename, qboolean compressed)
+{
+	for (filebuffer_t *fb = g_FileBuffers; fb; fb = fb->next)
+	{
+		if (fb->compressed == compressed && !Q_strcmp(fb->filename, filename))
+			return fb;
+	}
+
+	return NULL;
+}
+
+// Adds 'refs' references to the shared contents of the file, (re)loading them if needed.
+// Returns NULL if the file can't be loaded, fragments then read it from disk as usual
+filebuffer_t *Netchan_AcquireFileBuffer(const char *filename, qboolean compressed, int refs)
+{
+	char name[MAX_PATH];
+	if (compressed)
+		Q_snprintf(name, sizeof(name), "%s.ztmp", filename);
+	else
+		Q_snprintf(name, sizeof(name), "%s", filename);
+
+	int32 filetime = FS_GetFileTime(name);
+	filebuffer_t *fb = Netchan_FindFileBuffer(filename, compressed);
+	if (fb && fb->filetime == filetime)
+	{
+		fb->refcount += refs;
+		return fb;
+	}
+
+	FileHandle_t hfile = FS_Open(name, "rb");
+	if (!hfile)
+		return NULL;
+
+	int size = FS_Size(hfile);
+	unsigned char *data = (size > 0) ? (unsigned char *)Mem_Malloc(size) : NULL;
+	if (!data || FS_Read(data, size, 1, hfile) != size)
+	{
+		FS_Close(hfile);
+		if (data)
+			Mem_Free(data);
+
+		return NULL;
+	}
+	FS_Close(hfile);
+
+	if (!fb)
+	{
+		fb = (filebuffer_t *)Mem_ZeroMalloc(sizeof(filebuffer_t));
+		Q_strncpy(fb->filename, filename, sizeof(fb->filename) - 1);
+		fb->filename[sizeof(fb->filename) - 1] = 0;
+		fb->compressed = compressed;
+		fb->next = g_FileBuffers;
+		g_FileBuffers = fb;
+	}
+	else
+	{
+		// file changed on disk, fragments in flight pick up the new contents like they would reading it
+		Mem_Free(fb->data);
+	}
+
+	fb->data = data;
+	fb->size = size;
+	fb->filetime = filetime;
+	fb->refcount += refs;
+	return fb;
+}
+
+void Netchan_ReleaseFileBuffer(const char *filename, qboolean compressed)
+{
+	for (filebuffer_t **link = &g_FileBuffers; *link; link = &(*link)->next)
+	{
+		filebuffer_t *fb = *link;
+		if (fb->compressed != compressed || Q_strcmp(fb->filename, filename))
+			continue;
+
+		if (--fb->refcount <= 0)
+		{
+			*link = fb->next;
+			Mem_Free(fb->data);
+			Mem_Free(fb);
+		}
+		return;
+	}
+}
+
+// Freed fragbufs and waiting lists are kept for reuse, up to these counts
+#define FRAGBUF_POOL_MAX	2048
+#define FRAGWAIT_POOL_MAX	256
+
+cvar_t sv_fragquota = { "sv_fragquota", "0", 0, 0.0f, NULL };
+
+fragbuf_t *g_FragbufPool;
+int g_NumPooledFragbufs;
+fragbufwaiting_t *g_FragwaitPool;
+int g_NumPooledFragwaits;
+
+void Netchan_FreeFragbuf(fragbuf_t *buf)
+{
+	if (buf->isfile && !buf->isbuffer)
+		Netchan_ReleaseFileBuffer(buf->filename, buf->iscompressed);
+
+	if (g_NumPooledFragbufs >= FRAGBUF_POOL_MAX)
+	{
+		Mem_Free(buf);
+		return;
+	}
+
+	buf->next = g_FragbufPool;
+	g_FragbufPool = buf;
+	g_NumPooledFragbufs++;
+}
+
+fragbufwaiting_t *Netchan_AllocFragwait(void)
+{
+	fragbufwaiting_t *wait = g_FragwaitPool;
+	if (!wait)
+		return (fragbufwaiting_t *)Mem_ZeroMalloc(sizeof(fragbufwaiting_t));
+
+	g_FragwaitPool = wait->next;
+	g_NumPooledFragwaits--;
+	Q_memset(wait, 0, sizeof(fragbufwaiting_t));
+	return wait;
+}
+
+void Netchan_FreeFragwait(fragbufwaiting_t *wait)
+{
+	Netchan_CancelCompression(wait);
+
+	if (g_NumPooledFragwaits >= FRAGWAIT_POOL_MAX)
+	{
+		Mem_Free(wait);
+		return;
+	}
+
+	wait->next = g_FragwaitPool;
+	g_FragwaitPool = wait;
+	g_NumPooledFragwaits++;
+}
+
+// Outgoing fragments queued on the channel, sent or waiting
+int Netchan_QueuedFragments(netchan_t *chan)
+{
+	int count = 0;
+	for (int i = 0; i < MAX_STREAMS; i++)
+	{
+		for (fragbufwaiting_t *wait = chan->waitlist[i]; wait; wait = wait->next)
+			count += wait->fragbufcount;
+
+		for (fragbuf_t *buf = chan->fragbufs[i]; buf; buf = buf->next)
+			count++;
+	}
+
+	return count;
+}
+
+// True if queueing 'count' more fragments would take a client's channel over sv_fragquota
+qboolean Netchan_FragQuotaExceeded(netchan_t *chan, int count)
+{
+	// not for the local client's channel to the server
+	if (chan == &g_pcls.netchan || sv_fragquota.value <= 0.0f)
+		return FALSE;
+
+	int queued = Netchan_QueuedFragments(chan);
+	if (queued + count <= (int)sv_fragquota.value)
+		return FALSE;
+
+	Con_DPrintf("%s: %i fragments queued, %i more would exceed sv_fragquota\n", NET_AdrToString(chan->remote_address), queued, count);
+	return TRUE;
+}
+#endif // REHLDS_OPT_PEDANTIC
+
 /* <6565b> ../engine/net_chan.c:103 */
 void Netchan_UnlinkFragment(fragbuf_t *buf, fragbuf_t **list)
 {
@@ -72,7 +248,11 @@ void Netchan_UnlinkFragment(fragbuf_t *buf, fragbuf_t **list)
 	if (*list == buf)
 	{
 		*list = buf->next;
+#ifdef REHLDS_OPT_PEDANTIC
+		Netchan_FreeFragbuf(buf);
+#else // REHLDS_OPT_PEDANTIC
 		Mem_Free(buf);
+#endif // REHLDS_OPT_PEDANTIC
 		return;
 	}
 
@@ -82,7 +262,11 @@ void Netchan_UnlinkFragment(fragbuf_t *buf, fragbuf_t **list)
 		if (search->next == buf)
 		{
 			search->next = buf->next;
+#ifdef REHLDS_OPT_PEDANTIC
+			Netchan_FreeFragbuf(buf);
+#else // REHLDS_OPT_PEDANTIC
 			Mem_Free(buf);
+#endif // REHLDS_OPT_PEDANTIC
 			return;
 		}
 		search = search->next;
@@ -141,7 +325,11 @@ void Netchan_ClearFragbufs(fragbuf_t **ppbuf)
 	while (buf)
 	{
 		n = buf->next;
+#ifdef REHLDS_OPT_PEDANTIC
+		Netchan_FreeFragbuf(buf);
+#else // REHLDS_OPT_PEDANTIC
 		Mem_Free(buf);
+#endif // REHLDS_OPT_PEDANTIC
 		buf = n;
 	}
 	*ppbuf = NULL;
@@ -158,7 +346,11 @@ void Netchan_ClearFragments(netchan_t *chan)
 		{
 			next = wait->next;
 			Netchan_ClearFragbufs(&wait->fragbufs);
+#ifdef REHLDS_OPT_PEDANTIC
+			Netchan_FreeFragwait(wait);
+#else // REHLDS_OPT_PEDANTIC
 			Mem_Free(wait);
+#endif // REHLDS_OPT_PEDANTIC
 			wait = next;
 		}
 		chan->waitlist[i] = NULL;
@@ -344,7 +536,12 @@ void Netchan_Transmit(netchan_t *chan, int length, byte *data)
 		}
 
 		// Stall reliable payloads if sending from frag buffer
+#ifdef REHLDS_OPT_PEDANTIC
+		// or if fragments queued before them are still being compressed
+		if (send_from_regular && (send_from_frag[FRAG_NORMAL_STREAM] || chan->waitlist[FRAG_NORMAL_STREAM]))
+#else // REHLDS_OPT_PEDANTIC
 		if (send_from_regular && (send_from_frag[FRAG_NORMAL_STREAM]))
+#endif // REHLDS_OPT_PEDANTIC
 		{
 			send_from_regular = false;
 
@@ -353,7 +550,14 @@ void Netchan_Transmit(netchan_t *chan, int length, byte *data)
 			if (chan->message.cursize > MAX_RELIABLE_PAYLOAD)
 			{
 				Netchan_CreateFragments_(chan == &g_pcls.netchan ? 1 : 0, chan, &chan->message);
+#ifdef REHLDS_OPT_PEDANTIC
+				// keep the overflow from a hit fragment quota
+				int overflowed = chan->message.flags & SIZEBUF_OVERFLOWED;
+				SZ_Clear(&chan->message);
+				chan->message.flags |= overflowed;
+#else // REHLDS_OPT_PEDANTIC
 				SZ_Clear(&chan->message);
+#endif // REHLDS_OPT_PEDANTIC
 			}
 		}
 
@@ -412,6 +616,27 @@ void Netchan_Transmit(netchan_t *chan, int length, byte *data)
 
 				chan->reliable_fragid[i] = MAKE_FRAGID(pbuf->bufferid, chan->fragbufcount[i]); // Which buffer are we sending?
 
+#ifdef REHLDS_OPT_PEDANTIC
+				filebuffer_t *fb = NULL;
+				if (pbuf->isfile && !pbuf->isbuffer)
+				{
+					fb = Netchan_FindFileBuffer(pbuf->filename, pbuf->iscompressed);
+					if (fb && pbuf->foffset + pbuf->size > fb->size)
+						fb = NULL;
+				}
+
+				if (fb)
+				{
+					// header (first fragment only) + file data straight from the shared buffer
+					Q_memcpy(chan->reliable_buf + chan->reliable_length, pbuf->frag_message.data, pbuf->frag_message.cursize);
+					chan->reliable_length += pbuf->frag_message.cursize;
+					Q_memcpy(chan->reliable_buf + chan->reliable_length, fb->data + pbuf->foffset, pbuf->size);
+					chan->reliable_length += pbuf->size;
+					chan->frag_length[i] = pbuf->frag_message.cursize + pbuf->size;
+				}
+				else
+				{
+#endif // REHLDS_OPT_PEDANTIC
 				// If it's not in-memory, then we'll need to copy it in frame the file handle.
 				if (pbuf->isfile && !pbuf->isbuffer)	{
 					char compressedfilename[MAX_PATH];
@@ -435,6 +660,9 @@ void Netchan_Transmit(netchan_t *chan, int length, byte *data)
 				Q_memcpy(chan->reliable_buf + chan->reliable_length, pbuf->frag_message.data, pbuf->frag_message.cursize);
 				chan->reliable_length += pbuf->frag_message.cursize;
 				chan->frag_length[i] = pbuf->frag_message.cursize;
+#ifdef REHLDS_OPT_PEDANTIC
+				}
+#endif // REHLDS_OPT_PEDANTIC
 
 
 				// Unlink  pbuf
@@ -901,6 +1129,10 @@ void Netchan_FragSend(netchan_t *chan)
 	if (!chan)
 		return;
 
+#ifdef REHLDS_OPT_PEDANTIC
+	Netchan_PollCompression();
+#endif // REHLDS_OPT_PEDANTIC
+
 	for (i = 0; i < MAX_STREAMS; i++)
 	{
 		// Already something queued up, just leave in waitlist
@@ -917,6 +1149,14 @@ void Netchan_FragSend(netchan_t *chan)
 			continue;
 		}
 
+#ifdef REHLDS_OPT_PEDANTIC
+		// still being compressed
+		if (Netchan_CompressionPending(wait))
+		{
+			continue;
+		}
+#endif // REHLDS_OPT_PEDANTIC
+
 		chan->waitlist[i] = wait->next;
 
 		wait->next = NULL;
@@ -926,7 +1166,11 @@ void Netchan_FragSend(netchan_t *chan)
 		chan->fragbufcount[i] = wait->fragbufcount;
 
 		// Throw away wait list
+#ifdef REHLDS_OPT_PEDANTIC
+		Netchan_FreeFragwait(wait);
+#else // REHLDS_OPT_PEDANTIC
 		Mem_Free(wait);
+#endif // REHLDS_OPT_PEDANTIC
 	}
 }
 
@@ -976,7 +1220,22 @@ fragbuf_t *Netchan_AllocFragbuf(void)
 {
 	fragbuf_t *buf;
 
+#ifdef REHLDS_OPT_PEDANTIC
+	buf = g_FragbufPool;
+	if (buf)
+	{
+		g_FragbufPool = buf->next;
+		g_NumPooledFragbufs--;
+
+		// everything but the payload, which is only read up to frag_message.cursize
+		Q_memset(buf, 0, offsetof(fragbuf_t, frag_message_buf));
+		Q_memset(&buf->isfile, 0, sizeof(fragbuf_t) - offsetof(fragbuf_t, isfile));
+	}
+	else
+		buf = (fragbuf_t *)Mem_ZeroMalloc(sizeof(fragbuf_t));
+#else // REHLDS_OPT_PEDANTIC
 	buf = (fragbuf_t *)Mem_ZeroMalloc(sizeof(fragbuf_t));
+#endif // REHLDS_OPT_PEDANTIC
 	buf->bufferid = 0;
 	buf->frag_message.cursize = 0;
 	buf->frag_message.data = buf->frag_message_buf;
@@ -1010,6 +1269,259 @@ void Netchan_AddFragbufToTail(fragbufwaiting_t *wait, fragbuf_t *buf)
 	}
 }
 
+#ifdef REHLDS_OPT_PEDANTIC
+// Compression of an oversize reliable message, run on the async worker.
+// Its waiting list entry stays queued without fragbufs, and Netchan_FragSend holds it back until filled
+typedef struct compressjob_s
+{
+	netchan_t *chan;
+	fragbufwaiting_t *wait;		// NULL once the channel dropped the entry
+	unsigned char *input;
+	int inputsize;
+	unsigned char *output;
+	unsigned int outputsize;
+	qboolean compressed;
+	std::atomic<int> done;
+	struct compressjob_s *next;
+} compressjob_t;
+
+// Compressed payloads by content: signon and resource data is the same for every connecting client
+typedef struct compresscache_s
+{
+	CRC32_t crc;
+	unsigned char *input;
+	int inputsize;
+	unsigned char *output;
+	unsigned int outputsize;
+	qboolean compressed;
+	unsigned int lastUsed;
+} compresscache_t;
+
+#define COMPRESS_CACHE_SIZE	32
+
+compressjob_t *g_CompressJobs;
+compresscache_t g_CompressCache[COMPRESS_CACHE_SIZE];
+unsigned int g_CompressCacheClock;
+
+// Same as the inline compression in Netchan_CreateFragments_: the result must fit in the input size minus the header
+static qboolean Netchan_CompressMessage(const unsigned char *input, int inputsize, unsigned char *output, unsigned int *outputsize)
+{
+	char hdr[4] = "BZ2";
+	unsigned int compressedSize = inputsize - sizeof(hdr);
+	if (BZ2_bzBuffToBuffCompress((char *)output + sizeof(hdr), &compressedSize, (char *)input, inputsize, 9, 0, 30))
+		return FALSE;
+
+	Q_memcpy(output, hdr, sizeof(hdr));
+	*outputsize = compressedSize + sizeof(hdr);
+	return TRUE;
+}
+
+static void Netchan_CompressWorker(void *arg)
+{
+	compressjob_t *job = (compressjob_t *)arg;
+	job->compressed = Netchan_CompressMessage(job->input, job->inputsize, job->output, &job->outputsize);
+	job->done.store(1, std::memory_order_release);
+}
+
+static compresscache_t *Netchan_FindCompressed(const unsigned char *input, int inputsize, CRC32_t crc)
+{
+	for (int i = 0; i < COMPRESS_CACHE_SIZE; i++)
+	{
+		compresscache_t *c = &g_CompressCache[i];
+		if (c->input && c->crc == crc && c->inputsize == inputsize && !Q_memcmp(c->input, input, inputsize))
+		{
+			c->lastUsed = ++g_CompressCacheClock;
+			return c;
+		}
+	}
+
+	return NULL;
+}
+
+static void Netchan_CacheCompressed(compressjob_t *job)
+{
+	compresscache_t *c = &g_CompressCache[0];
+	for (int i = 1; i < COMPRESS_CACHE_SIZE && c->input; i++)
+	{
+		if (!g_CompressCache[i].input || g_CompressCache[i].lastUsed < c->lastUsed)
+			c = &g_CompressCache[i];
+	}
+
+	if (c->input)
+	{
+		Mem_Free(c->input);
+		if (c->output)
+			Mem_Free(c->output);
+	}
+
+	CRC32_Init(&c->crc);
+	CRC32_ProcessBuffer(&c->crc, job->input, job->inputsize);
+	c->crc = CRC32_Final(c->crc);
+	c->input = (unsigned char *)Mem_Malloc(job->inputsize);
+	Q_memcpy(c->input, job->input, job->inputsize);
+	c->inputsize = job->inputsize;
+	c->output = NULL;
+	c->outputsize = 0;
+	c->compressed = job->compressed;
+	if (job->compressed)
+	{
+		c->output = (unsigned char *)Mem_Malloc(job->outputsize);
+		Q_memcpy(c->output, job->output, job->outputsize);
+		c->outputsize = job->outputsize;
+	}
+	c->lastUsed = ++g_CompressCacheClock;
+}
+
+void Netchan_FlushCompressionCache(void)
+{
+	for (int i = 0; i < COMPRESS_CACHE_SIZE; i++)
+	{
+		compresscache_t *c = &g_CompressCache[i];
+		if (!c->input)
+			continue;
+
+		Mem_Free(c->input);
+		if (c->output)
+			Mem_Free(c->output);
+		Q_memset(c, 0, sizeof(*c));
+	}
+}
+
+// The fragmenting part of Netchan_CreateFragments_
+static void Netchan_FillMessageFragments(netchan_t *chan, fragbufwaiting_t *wait, const unsigned char *data, int size)
+{
+#ifdef REHLDS_FIXES
+	int chunksize = clamp(chan->pfnNetchan_Blocksize(chan->connection_status), 64, 1200);
+#else
+	int chunksize = chan->pfnNetchan_Blocksize(chan->connection_status);
+#endif // REHLDS_FIXES
+
+	int bufferid = 1;
+	int remaining = size;
+	int pos = 0;
+	while (remaining > 0)
+	{
+		int send = min(remaining, chunksize);
+		remaining -= send;
+
+		fragbuf_t *buf = Netchan_AllocFragbuf();
+		buf->bufferid = bufferid++;
+
+		SZ_Clear(&buf->frag_message);
+		SZ_Write(&buf->frag_message, &data[pos], send);
+		pos += send;
+
+		Netchan_AddFragbufToTail(wait, buf);
+	}
+}
+
+// Queues the message on the normal stream and compresses it in the background, or from the cache
+void Netchan_QueueCompressed(netchan_t *chan, const unsigned char *data, int size)
+{
+	fragbufwaiting_t *wait = Netchan_AllocFragwait();
+	if (!chan->waitlist[FRAG_NORMAL_STREAM])
+	{
+		chan->waitlist[FRAG_NORMAL_STREAM] = wait;
+	}
+	else
+	{
+		fragbufwaiting_t *p = chan->waitlist[FRAG_NORMAL_STREAM];
+		while (p->next)
+			p = p->next;
+
+		p->next = wait;
+	}
+
+	CRC32_t crc;
+	CRC32_Init(&crc);
+	CRC32_ProcessBuffer(&crc, (void *)data, size);
+	crc = CRC32_Final(crc);
+
+	compresscache_t *c = Netchan_FindCompressed(data, size, crc);
+	if (c)
+	{
+		if (c->compressed)
+		{
+			Con_DPrintf("Compressing split packet (%d -> %d bytes)\n", size, c->outputsize - 4);
+			Netchan_FillMessageFragments(chan, wait, c->output, c->outputsize);
+		}
+		else
+			Netchan_FillMessageFragments(chan, wait, data, size);
+
+		return;
+	}
+
+	compressjob_t *job = new compressjob_t;
+	job->chan = chan;
+	job->wait = wait;
+	job->input = (unsigned char *)Mem_Malloc(size);
+	Q_memcpy(job->input, data, size);
+	job->inputsize = size;
+	job->output = (unsigned char *)Mem_Malloc(size);
+	job->outputsize = 0;
+	job->compressed = FALSE;
+	job->done.store(0, std::memory_order_relaxed);
+	job->next = g_CompressJobs;
+	g_CompressJobs = job;
+
+	Sys_QueueAsync(Netchan_CompressWorker, job);
+}
+
+// Fills the waiting list entries of finished jobs
+void Netchan_PollCompression(void)
+{
+	compressjob_t **link = &g_CompressJobs;
+	while (*link)
+	{
+		compressjob_t *job = *link;
+		if (!job->done.load(std::memory_order_acquire))
+		{
+			link = &job->next;
+			continue;
+		}
+
+		Netchan_CacheCompressed(job);
+
+		if (job->wait)
+		{
+			if (job->compressed)
+			{
+				Con_DPrintf("Compressing split packet (%d -> %d bytes)\n", job->inputsize, job->outputsize - 4);
+				Netchan_FillMessageFragments(job->chan, job->wait, job->output, job->outputsize);
+			}
+			else
+				Netchan_FillMessageFragments(job->chan, job->wait, job->input, job->inputsize);
+		}
+
+		*link = job->next;
+		Mem_Free(job->input);
+		Mem_Free(job->output);
+		delete job;
+	}
+}
+
+qboolean Netchan_CompressionPending(fragbufwaiting_t *wait)
+{
+	for (compressjob_t *job = g_CompressJobs; job; job = job->next)
+	{
+		if (job->wait == wait)
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+// The entry is being thrown away, its job's result will only go to the cache
+void Netchan_CancelCompression(fragbufwaiting_t *wait)
+{
+	for (compressjob_t *job = g_CompressJobs; job; job = job->next)
+	{
+		if (job->wait == wait)
+			job->wait = NULL;
+	}
+}
+#endif // REHLDS_OPT_PEDANTIC
+
 /* <6556c> ../engine/net_chan.c:1261 */
 void Netchan_CreateFragments_(qboolean server, netchan_t *chan, sizebuf_t *msg)
 {
@@ -1026,6 +1538,28 @@ void Netchan_CreateFragments_(qboolean server, netchan_t *chan, sizebuf_t *msg)
 		return;
 	}
 
+#ifdef REHLDS_OPT_PEDANTIC
+	// server side only, the reliable overflow path in Netchan_Transmit doesn't pass a meaningful 'server'
+	if (chan != &g_pcls.netchan && *(uint32 *)msg->data != MAKEID('B', 'Z', '2', '\0'))
+	{
+#ifdef REHLDS_FIXES
+		chunksize = clamp(chan->pfnNetchan_Blocksize(chan->connection_status), 64, 1200);
+#else
+		chunksize = chan->pfnNetchan_Blocksize(chan->connection_status);
+#endif // REHLDS_FIXES
+
+		// the compressed size isn't known yet, count the uncompressed one against the quota
+		if (Netchan_FragQuotaExceeded(chan, (msg->cursize + chunksize - 1) / chunksize))
+		{
+			chan->message.flags |= SIZEBUF_OVERFLOWED;
+			return;
+		}
+
+		Netchan_QueueCompressed(chan, msg->data, msg->cursize);
+		return;
+	}
+#endif // REHLDS_OPT_PEDANTIC
+
 	// Compress if not done already
 	if (*(uint32 *)msg->data != MAKEID('B', 'Z', '2', '\0'))
 	{
@@ -1048,7 +1582,18 @@ void Netchan_CreateFragments_(qboolean server, netchan_t *chan, sizebuf_t *msg)
 #endif // REHLDS_FIXES
 	
 
+#ifdef REHLDS_OPT_PEDANTIC
+	if (Netchan_FragQuotaExceeded(chan, (msg->cursize + chunksize - 1) / chunksize))
+	{
+		// the reliable stream can't skip data, have the client dropped as overflowed
+		chan->message.flags |= SIZEBUF_OVERFLOWED;
+		return;
+	}
+
+	wait = Netchan_AllocFragwait();
+#else // REHLDS_OPT_PEDANTIC
 	wait = (fragbufwaiting_t *)Mem_ZeroMalloc(sizeof(fragbufwaiting_t));
+#endif // REHLDS_OPT_PEDANTIC
 
 	remaining = msg->cursize;
 	pos = 0;
@@ -1141,7 +1686,19 @@ void Netchan_CreateFileFragmentsFromBuffer(qboolean server, netchan_t *chan, con
 
 	chunksize = chan->pfnNetchan_Blocksize(chan->connection_status);
 	send = chunksize;
+#ifdef REHLDS_OPT_PEDANTIC
+	if (Netchan_FragQuotaExceeded(chan, (size + chunksize - 1) / chunksize))
+	{
+		Con_Printf("Warning:  Too many fragments queued to send %s to %s\n", filename, NET_AdrToString(chan->remote_address));
+		if (bCompressed)
+			Mem_Free(pbuf);
+		return;
+	}
+
+	wait = Netchan_AllocFragwait();
+#else // REHLDS_OPT_PEDANTIC
 	wait = (fragbufwaiting_t *)Mem_ZeroMalloc(0xCu);
+#endif // REHLDS_OPT_PEDANTIC
 	remaining = size;
 	pos = 0;
 
@@ -1152,7 +1709,11 @@ void Netchan_CreateFileFragmentsFromBuffer(qboolean server, netchan_t *chan, con
 		if (!buf)
 		{
 			Con_Printf("Couldn't allocate fragbuf_t\n");
+#ifdef REHLDS_OPT_PEDANTIC
+			Netchan_FreeFragwait(wait);
+#else // REHLDS_OPT_PEDANTIC
 			Mem_Free(wait);
+#endif // REHLDS_OPT_PEDANTIC
 			if (server)
 				SV_DropClient(host_client, 0, "Malloc problem");
 			else
@@ -1295,7 +1856,17 @@ int Netchan_CreateFileFragments(qboolean server, netchan_t *chan, const char *fi
 	}
 	FS_Close(hfile);
 
+#ifdef REHLDS_OPT_PEDANTIC
+	if (Netchan_FragQuotaExceeded(chan, (filesize + chunksize - 1) / chunksize))
+	{
+		Con_Printf("Warning:  Too many fragments queued to send %s to %s\n", filename, NET_AdrToString(chan->remote_address));
+		return 0;
+	}
+
+	wait = Netchan_AllocFragwait();
+#else // REHLDS_OPT_PEDANTIC
 	wait = (fragbufwaiting_t *)Mem_ZeroMalloc(0xCu);
+#endif // REHLDS_OPT_PEDANTIC
 	remaining = filesize;
 	pos = 0;
 
@@ -1306,7 +1877,11 @@ int Netchan_CreateFileFragments(qboolean server, netchan_t *chan, const char *fi
 		if (!buf)
 		{
 			Con_Printf("Couldn't allocate fragbuf_t\n");
+#ifdef REHLDS_OPT_PEDANTIC
+			Netchan_FreeFragwait(wait);
+#else // REHLDS_OPT_PEDANTIC
 			Mem_Free(wait);
+#endif // REHLDS_OPT_PEDANTIC
 			if (server)
 			{
 				SV_DropClient(host_client, 0, "Malloc problem");
@@ -1356,6 +1931,11 @@ int Netchan_CreateFileFragments(qboolean server, netchan_t *chan, const char *fi
 		p->next = wait;
 	}
 
+#ifdef REHLDS_OPT_PEDANTIC
+	// one reference per fragment, dropped as each one is sent or thrown away
+	Netchan_AcquireFileBuffer(filename, bCompressed, wait->fragbufcount);
+#endif // REHLDS_OPT_PEDANTIC
+
 	return 1;
 }
 
@@ -1371,7 +1951,11 @@ void Netchan_FlushIncoming(netchan_t *chan, int stream)
 	while (p)
 	{
 		n = p->next;
+#ifdef REHLDS_OPT_PEDANTIC
+		Netchan_FreeFragbuf(p);
+#else // REHLDS_OPT_PEDANTIC
 		Mem_Free(p);
+#endif // REHLDS_OPT_PEDANTIC
 		p = n;
 	};
 
@@ -1416,7 +2000,11 @@ qboolean Netchan_CopyNormalFragments(netchan_t *chan)
 		SZ_Write(&net_message, p->frag_message.data, p->frag_message.cursize);
 #endif // REHLDS_FIXES
 
+#ifdef REHLDS_OPT_PEDANTIC
+		Netchan_FreeFragbuf(p);
+#else // REHLDS_OPT_PEDANTIC
 		Mem_Free(p);
+#endif // REHLDS_OPT_PEDANTIC
 		p = n;
 	}
 
@@ -1572,7 +2160,11 @@ qboolean Netchan_CopyFileFragments(netchan_t *chan)
 			Q_memcpy(&buffer[pos], p->frag_message.data, cursize);
 		}
 		pos += p->frag_message.cursize;
+#ifdef REHLDS_OPT_PEDANTIC
+		Netchan_FreeFragbuf(p);
+#else // REHLDS_OPT_PEDANTIC
 		Mem_Free(p);
+#endif // REHLDS_OPT_PEDANTIC
 		p = n;
 
 	}
@@ -1778,6 +2370,9 @@ void Netchan_Init(void)
 	Cvar_RegisterVariable(&net_drawslider);
 	Cvar_RegisterVariable(&sv_filetransfercompression);
 	Cvar_RegisterVariable(&sv_filetransfermaxsize);
+#ifdef REHLDS_OPT_PEDANTIC
+	Cvar_RegisterVariable(&sv_fragquota);
+#endif // REHLDS_OPT_PEDANTIC
 }
 
 /* <65409> ../engine/net_chan.c:2186 */
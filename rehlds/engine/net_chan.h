@@ -65,6 +65,37 @@ extern cvar_t sv_filetransfermaxsize;
 
 
 
+#ifdef REHLDS_OPT_PEDANTIC
+// Read-only contents of a file being downloaded, shared by the file fragments of all clients.
+// Fragments reference it by filename and compression flag, each one holds a reference
+typedef struct filebuffer_s
+{
+	char filename[MAX_PATH];
+	qboolean compressed;
+	int32 filetime;
+	unsigned char *data;
+	int size;
+	int refcount;
+	struct filebuffer_s *next;
+} filebuffer_t;
+
+filebuffer_t *Netchan_FindFileBuffer(const char *filename, qboolean compressed);
+filebuffer_t *Netchan_AcquireFileBuffer(const char *filename, qboolean compressed, int refs);
+void Netchan_ReleaseFileBuffer(const char *filename, qboolean compressed);
+void Netchan_FreeFragbuf(fragbuf_t *buf);
+fragbufwaiting_t *Netchan_AllocFragwait(void);
+void Netchan_FreeFragwait(fragbufwaiting_t *wait);
+int Netchan_QueuedFragments(netchan_t *chan);
+qboolean Netchan_FragQuotaExceeded(netchan_t *chan, int count);
+void Netchan_FlushCompressionCache(void);
+void Netchan_QueueCompressed(netchan_t *chan, const unsigned char *data, int size);
+void Netchan_PollCompression(void);
+qboolean Netchan_CompressionPending(fragbufwaiting_t *wait);
+void Netchan_CancelCompression(fragbufwaiting_t *wait);
+
+extern cvar_t sv_fragquota;
+#endif // REHLDS_OPT_PEDANTIC
+
 void Netchan_UnlinkFragment(fragbuf_t *buf, fragbuf_t **list);
 void Netchan_OutOfBand(netsrc_t sock, netadr_t adr, int length, byte *data);
 void Netchan_OutOfBandPrint(netsrc_t sock, netadr_t adr, char *format, ...);
@@ -28,6 +28,16 @@
 
 #include "precompiled.h"
 
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+#include "stdsani_in.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include "stdsani_out.h"
+#include <poll.h>
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+
 #ifdef _WIN32
 CRITICAL_SECTION net_cs;
 #endif // _WIN32
@@ -43,7 +53,7 @@ netadr_t net_local_ipx_adr;
 #endif
 netadr_t net_local_adr;
 netadr_t net_from;
-sizebuf_t net_message;
+MSG_THREADLOCAL sizebuf_t net_message;
 qboolean noip;
 qboolean noipx;
 
@@ -60,12 +70,65 @@ int ip_sockets[3];
 int ipx_sockets[3];
 #endif // _WIN32
 
+// Bumped under the lock whenever ip_sockets[NS_SERVER] is opened or closed: the descriptor number alone
+// doesn't tell a reopened socket from the old one
+unsigned int net_socket_generation;
+
 LONGPACKET gNetSplit;
 net_messages_t *messages[3];
 net_messages_t *normalqueue;
 //void *hNetThread;
 //int32 dwNetThreadId;
 
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+/*
+-net_thread: a dedicated thread blocks on the server socket and drains it into a single
+producer / single consumer ring of preallocated datagram buffers stamped with their arrival
+time. Connectionless floods are rate limited there, before they take a slot.
+NET_QueuePacket then pops server packets from the ring instead of calling recvfrom.
+*/
+#define NET_RING_SIZE			1024	// must be a power of two
+#define NET_THREAD_POLL_MSEC	100
+#define NET_THREAD_MAX_DRAIN	64		// datagrams read per lock
+
+typedef struct netringslot_s
+{
+	netadr_t from;
+	double time;
+	int size;
+	unsigned char data[MAX_UDP_PACKET];
+} netringslot_t;
+
+typedef struct netratelimit_s
+{
+	uint32 ip;
+	double start;
+	int count;
+} netratelimit_t;
+
+std::recursive_mutex net_thread_mutex;
+std::thread *net_thread;
+std::atomic<bool> net_thread_stop;
+
+netringslot_t *net_ring;
+std::atomic<unsigned int> net_ring_head;	// advanced by the network thread
+std::atomic<unsigned int> net_ring_tail;	// advanced by the game thread
+std::atomic<int> net_ring_dropped;
+std::atomic<int> net_ring_limited;
+
+// touched by the network thread only
+netratelimit_t net_ratelimit[1024];
+double net_ratelimit_start;
+int net_ratelimit_global;
+
+// How long the last packet returned by NET_GetPacket waited in the ring, zero without the thread
+double net_from_delay;
+
+// When the network thread read the packet in in_message, zero if it didn't come through the ring.
+// It travels with the packet through the fakelag queue, so the delay is the one of the packet NET_LagPacket returns
+double in_arrival;
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+
 /*
 * Globals initialization
 */
@@ -133,6 +196,11 @@ void NET_ThreadLock(void)
 	{
 		EnterCriticalSection(&net_cs);
 	}
+#elif defined(REHLDS_OPT_PEDANTIC)
+	if (use_thread && net_thread_initialized)
+	{
+		net_thread_mutex.lock();
+	}
 #endif // _WIN32
 }
 
@@ -144,6 +212,11 @@ void NET_ThreadUnlock(void)
 	{
 		LeaveCriticalSection(&net_cs);
 	}
+#elif defined(REHLDS_OPT_PEDANTIC)
+	if (use_thread && net_thread_initialized)
+	{
+		net_thread_mutex.unlock();
+	}
 #endif // _WIN32
 }
 
@@ -810,8 +883,11 @@ qboolean NET_LagPacket(qboolean newdata, netsrc_t sock, netadr_t *from, sizebuf_
 				Cvar_SetValue("fakeloss", 0.0);
 			}
 		}
-		pNewPacketLag = (packetlag_t *)Mem_ZeroMalloc(0x28u);
+		pNewPacketLag = (packetlag_t *)Mem_ZeroMalloc(sizeof(packetlag_t));
 		NET_AddToLagged(sock, &g_pLagData[sock], pNewPacketLag, from, *data, curtime);
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+		pNewPacketLag->arrivalTime = in_arrival;
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
 	}
 	pPacket = g_pLagData[sock].pNext;
 
@@ -828,6 +904,9 @@ qboolean NET_LagPacket(qboolean newdata, netsrc_t sock, netadr_t *from, sizebuf_
 	NET_RemoveFromPacketList(pPacket);
 	NET_TransferRawData(&in_message, pPacket->pPacketData, pPacket->nSize);
 	Q_memcpy(&in_from, &pPacket->net_from_, sizeof(in_from));
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+	in_arrival = pPacket->arrivalTime;
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
 	if (pPacket->pPacketData)
 		free(pPacket->pPacketData);
 
@@ -963,6 +1042,199 @@ qboolean NET_GetLong(unsigned char *pData, int size, int *outSize)
 	}
 }
 
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+// Server queries only, the handshake, rcon and everything else connectionless goes through untouched.
+// Same rule as CIPRateLimit: over max_queries_window seconds a source may average max_queries_sec queries
+// per second and all sources together max_queries_sec_global
+qboolean NET_ThreadCheckRate(const netadr_t &from, const unsigned char *data, int size, double now)
+{
+	if (size < 5 || *(uint32 *)data != 0xFFFFFFFF)
+		return TRUE;
+
+	if (data[4] != A2S_INFO && data[4] != A2S_PLAYER && data[4] != A2S_RULES && data[4] != A2A_GETCHALLENGE)
+		return TRUE;
+
+	float window = max(max_queries_window.value, 1.0f);
+
+	// a source over its own limit doesn't use up the global one
+	if (max_queries_sec.value > 0.0f)
+	{
+		uint32 ip = *(uint32 *)from.ip;
+		netratelimit_t *entry = &net_ratelimit[(ip * 2654435761u) >> 22];
+		if (entry->ip != ip || now - entry->start > window)
+		{
+			entry->ip = ip;
+			entry->start = now;
+			entry->count = 0;
+		}
+
+		if (++entry->count > max_queries_sec.value * window)
+			return FALSE;
+	}
+
+	if (max_queries_sec_global.value > 0.0f)
+	{
+		if (now - net_ratelimit_start > window)
+		{
+			net_ratelimit_start = now;
+			net_ratelimit_global = 0;
+		}
+
+		if (++net_ratelimit_global > max_queries_sec_global.value * window)
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+// Reads what is pending on the server socket into the ring, returns FALSE if the socket is gone.
+// The reads run unlocked into slots past the published head, the lock is only taken to publish them.
+// They go through a dup() of the socket taken under the lock: NET_Config may close the socket meanwhile
+// and the next socket or file opened can get its number, the copy still refers to the one that was polled
+qboolean NET_ThreadDrainSocket(int net_socket, unsigned int generation)
+{
+	static netringslot_t overflow;
+	unsigned int head = net_ring_head.load(std::memory_order_relaxed);
+
+	NET_ThreadLock();
+	int fd = -1;
+	if (net_socket_generation == generation && ip_sockets[NS_SERVER] == net_socket)
+		fd = dup(net_socket);
+	NET_ThreadUnlock();
+
+	if (fd == -1)
+		return FALSE;
+
+	for (int i = 0; i < NET_THREAD_MAX_DRAIN; i++)
+	{
+		qboolean full = (head - net_ring_tail.load(std::memory_order_acquire)) >= NET_RING_SIZE;
+
+		// when the ring is full the datagram is still read, into a slot the game thread never sees
+		netringslot_t *slot = full ? &overflow : &net_ring[head & (NET_RING_SIZE - 1)];
+		struct sockaddr from;
+		socklen_t fromlen = sizeof(from);
+
+		int ret = CRehldsPlatformHolder::get()->recvfrom(fd, (char *)slot->data, sizeof(slot->data), 0, &from, &fromlen);
+		if (ret == -1)
+			break;
+
+		// oversized datagrams are dropped the same way NET_QueuePacket does
+		if (ret == MAX_UDP_PACKET)
+			continue;
+
+		double now = Sys_FloatTime();
+		SockadrToNetadr(&from, &slot->from);
+		if (!NET_ThreadCheckRate(slot->from, slot->data, ret, now))
+		{
+			net_ring_limited++;
+			continue;
+		}
+
+		if (full)
+		{
+			net_ring_dropped++;
+			continue;
+		}
+
+		slot->size = ret;
+		slot->time = now;
+		head++;
+	}
+
+	close(fd);
+
+	NET_ThreadLock();
+
+	// NET_Config may have closed or replaced the socket while we were reading, what came from it is dropped
+	qboolean current = (net_socket_generation == generation) ? TRUE : FALSE;
+	if (current)
+		net_ring_head.store(head, std::memory_order_release);
+
+	NET_ThreadUnlock();
+	return current;
+}
+
+void NET_ThreadMain(void)
+{
+	while (!net_thread_stop)
+	{
+		NET_ThreadLock();
+		int net_socket = ip_sockets[NS_SERVER];
+		unsigned int generation = net_socket_generation;
+		NET_ThreadUnlock();
+
+		if (!net_socket)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(NET_THREAD_POLL_MSEC));
+			continue;
+		}
+
+		struct pollfd pfd;
+		pfd.fd = net_socket;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+
+		if (poll(&pfd, 1, NET_THREAD_POLL_MSEC) <= 0)
+			continue;
+
+		if (pfd.revents & POLLIN)
+		{
+			NET_ThreadDrainSocket(net_socket, generation);
+		}
+		else if (pfd.revents & POLLNVAL)
+		{
+			// closed under us, wait for NET_Config to open a new one
+			std::this_thread::sleep_for(std::chrono::milliseconds(NET_THREAD_POLL_MSEC));
+		}
+	}
+}
+
+// Game thread side of the ring, returns -1 if it is empty
+int NET_PopThreadPacket(unsigned char *buf, netadr_t *from)
+{
+	unsigned int tail = net_ring_tail.load(std::memory_order_relaxed);
+	if (tail == net_ring_head.load(std::memory_order_acquire))
+		return -1;
+
+	netringslot_t *slot = &net_ring[tail & (NET_RING_SIZE - 1)];
+	int size = slot->size;
+
+	Q_memcpy(buf, slot->data, size);
+	*from = slot->from;
+	in_arrival = slot->time;
+
+	net_ring_tail.store(tail + 1, std::memory_order_release);
+	return size;
+}
+
+void NET_ThreadStats_f(void)
+{
+	if (!net_thread)
+	{
+		Con_Printf("Network thread is not running\n");
+		return;
+	}
+
+	unsigned int queued = net_ring_head - net_ring_tail;
+	Con_Printf("net thread: %u queued, %i dropped (queue full), %i rate limited\n", queued, (int)net_ring_dropped, (int)net_ring_limited);
+}
+
+// CPU time used by the network thread in nanoseconds, 0 when it isn't running
+int64 NET_ThreadCpuTime(void)
+{
+	clockid_t clock;
+	struct timespec ts;
+
+	if (!net_thread)
+		return 0;
+
+	if (pthread_getcpuclockid(net_thread->native_handle(), &clock) != 0 || clock_gettime(clock, &ts) != 0)
+		return 0;
+
+	return (int64)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+
 /* <d3bd9> ../engine/net_ws.c:1021 */
 qboolean NET_QueuePacket(netsrc_t sock)
 {
@@ -978,6 +1250,13 @@ qboolean NET_QueuePacket(netsrc_t sock)
 	ret = -1;
 #endif
 
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+	if (sock == NS_SERVER && net_thread)
+	{
+		ret = NET_PopThreadPacket(buf, &in_from);
+	}
+	else
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
 #ifdef _WIN32
 	for (protocol = 0; protocol < 2; protocol++)
 #else
@@ -1002,7 +1281,7 @@ qboolean NET_QueuePacket(netsrc_t sock)
 			err = CRehldsPlatformHolder::get()->WSAGetLastError();
 			if (err != WSAENETRESET && err != WSAEWOULDBLOCK && err != WSAECONNRESET && err != WSAECONNREFUSED)
 #else // _WIN32
-			err = errno;
+			err = CRehldsPlatformHolder::get()->WSAGetLastError();
 			if (err != EAGAIN && err != ECONNRESET && err != ECONNREFUSED)
 #endif // _WIN32
 			{
@@ -1170,7 +1449,23 @@ void NET_StartThread(void)
 		if (!net_thread_initialized)
 		{
 			net_thread_initialized = TRUE;
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+			// Packet arrival order relative to the frame must stay deterministic for record/replay
+			if (g_RehldsRuntimeConfig.testPlayerMode != TPM_DISABLE)
+			{
+				Con_Printf("-net_thread is ignored while the testsuite is active\n");
+				use_thread = FALSE;
+				return;
+			}
+
+			net_ring = (netringslot_t *)Mem_ZeroMalloc(sizeof(netringslot_t) * NET_RING_SIZE);
+			net_ring_head = net_ring_tail = 0;
+			net_thread_stop = false;
+			net_thread = new std::thread(NET_ThreadMain);
+			Cmd_AddCommand("net_threadstats", NET_ThreadStats_f);
+#else // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
 			Sys_Error("-net_thread is not reversed yet");
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
 #ifdef _WIN32
 			/*
 			InitializeCriticalSection(&net_cs);
@@ -1201,8 +1496,18 @@ void NET_StopThread(void)
 			DeleteCriticalSection(&net_cs);
 			*/
 #endif // _WIN32
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+			net_thread_stop = true;
+			net_thread->join();
+			delete net_thread;
+			net_thread = NULL;
+			Mem_Free(net_ring);
+			net_ring = NULL;
+			net_thread_initialized = FALSE;
+#else // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
 			net_thread_initialized = FALSE;
 			Sys_Error("-net_thread is not reversed yet");
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
 		}
 	}
 }
@@ -1258,12 +1563,22 @@ qboolean NET_GetPacket(netsrc_t sock)
 
 	NET_AdjustLag();
 	NET_ThreadLock();
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+	net_from_delay = 0.0;
+	in_arrival = 0.0;
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
 	if (NET_GetLoopPacket(sock, &in_from, &in_message))
 	{
 		bret = NET_LagPacket(1, sock, &in_from, &in_message);
 	}
 	else
 	{
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+		// the network thread only fills the ring that NET_QueuePacket drains
+		bret = NET_QueuePacket(sock);
+		if (!bret)
+			bret = NET_LagPacket(0, sock, 0, 0);
+#else // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
 		if (!use_thread)
 		{
 			bret = NET_QueuePacket(sock);
@@ -1274,6 +1589,7 @@ qboolean NET_GetPacket(netsrc_t sock)
 		{
 			bret = NET_LagPacket(0, sock, 0, 0);
 		}
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
 	}
 	
 	if (bret)
@@ -1281,6 +1597,10 @@ qboolean NET_GetPacket(netsrc_t sock)
 		Q_memcpy(net_message.data, in_message.data, in_message.cursize);
 		net_message.cursize = in_message.cursize;
 		Q_memcpy(&net_from, &in_from, 0x14u);
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+		if (in_arrival != 0.0)
+			net_from_delay = Sys_FloatTime() - in_arrival;
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
 		NET_ThreadUnlock();
 		return bret;
 	}
@@ -1468,6 +1788,13 @@ void NET_SendPacket(netsrc_t sock, int length, void *data, const netadr_t& to)
 	NetadrToSockadr(&to, &addr);
 
 	ret = NET_SendLong(sock, net_socket, (const char *)data, length, 0, &addr, sizeof(addr));
+#ifdef REHLDS_OPT_PEDANTIC
+	if (ret != -1 && sock == NS_SERVER)
+	{
+		g_MetricsNet.packetsOut++;
+		g_MetricsNet.bytesOut += length;
+	}
+#endif // REHLDS_OPT_PEDANTIC
 	if (ret == -1)
 	{
 		int err;
@@ -1519,63 +1846,31 @@ int NET_IPSocket(char *net_interface, int port, qboolean multicast)
 	int i = 1;
 	int err;
 
-#ifdef _WIN32
 	if ((newsocket = CRehldsPlatformHolder::get()->socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP)) == INVALID_SOCKET)
-#else
-	if ((newsocket = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP)) == INVALID_SOCKET)
-#endif // _WIN32
 	{
 
-#ifdef _WIN32
 		err = CRehldsPlatformHolder::get()->WSAGetLastError();
-#else
-		err = errno;
-#endif // _WIN32
 		if (err != WSAEAFNOSUPPORT)
 			Con_Printf("WARNING: UDP_OpenSocket: port: %d socket: %s", port, NET_ErrorString(err));
 		return 0;
 	}
-#ifdef _WIN32
 	if (CRehldsPlatformHolder::get()->ioctlsocket(newsocket, FIONBIO, (u_long *)&_true) == SOCKET_ERROR)
-#else
-	if (SOCKET_FIONBIO(newsocket, _true) == SOCKET_ERROR)
-#endif // _WIN32
 	{
-#ifdef _WIN32
 		err = CRehldsPlatformHolder::get()->WSAGetLastError();
-#else
-		err = errno;
-#endif // _WIN32
 		Con_Printf("WARNING: UDP_OpenSocket: port: %d  ioctl FIONBIO: %s\n", port, NET_ErrorString(err));
 		return 0;
 	}
-#ifdef _WIN32
 	if (CRehldsPlatformHolder::get()->setsockopt(newsocket, SOL_SOCKET, SO_BROADCAST, (char *)&i, sizeof(i)) == SOCKET_ERROR)
-#else
-	if (setsockopt(newsocket, SOL_SOCKET, SO_BROADCAST, (char *)&i, sizeof(i)) == SOCKET_ERROR)
-#endif
 	{
-#ifdef _WIN32
 		err = CRehldsPlatformHolder::get()->WSAGetLastError();
-#else
-		err = errno;
-#endif // _WIN32
 		Con_Printf ("WARNING: UDP_OpenSocket: port: %d  setsockopt SO_BROADCAST: %s\n", port, NET_ErrorString(err));
 		return 0;
 	}
 	if (COM_CheckParm("-reuse") || multicast)
 	{
-#ifdef _WIN32
 		if (CRehldsPlatformHolder::get()->setsockopt(newsocket, SOL_SOCKET, SO_REUSEADDR, (char *)&_true, sizeof(qboolean)) == SOCKET_ERROR)
-#else
-		if (setsockopt(newsocket, SOL_SOCKET, SO_REUSEADDR, (char *)&_true, sizeof(qboolean)) == SOCKET_ERROR)
-#endif // _WIN32
 		{
-#ifdef _WIN32
 			err = CRehldsPlatformHolder::get()->WSAGetLastError();
-#else
-			err = errno;
-#endif // _WIN32
 			Con_Printf ("WARNING: UDP_OpenSocket: port: %d  setsockopt SO_REUSEADDR: %s\n", port, NET_ErrorString(err));
 			return 0;
 		}
@@ -1585,9 +1880,9 @@ int NET_IPSocket(char *net_interface, int port, qboolean multicast)
 	{
 		i = 16;
 		Con_Printf("Enabling LOWDELAY TOS option\n");
-		if (setsockopt(newsocket, IPPROTO_IP, IP_TOS, (char *)&i, sizeof(i)) == SOCKET_ERROR)
+		if (CRehldsPlatformHolder::get()->setsockopt(newsocket, IPPROTO_IP, IP_TOS, (char *)&i, sizeof(i)) == SOCKET_ERROR)
 		{
-			err = errno;
+			err = CRehldsPlatformHolder::get()->WSAGetLastError();
 			if (err != WSAENOPROTOOPT)
 				Con_Printf("WARNING: UDP_OpenSocket: port: %d  setsockopt IP_TOS: %s\n", port, NET_ErrorString(err));
 			return 0;
@@ -1604,37 +1899,17 @@ int NET_IPSocket(char *net_interface, int port, qboolean multicast)
 	else address.sin_port = htons((u_short)port);
 
 	address.sin_family = AF_INET;
-#ifdef _WIN32
 	if (CRehldsPlatformHolder::get()->bind(newsocket, (struct sockaddr *)&address, sizeof(address)) == SOCKET_ERROR)
-#else
-	if (bind(newsocket, (struct sockaddr *)&address, sizeof(address)) == SOCKET_ERROR)
-#endif // _WIN32
 	{
-#ifdef _WIN32
 		err = CRehldsPlatformHolder::get()->WSAGetLastError();
-#else
-		err = errno;
-#endif // _WIN32
 		Con_Printf("WARNING: UDP_OpenSocket: port: %d  bind: %s\n", port, NET_ErrorString(err));
-#ifdef _WIN32
 		CRehldsPlatformHolder::get()->closesocket(newsocket);
-#else
-		SOCKET_CLOSE(newsocket);
-#endif // _WIN32
 		return 0;
 	}
 	i = COM_CheckParm("-loopback") != 0;
-#ifdef _WIN32
 	if (CRehldsPlatformHolder::get()->setsockopt(newsocket, IPPROTO_IP, IP_MULTICAST_LOOP, (char *)&i, sizeof(i)) == SOCKET_ERROR)
-#else
-	if (setsockopt(newsocket, IPPROTO_IP, IP_MULTICAST_LOOP, (char *)&i, sizeof(i)) == SOCKET_ERROR)
-#endif // _WIN32
 	{
-#ifdef _WIN32
 		err = CRehldsPlatformHolder::get()->WSAGetLastError();
-#else
-		err = errno;
-#endif // _WIN32
 		Con_DPrintf("WARNING: UDP_OpenSocket: port %d setsockopt IP_MULTICAST_LOOP: %s\n", port, NET_ErrorString(err));
 	}
 	return newsocket;
@@ -1670,6 +1945,7 @@ void NET_OpenIP(void)
 			}
 		}
 		ip_sockets[NS_SERVER] = NET_IPSocket(ipname.string, port, FALSE);
+		net_socket_generation++;
 
 		if (!ip_sockets[NS_SERVER] && dedicated)
 		{
@@ -1837,11 +2113,7 @@ void NET_GetLocalAddress(void)
 			Q_strncpy(buff, ipname.string,  ARRAYSIZE(buff) - 1);
 		else
 		{
-#ifdef _WIN32
 			CRehldsPlatformHolder::get()->gethostname(buff,  ARRAYSIZE(buff));
-#else
-			gethostname(buff, ARRAYSIZE(buff));
-#endif // _WIN32
 		}
 
 		buff[ARRAYSIZE(buff) - 1] = 0;
@@ -1854,18 +2126,10 @@ void NET_GetLocalAddress(void)
 		NET_StringToAdr(buff, &net_local_adr);
 #endif
 		namelen = sizeof(address);
-#ifdef _WIN32
 		if (CRehldsPlatformHolder::get()->getsockname((SOCKET)ip_sockets[NS_SERVER], (struct sockaddr *)&address, (socklen_t *)&namelen) == SOCKET_ERROR)
-#else
-		if (getsockname((SOCKET)ip_sockets[NS_SERVER], (struct sockaddr *)&address, (socklen_t *)&namelen) == SOCKET_ERROR)
-#endif // _WIN32
 		{
 			noip = TRUE;
-#ifdef _WIN32
 			net_error = CRehldsPlatformHolder::get()->WSAGetLastError();
-#else
-			net_error = errno;
-#endif // _WIN32
 			Con_Printf("Could not get TCP/IP address, TCP/IP disabled\nReason:  %s\n", NET_ErrorString(net_error));
 		}
 		else
@@ -1948,12 +2212,10 @@ void NET_Config(qboolean multiplayer)
 		{
 			if (ip_sockets[i])
 			{
-#ifdef _WIN32
 				CRehldsPlatformHolder::get()->closesocket(ip_sockets[i]);
-#else
-				SOCKET_CLOSE(ip_sockets[i]);
-#endif //_WIN32
 				ip_sockets[i] = 0;
+				if (i == NS_SERVER)
+					net_socket_generation++;
 			}
 #ifdef _WIN32
 			if (ipx_sockets[i])
@@ -2033,6 +2295,10 @@ void NET_Init(void)
 
 	if (COM_CheckParm("-netthread"))
 		use_thread = 1;
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+	if (COM_CheckParm("-net_thread"))
+		use_thread = 1;
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
 
 	if (COM_CheckParm("-netsleep"))
 		net_sleepforever = 0;
@@ -2103,6 +2369,9 @@ void NET_Shutdown(void)
 	NET_ThreadUnlock();
 
 	NET_Config(FALSE);
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+	NET_StopThread();
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
 	NET_FlushQueues();
 }
 
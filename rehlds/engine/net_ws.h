@@ -86,6 +86,9 @@ typedef struct packetlag_s
 	float receivedTime;
 	struct packetlag_s *pNext;
 	struct packetlag_s *pPrev;
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+	double arrivalTime;	// in_arrival of the packet
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
 } packetlag_t;
 
 /* <d2b2c> ../engine/net_ws.c:1118 */
@@ -196,7 +199,7 @@ extern qboolean noip;
 #ifdef _WIN32
 extern qboolean noipx;
 #endif // _WIN32
-extern sizebuf_t net_message;
+extern MSG_THREADLOCAL sizebuf_t net_message;
 extern cvar_t clockwindow;
 extern int use_thread;
 extern cvar_t iphostport;
@@ -220,9 +223,14 @@ extern int ip_sockets[3];
 #ifdef _WIN32
 extern int ipx_sockets[3];
 #endif // _WIN32
+extern unsigned int net_socket_generation;
 extern LONGPACKET gNetSplit;
 extern net_messages_t *messages[3];
 extern net_messages_t *normalqueue;
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+extern double net_from_delay;
+extern double in_arrival;
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
 
 
 void NET_ThreadLock(void);
@@ -252,6 +260,14 @@ void NET_AdjustLag(void);
 qboolean NET_LagPacket(qboolean newdata, netsrc_t sock, netadr_t *from, sizebuf_t *data);
 void NET_FlushSocket(netsrc_t sock);
 qboolean NET_GetLong(unsigned char *pData, int size, int *outSize);
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+qboolean NET_ThreadCheckRate(const netadr_t &from, const unsigned char *data, int size, double now);
+qboolean NET_ThreadDrainSocket(int net_socket, unsigned int generation);
+void NET_ThreadMain(void);
+int NET_PopThreadPacket(unsigned char *buf, netadr_t *from);
+void NET_ThreadStats_f(void);
+int64 NET_ThreadCpuTime(void);
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
 qboolean NET_QueuePacket(netsrc_t sock);
 int NET_Sleep_Timeout(void);
 int NET_Sleep(void);
@@ -110,6 +110,36 @@ hull_t *PM_HullForBox(vec_t *mins, vec_t *maxs)
 }
 
 /* <6f34f> ../engine/pmovetst.c:124 */
+#ifdef REHLDS_OPT_PEDANTIC
+int PM_HullPointContents_Packed(const hull_t *hull, const packedclipnode_t *nodes, int num, const vec_t *p)
+{
+	float d;
+	const packedclipnode_t *node;
+
+	if (hull->firstclipnode >= hull->lastclipnode)
+		return -1;
+
+	while (num >= 0)
+	{
+		if (num < hull->firstclipnode || num > hull->lastclipnode)
+			Sys_Error("PM_HullPointContents: bad node number");
+		node = &nodes[num];
+
+		if (node->type >= 3)
+			d = _DotProduct(p, node->normal) - node->dist;
+		else
+			d = p[node->type] - node->dist;
+
+		if (d >= 0.0)
+			num = node->children[0];
+		else
+			num = node->children[1];
+	}
+
+	return num;
+}
+#endif // REHLDS_OPT_PEDANTIC
+
 int EXT_FUNC PM_HullPointContents(hull_t *hull, int num, vec_t *p)
 {
 	float d;
@@ -119,6 +149,12 @@ int EXT_FUNC PM_HullPointContents(hull_t *hull, int num, vec_t *p)
 	if (hull->firstclipnode >= hull->lastclipnode)
 		return -1;
 
+#ifdef REHLDS_OPT_PEDANTIC
+	const packedclipnode_t *packed = Mod_FindPackedClipnodes(hull);
+	if (packed)
+		return PM_HullPointContents_Packed(hull, packed, num, p);
+#endif // REHLDS_OPT_PEDANTIC
+
 	while (num >= 0)
 	{
 		if (num < hull->firstclipnode || num > hull->lastclipnode)
@@ -779,7 +815,7 @@ qboolean PM_RecursiveHullCheck(hull_t *hull, int num, float p1f, float p2f, cons
 }
 #else // REHLDS_OPT_PEDANTIC
 // version with unrolled tail recursion
-qboolean PM_RecursiveHullCheck(hull_t *hull, int num, float p1f, float p2f, const vec_t *p1, const vec_t *p2, pmtrace_t *trace)
+qboolean PM_RecursiveHullCheck_Unpacked(hull_t *hull, int num, float p1f, float p2f, const vec_t *p1, const vec_t *p2, pmtrace_t *trace)
 {
 	dclipnode_t *node;
 	mplane_t *plane;
@@ -875,7 +911,7 @@ qboolean PM_RecursiveHullCheck(hull_t *hull, int num, float p1f, float p2f, cons
 
 		int side = (t1 >= 0.0) ? 0 : 1;
 
-		if (!PM_RecursiveHullCheck(hull, node->children[side], p1f, frac, p1, mid, trace))
+		if (!PM_RecursiveHullCheck_Unpacked(hull, node->children[side], p1f, frac, p1, mid, trace))
 			return 0;
 
 		if (PM_HullPointContents(hull, node->children[side ^ 1], mid) != -2)
@@ -946,4 +982,180 @@ qboolean PM_RecursiveHullCheck(hull_t *hull, int num, float p1f, float p2f, cons
 
 	return 0;
 }
+
+// same as above, but walks the packed clipnodes built by Mod_PackHulls
+qboolean PM_RecursiveHullCheck_Packed(const hull_t *hull, const packedclipnode_t *nodes, int num, float p1f, float p2f, const vec_t *p1, const vec_t *p2, pmtrace_t *trace)
+{
+	const packedclipnode_t *node;
+	vec3_t mid;
+	float pdif;
+	float frac;
+	float t1;
+	float t2;
+	float midf;
+	vec3_t custom_p1; // for holding custom p1 value
+
+	float DIST_EPSILON = 0.03125f;
+
+	while (1)
+	{
+		if (num < 0)
+		{
+			if (num == CONTENTS_SOLID)
+			{
+				trace->startsolid = TRUE;
+			}
+			else
+			{
+				trace->allsolid = FALSE;
+				if (num == CONTENTS_EMPTY)
+				{
+					trace->inopen = TRUE;
+				}
+				else
+				{
+					trace->inwater = TRUE;
+				}
+			}
+			return TRUE;
+		}
+
+		if (hull->firstclipnode >= hull->lastclipnode)
+		{
+			trace->allsolid = FALSE;
+			trace->inopen = TRUE;
+			return TRUE;
+		}
+
+		// find the point distances
+		node = &nodes[num];
+		if ((unsigned int)node->type >= 3u)
+		{
+			t1 = _DotProduct(p1, node->normal) - node->dist;
+			t2 = _DotProduct(p2, node->normal) - node->dist;
+		}
+		else
+		{
+			t1 = p1[node->type] - node->dist;
+			t2 = p2[node->type] - node->dist;
+		}
+		if (t1 >= 0.0 && t2 >= 0.0)
+		{
+			num = node->children[0]; // only 1 arg changed
+			continue;
+		}
+
+		if (t1 >= 0.0)
+		{
+			midf = t1 - DIST_EPSILON;
+		}
+		else
+		{
+			if (t2 < 0.0)
+			{
+				num = node->children[1];
+				continue;
+			}
+
+			midf = t1 + DIST_EPSILON;
+		}
+		midf = midf / (t1 - t2);
+		if (midf >= 0.0)
+		{
+			if (midf > 1.0)
+				midf = 1.0;
+		}
+		else
+		{
+			midf = 0.0;
+		}
+
+		pdif = p2f - p1f;
+		frac = pdif * midf + p1f;
+		mid[0] = (p2[0] - p1[0]) * midf + p1[0];
+		mid[1] = (p2[1] - p1[1]) * midf + p1[1];
+		mid[2] = (p2[2] - p1[2]) * midf + p1[2];
+
+		int side = (t1 >= 0.0) ? 0 : 1;
+
+		if (!PM_RecursiveHullCheck_Packed(hull, nodes, node->children[side], p1f, frac, p1, mid, trace))
+			return 0;
+
+		if (PM_HullPointContents_Packed(hull, nodes, node->children[side ^ 1], mid) != -2)
+		{
+			num = node->children[side ^ 1];
+			p1f = frac;
+			p1 = custom_p1;
+			custom_p1[0] = mid[0];
+			custom_p1[1] = mid[1];
+			custom_p1[2] = mid[2];
+			continue;
+		}
+
+		if (trace->allsolid)
+			return 0;
+
+		if (side)
+		{
+			trace->plane.normal[0] = vec3_origin[0] - node->normal[0];
+			trace->plane.normal[1] = vec3_origin[1] - node->normal[1];
+			trace->plane.normal[2] = vec3_origin[2] - node->normal[2];
+			trace->plane.dist = -node->dist;
+		}
+		else
+		{
+			trace->plane.normal[0] = node->normal[0];
+			trace->plane.normal[1] = node->normal[1];
+			trace->plane.normal[2] = node->normal[2];
+			trace->plane.dist = node->dist;
+		}
+
+		if (PM_HullPointContents_Packed(hull, nodes, hull->firstclipnode, mid) != -2)
+		{
+			trace->fraction = frac;
+			trace->endpos[0] = mid[0];
+			trace->endpos[1] = mid[1];
+			trace->endpos[2] = mid[2];
+			return 0;
+		}
+
+		while (1)
+		{
+			midf = (float)(midf - 0.05);
+			if (midf < 0.0)
+				break;
+
+			frac = pdif * midf + p1f;
+			mid[0] = (p2[0] - p1[0]) * midf + p1[0];
+			mid[1] = (p2[1] - p1[1]) * midf + p1[1];
+			mid[2] = (p2[2] - p1[2]) * midf + p1[2];
+			if (PM_HullPointContents_Packed(hull, nodes, hull->firstclipnode, mid) != -2)
+			{
+				trace->fraction = frac;
+				trace->endpos[0] = mid[0];
+				trace->endpos[1] = mid[1];
+				trace->endpos[2] = mid[2];
+				return 0;
+			}
+		}
+
+		trace->fraction = frac;
+		trace->endpos[0] = mid[0];
+		trace->endpos[1] = mid[1];
+		trace->endpos[2] = mid[2];
+		Con_DPrintf("Trace backed up past 0.0.\n");
+		return 0;
+	}
+
+	return 0;
+}
+
+qboolean PM_RecursiveHullCheck(hull_t *hull, int num, float p1f, float p2f, const vec_t *p1, const vec_t *p2, pmtrace_t *trace)
+{
+	const packedclipnode_t *packed = Mod_FindPackedClipnodes(hull);
+	if (packed)
+		return PM_RecursiveHullCheck_Packed(hull, packed, num, p1f, p2f, p1, p2, trace);
+
+	return PM_RecursiveHullCheck_Unpacked(hull, num, p1f, p2f, p1, p2, trace);
+}
 #endif // REHLDS_OPT_PEDANTIC
\ No newline at end of file
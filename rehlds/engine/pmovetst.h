@@ -74,4 +74,10 @@ struct pmtrace_s *PM_TraceLine(float *start, float *end, int flags, int usehull,
 struct pmtrace_s *PM_TraceLineEx(float *start, float *end, int flags, int usehull, int(*pfnIgnore)(physent_t *));
 qboolean PM_RecursiveHullCheck(hull_t *hull, int num, float p1f, float p2f, const vec_t *p1, const vec_t *p2, pmtrace_t *trace);
 
+#ifdef REHLDS_OPT_PEDANTIC
+int PM_HullPointContents_Packed(const hull_t *hull, const packedclipnode_t *nodes, int num, const vec_t *p);
+qboolean PM_RecursiveHullCheck_Unpacked(hull_t *hull, int num, float p1f, float p2f, const vec_t *p1, const vec_t *p2, pmtrace_t *trace);
+qboolean PM_RecursiveHullCheck_Packed(const hull_t *hull, const packedclipnode_t *nodes, int num, float p1f, float p2f, const vec_t *p1, const vec_t *p2, pmtrace_t *trace);
+#endif // REHLDS_OPT_PEDANTIC
+
 #endif // PMOVETST_H
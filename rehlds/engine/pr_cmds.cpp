@@ -402,6 +402,75 @@ void EXT_FUNC TraceHull(const float *v1, const float *v2, int fNoMonsters, int h
 	ptr->vecPlaneNormal[2] = trace.plane.normal[2];
 }
 
+void EXT_FUNC TraceBatch(const RehldsTraceRequest_t *requests, TraceResult *results, int count)
+{
+	movebatch_t moves[MOVEBATCH_GROUP_SIZE];
+	trace_t traces[MOVEBATCH_GROUP_SIZE];
+
+	// SV_MoveBatch updates trace_ent like SV_Move does, the batch leaves gpGlobals->trace_* alone
+	edict_t *oldTraceEnt = gGlobalVariables.trace_ent;
+
+	for (int first = 0; first < count; first += MOVEBATCH_GROUP_SIZE)
+	{
+		int num = min(count - first, MOVEBATCH_GROUP_SIZE);
+		for (int i = 0; i < num; i++)
+		{
+			const RehldsTraceRequest_t *req = &requests[first + i];
+			movebatch_t *move = &moves[i];
+
+			move->start = req->start;
+			move->end = req->end;
+			move->type = req->fNoMonsters;
+			move->monsterClipBrush = FALSE;
+			if (req->hullNumber < 0)
+			{
+				// as PF_traceline_DLL
+				move->mins = NULL;
+				move->maxs = NULL;
+				move->passedict = req->pentToSkip ? req->pentToSkip : &g_psv.edicts[0];
+			}
+			else
+			{
+				// as TraceHull
+				int hullNumber = (req->hullNumber > 3) ? 0 : req->hullNumber;
+				move->mins = gHullMins[hullNumber];
+				move->maxs = gHullMaxs[hullNumber];
+				move->passedict = req->pentToSkip;
+			}
+		}
+
+		SV_MoveBatch(moves, traces, num);
+
+		for (int i = 0; i < num; i++)
+		{
+			const trace_t *trace = &traces[i];
+			TraceResult *ptr = &results[first + i];
+
+			ptr->fAllSolid = trace->allsolid;
+			ptr->fStartSolid = trace->startsolid;
+			ptr->fInOpen = trace->inopen;
+			ptr->fInWater = trace->inwater;
+			ptr->flFraction = trace->fraction;
+			ptr->flPlaneDist = trace->plane.dist;
+			ptr->pHit = trace->ent;
+			ptr->iHitgroup = trace->hitgroup;
+
+			// line traces report the world as SV_SetGlobalTrace does
+			if (!ptr->pHit && requests[first + i].hullNumber < 0)
+				ptr->pHit = &g_psv.edicts[0];
+
+			ptr->vecEndPos[0] = trace->endpos[0];
+			ptr->vecEndPos[1] = trace->endpos[1];
+			ptr->vecEndPos[2] = trace->endpos[2];
+			ptr->vecPlaneNormal[0] = trace->plane.normal[0];
+			ptr->vecPlaneNormal[1] = trace->plane.normal[1];
+			ptr->vecPlaneNormal[2] = trace->plane.normal[2];
+		}
+	}
+
+	gGlobalVariables.trace_ent = oldTraceEnt;
+}
+
 /* <788c8> ../engine/pr_cmds.c:556 */
 void EXT_FUNC TraceSphere(const float *v1, const float *v2, int fNoMonsters, float radius, edict_t *pentToSkip, TraceResult *ptr)
 {
@@ -1235,6 +1304,45 @@ void EV_PlayReliableEvent_internal(client_t *cl, int entindex, short unsigned in
 	
 }
 
+#ifdef REHLDS_OPT_PEDANTIC
+// Leaf of each client's origin, recomputed only when the client has moved
+typedef struct evclientleaf_s
+{
+	int spawncount;
+	vec3_t origin;
+	int leafnum;
+} evclientleaf_t;
+
+evclientleaf_t g_EventClientLeaf[MAX_CLIENTS];
+
+static int EV_ClientLeafnum(client_t *cl)
+{
+	evclientleaf_t *cache = &g_EventClientLeaf[cl - g_psvs.clients];
+	float *origin = cl->edict->v.origin;
+
+	if (cache->spawncount != g_psvs.spawncount || !VectorCompare(cache->origin, origin))
+	{
+		cache->spawncount = g_psvs.spawncount;
+		cache->origin[0] = origin[0];
+		cache->origin[1] = origin[1];
+		cache->origin[2] = origin[2];
+		cache->leafnum = SV_PointLeafnum(origin);
+	}
+
+	return cache->leafnum;
+}
+
+// Same answer as SV_ValidClientMulticast(cl, leafnum, MSG_FL_PAS) with the PAS row looked up once per event
+static qboolean EV_ClientInPAS(client_t *cl, qboolean everyone, unsigned char *pas)
+{
+	if (everyone || cl->proxy || !pas)
+		return TRUE;
+
+	int bitNumber = EV_ClientLeafnum(cl);
+	return (pas[(bitNumber - 1) >> 3] & (1 << ((bitNumber - 1) & 7))) ? TRUE : FALSE;
+}
+#endif // REHLDS_OPT_PEDANTIC
+
 /* <79769> ../engine/pr_cmds.c:1595 */
 void EXT_FUNC EV_Playback(int flags, const edict_t *pInvoker, short unsigned int eventindex, float delay, float *origin, float *angles, float fparam1, float fparam2, int iparam1, int iparam2, int bparam1, int bparam2)
 {
@@ -1320,6 +1428,11 @@ void EXT_FUNC EV_Playback(int flags, const edict_t *pInvoker, short unsigned int
 
 	leafnum = SV_PointLeafnum(event_origin);
 
+#ifdef REHLDS_OPT_PEDANTIC
+	qboolean everyone = Host_IsSinglePlayerGame();
+	unsigned char *pas = CM_LeafPAS(leafnum);
+#endif // REHLDS_OPT_PEDANTIC
+
 	for (slot = 0; slot < g_psvs.maxclients; slot++)
 	{
 		cl = &g_psvs.clients[slot];
@@ -1348,7 +1461,11 @@ void EXT_FUNC EV_Playback(int flags, const edict_t *pInvoker, short unsigned int
 
 		if (pInvoker && !(flags & FEV_GLOBAL))
 		{
+#ifdef REHLDS_OPT_PEDANTIC
+			if (!EV_ClientInPAS(cl, everyone, pas))
+#else // REHLDS_OPT_PEDANTIC
 			if (!SV_ValidClientMulticast(cl, leafnum, 4))
+#endif // REHLDS_OPT_PEDANTIC
 				continue;
 		}
 
@@ -1595,7 +1712,7 @@ char* EXT_FUNC PF_GetInfoKeyBuffer_I(edict_t *e)
 /* <79b55> ../engine/pr_cmds.c:2012 */
 char* EXT_FUNC PF_InfoKeyValue_I(char *infobuffer, const char *key)
 {
-	return (char *)Info_ValueForKey(infobuffer, key);
+	return (char *)SV_ClientInfoValueForKey(infobuffer, key);
 }
 
 /* <79b91> ../engine/pr_cmds.c:2022 */
@@ -2605,7 +2722,7 @@ const char* EXT_FUNC PF_GetPhysicsKeyValue(const edict_t *pClient, const char *k
 	}
 
 	client_t* client = &g_psvs.clients[entnum - 1];
-	return Info_ValueForKey(client->physinfo, key);
+	return SV_ClientInfoValueForKey(client->physinfo, key);
 }
 
 /* <7aa85> ../engine/pr_cmds.c:3273 */
@@ -74,6 +74,8 @@
 #endif // HOOK_ENGINE
 
 
+extern vec_t gHullMins[4][3];
+extern vec_t gHullMaxs[4][3];
 extern unsigned char gMsgData[512];
 extern sizebuf_t gMsgBuffer;
 extern edict_t *gMsgEntity;
@@ -115,6 +117,7 @@ void PF_sound_I(edict_t *entity, int channel, const char *sample, float volume,
 void PF_traceline_Shared(const float *v1, const float *v2, int nomonsters, edict_t *ent);
 void PF_traceline_DLL(const float *v1, const float *v2, int fNoMonsters, edict_t *pentToSkip, TraceResult *ptr);
 void TraceHull(const float *v1, const float *v2, int fNoMonsters, int hullNumber, edict_t *pentToSkip, TraceResult *ptr);
+void TraceBatch(const RehldsTraceRequest_t *requests, TraceResult *results, int count);
 void TraceSphere(const float *v1, const float *v2, int fNoMonsters, float radius, edict_t *pentToSkip, TraceResult *ptr);
 void TraceModel(const float *v1, const float *v2, int hullNumber, edict_t *pent, TraceResult *ptr);
 msurface_t *SurfaceAtPoint(model_t *pModel, mnode_t *node, vec_t *start, vec_t *end);
@@ -1134,6 +1134,10 @@ int R_GetStudioBounds(const char *filename, float *mins, float *maxs)
 	if (!Q_strstr(filename, "models") || !Q_strstr(filename, ".mdl"))
 		return 0;
 
+#ifdef REHLDS_OPT_PEDANTIC
+	if (Mod_ResidentStudioBounds(filename, mins, maxs, &iret))
+		return iret;
+#endif // REHLDS_OPT_PEDANTIC
 
 	FileHandle_t fp = FS_Open(filename, "rb");
 	if (!fp)
@@ -275,6 +275,43 @@ typedef struct deltacallback_s
 	int offset;
 } deltacallback_t;
 
+// SV_FatSetSides results
+#define FATSET_FRONT		1
+#define FATSET_BACK			2
+#define FATSET_BOTH			(FATSET_FRONT | FATSET_BACK)
+
+#ifdef REHLDS_OPT_PEDANTIC
+#define FATSET_MAXLEAFS		8
+#define FATSET_CACHE_SIZE	64 // must be power of 2
+
+// Leaf bits of one edict, valid while headnode matches the edict's one
+typedef struct entleafmask_s
+{
+	qboolean valid;
+	int headnode;
+	int firstbyte;	// nonzero bytes are [firstbyte, endbyte)
+	int endbyte;
+} entleafmask_t;
+
+// Leafs within 8 units of a view origin, in SV_AddToFatPVS/SV_AddToFatPAS order
+typedef struct fatsetkey_s
+{
+	int numleafs;
+	int leafnums[FATSET_MAXLEAFS];
+} fatsetkey_t;
+
+typedef struct fatsetcache_s
+{
+	fatsetkey_t keys[FATSET_CACHE_SIZE];
+	unsigned char *rows;
+	int rowbytes;
+	fatsetkey_t pending;	// key of the last miss, stored by SV_FatSetToCache
+	int pendingslot;
+	unsigned int hits;
+	unsigned int misses;
+} fatsetcache_t;
+#endif // REHLDS_OPT_PEDANTIC
+
 
 #ifdef HOOK_ENGINE
 #define pr_strings (*ppr_strings)
@@ -682,6 +719,10 @@ void SV_CheckRate(client_t *cl);
 void SV_ProcessFile(client_t *cl, char *filename);
 qboolean SV_FilterPacket(void);
 void SV_SendBan(void);
+void SV_ProcessPacket(void);
+#ifdef REHLDS_OPT_PEDANTIC
+void SV_ReadPacketsQueued(void);
+#endif // REHLDS_OPT_PEDANTIC
 void SV_ReadPackets(void);
 //NOBODY int ntohl(void);
 //NOBODY int htons(void);
@@ -690,10 +731,38 @@ int SV_CalcPing(client_t *cl);
 void SV_FullClientUpdate(client_t *cl, sizebuf_t *sb);
 void SV_EmitEvents(client_t *cl, packet_entities_t *pack, sizebuf_t *msg);
 void SV_EmitEvents_internal(client_t *cl, packet_entities_t *pack, sizebuf_t *msg);
+int SV_FatSetSides(const vec_t *org, const mnode_t *node, qboolean pas);
 void SV_AddToFatPVS(vec_t *org, mnode_t *node);
 unsigned char *SV_FatPVS(float *org);
 void SV_AddToFatPAS(vec_t *org, mnode_t *node);
 unsigned char *SV_FatPAS(float *org);
+
+#ifdef REHLDS_OPT_PEDANTIC
+extern cvar_t sv_vis_maxmem;
+extern cvar_t sv_parallel_moves;
+extern unsigned char *sv_leafmasks;
+extern entleafmask_t *sv_leafmaskinfo;
+extern int sv_leafmaskbytes;
+extern fatsetcache_t sv_fatpvscache;
+extern fatsetcache_t sv_fatpascache;
+
+void SV_CollectFatLeafs(vec_t *org, mnode_t *node, fatsetkey_t *key, qboolean pas);
+qboolean SV_FatSetFromCache(fatsetcache_t *cache, vec_t *org, unsigned char *out, int bytes, qboolean pas);
+void SV_FatSetToCache(fatsetcache_t *cache, const unsigned char *set, int bytes);
+void SV_SetLeafMaskBit(unsigned char *mask, entleafmask_t *info, int leafnum);
+void SV_SetHeadnodeLeafMask(mnode_t *node, unsigned char *mask, entleafmask_t *info);
+void SV_BuildLeafMask(edict_t *ent);
+int SV_LeafMaskVisible(const unsigned char *mask, const entleafmask_t *info, const unsigned char *pset);
+void SV_InitVisCache(void);
+void SV_VisStats_f(void);
+
+#define MAPLOAD_MAX_PHASES	16
+
+void SV_MapLoadTimingBegin(void);
+void SV_MapLoadPhase(const char *name);
+void SV_MapLoadTimingEnd(void);
+void SV_MapLoadTimes_f(void);
+#endif // REHLDS_OPT_PEDANTIC
 int SV_PointLeafnum(vec_t *p);
 void TRACE_DELTA(char *fmt, ...);
 void SV_SetCallback(int num, qboolean remove, qboolean custom, int *numbase, qboolean full, int offset);
@@ -714,6 +783,7 @@ qboolean SV_SendClientDatagram(client_t *client);
 void SV_UpdateToReliableMessages(void);
 void SV_SkipUpdates(void);
 void SV_SendClientMessages(void);
+const char *SV_ClientInfoValueForKey(const char *s, const char *key);
 void SV_ExtractFromUserinfo(client_t *cl);
 int SV_ModelIndex(const char *name);
 void SV_AddResource(resourcetype_t type, const char *name, int size, unsigned char flags, int index);
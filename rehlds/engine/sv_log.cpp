@@ -57,8 +57,14 @@ void Log_Printf(const char *fmt, ...)
 	if (!g_psvs.log.net_log_ && !firstLog && !g_psvs.log.active)
 		return;
 
+#ifdef _WIN32
 	time(&ltime);
 	today = localtime(&ltime);
+#else // _WIN32
+	// through the platform layer so the testsuite records and replays the timestamps
+	ltime = CRehldsPlatformHolder::get()->time(NULL);
+	today = CRehldsPlatformHolder::get()->localtime(ltime);
+#endif // _WIN32
 
 	va_start(argptr, fmt);
 	Q_snprintf(string,sizeof(string), "L %02i/%02i/%04i - %02i:%02i:%02i: ",
@@ -148,8 +154,13 @@ void Log_Open(void)
 	else
 	{
 		Log_Close();
+#ifdef _WIN32
 		time(&ltime);
 		today = localtime(&ltime);
+#else // _WIN32
+		ltime = CRehldsPlatformHolder::get()->time(NULL);
+		today = CRehldsPlatformHolder::get()->localtime(ltime);
+#endif // _WIN32
 
 		temp = Cvar_VariableString("logsdir");
 
@@ -1748,7 +1748,7 @@ int SV_GetFragmentSize(void *state)
 	if (cl->active && cl->spawned && cl->connected && cl->fully_connected)
 	{
 		size = 256;
-		const char *val = Info_ValueForKey(cl->userinfo, "cl_dlmax");
+		const char *val = SV_ClientInfoValueForKey(cl->userinfo, "cl_dlmax");
 		if (val[0] != 0)
 		{
 			size = Q_atoi( val );
@@ -3537,76 +3537,249 @@ bool EXT_FUNC NET_GetPacketPreprocessor(uint8* data, unsigned int len, const net
 	return true;
 }
 
-/* <ab9af> ../engine/sv_main.c:4818 */
-void SV_ReadPackets(void)
+// One packet from NET_GetPacket, as it is in net_message and net_from
+void SV_ProcessPacket(void)
 {
-	while (NET_GetPacket(NS_SERVER))
+#ifdef REHLDS_OPT_PEDANTIC
+	g_MetricsNet.packetsIn++;
+	g_MetricsNet.bytesIn += net_message.cursize;
+#endif // REHLDS_OPT_PEDANTIC
+
+	if (SV_FilterPacket())
 	{
-		if (SV_FilterPacket())
+		SV_SendBan();
+		return;
+	}
+
+	bool pass = g_RehldsHookchains.m_PreprocessPacket.callChain(NET_GetPacketPreprocessor, net_message.data, net_message.cursize, net_from);
+	if (!pass)
+		return;
+
+	if (*(uint32 *)net_message.data == 0xFFFFFFFF)
+	{
+		// Connectionless packet
+		if (CheckIP(net_from))
+		{
+			Steam_HandleIncomingPacket(net_message.data, net_message.cursize, ntohl(*(u_long *)&net_from.ip[0]), htons(net_from.port));
+			SV_ConnectionlessPacket();
+		}
+		else if (sv_logblocks.value != 0.0f)
+		{
+			Log_Printf("Traffic from %s was blocked for exceeding rate limits\n", NET_AdrToString(net_from));
+		}
+		return;
+	}
+
+	for (int i = 0 ; i < g_psvs.maxclients; i++)
+	{
+		client_t *cl = &g_psvs.clients[i];
+		if (!cl->connected && !cl->active && !cl->spawned)
 		{
-			SV_SendBan();
 			continue;
 		}
 
-		bool pass = g_RehldsHookchains.m_PreprocessPacket.callChain(NET_GetPacketPreprocessor, net_message.data, net_message.cursize, net_from);
-		if (!pass)
+		if (NET_CompareAdr(net_from, cl->netchan.remote_address) != TRUE)
+		{
 			continue;
+		}
 
-		if (*(uint32 *)net_message.data == 0xFFFFFFFF)
+		if (Netchan_Process(&cl->netchan))
 		{
-			// Connectionless packet
-			if (CheckIP(net_from))
+			if (g_psvs.maxclients == 1 || !cl->active || !cl->spawned || !cl->fully_connected)
 			{
-				Steam_HandleIncomingPacket(net_message.data, net_message.cursize, ntohl(*(u_long *)&net_from.ip[0]), htons(net_from.port));
-				SV_ConnectionlessPacket();
+				cl->send_message = TRUE;
 			}
-			else if (sv_logblocks.value != 0.0f)
-			{
-				Log_Printf("Traffic from %s was blocked for exceeding rate limits\n", NET_AdrToString(net_from));
-			}
-			continue;
+
+			SV_ExecuteClientMessage(cl);
+			gGlobalVariables.frametime = host_frametime;
 		}
 
-		for (int i = 0 ; i < g_psvs.maxclients; i++)
+		if (Netchan_IncomingReady(&cl->netchan))
 		{
-			client_t *cl = &g_psvs.clients[i];
-			if (!cl->connected && !cl->active && !cl->spawned)
+			if (Netchan_CopyNormalFragments(&cl->netchan))
 			{
-				continue;
+				MSG_BeginReading();
+				SV_ExecuteClientMessage(cl);
 			}
-
-			if (NET_CompareAdr(net_from, cl->netchan.remote_address) != TRUE)
+			if (Netchan_CopyFileFragments(&cl->netchan))
 			{
-				continue;
+				host_client = cl;
+				SV_ProcessFile(cl, cl->netchan.incomingfilename);
 			}
+		}
+	}
+}
 
-			if (Netchan_Process(&cl->netchan))
-			{
-				if (g_psvs.maxclients == 1 || !cl->active || !cl->spawned || !cl->fully_connected)
-				{
-					cl->send_message = TRUE;
-				}
+#ifdef REHLDS_OPT_PEDANTIC
+// Client packets are read in batches: the clc_move of each is decoded on worker threads, client by client,
+// then the main thread handles the packets in the order they came in and takes the decoded moves on the way
+cvar_t sv_parallel_moves = { "sv_parallel_moves", "1", 0, 0.0f, NULL };
 
-				SV_ExecuteClientMessage(cl);
-				gGlobalVariables.frametime = host_frametime;
-			}
+#define SV_PACKETQUEUE_SIZE		128
+#define SV_PACKETQUEUE_BYTES	(4 * NET_MAX_PAYLOAD)
+#define SV_PARALLEL_MOVES_MIN	4	// clients with packets in a batch, below that workers cost more than they save
+
+typedef struct queuedpacket_s
+{
+	netadr_t from;
+#ifndef _WIN32
+	double delay;		// net_from_delay
+#endif // _WIN32
+	int offset;			// in packetqueue_t.data
+	int size;
+	int next;			// next packet of the same client, -1 ends the list
+	predecodedmove_t move;
+} queuedpacket_t;
+
+typedef struct packetqueue_s
+{
+	queuedpacket_t packets[SV_PACKETQUEUE_SIZE];
+	int numpackets;
+	unsigned char data[SV_PACKETQUEUE_BYTES];
+	int datasize;
+
+	// per client lists of packets
+	int first[MAX_CLIENTS];
+	int last[MAX_CLIENTS];
+	int clients[MAX_CLIENTS];	// the ones with packets
+	int numclients;
+} packetqueue_t;
 
-			if (Netchan_IncomingReady(&cl->netchan))
+static packetqueue_t *sv_packetqueue;
+
+// Appends what NET_GetPacket left in net_message
+void SV_QueuePacket(packetqueue_t *queue)
+{
+	int index = queue->numpackets++;
+	queuedpacket_t *packet = &queue->packets[index];
+
+	packet->from = net_from;
+#ifndef _WIN32
+	packet->delay = net_from_delay;
+#endif // _WIN32
+	packet->offset = queue->datasize;
+	packet->size = net_message.cursize;
+	packet->next = -1;
+	packet->move.valid = FALSE;
+	Q_memcpy(&queue->data[packet->offset], net_message.data, packet->size);
+	queue->datasize += packet->size;
+
+	if (packet->size < 8 || *(uint32 *)net_message.data == 0xFFFFFFFF)
+		return;
+
+	for (int i = 0; i < g_psvs.maxclients; i++)
+	{
+		client_t *cl = &g_psvs.clients[i];
+		if (!cl->connected && !cl->active && !cl->spawned)
+			continue;
+
+		if (NET_CompareAdr(net_from, cl->netchan.remote_address) != TRUE)
+			continue;
+
+		if (queue->first[i] == -1)
+		{
+			queue->first[i] = index;
+			queue->clients[queue->numclients++] = i;
+		}
+		else
+		{
+			queue->packets[queue->last[i]].next = index;
+		}
+
+		queue->last[i] = index;
+		break;
+	}
+}
+
+void SV_PredecodeWorker(void *arg, int first, int last, int)
+{
+	packetqueue_t *queue = (packetqueue_t *)arg;
+
+	// the calling thread runs a share of the clients too, its message state must survive
+	sizebuf_t savedMessage = net_message;
+	int savedReadcount = msg_readcount;
+	int savedBadread = msg_badread;
+
+	for (int i = first; i < last; i++)
+	{
+		for (int index = queue->first[queue->clients[i]]; index != -1; index = queue->packets[index].next)
+		{
+			queuedpacket_t *packet = &queue->packets[index];
+			SV_PredecodeMove(&queue->data[packet->offset], packet->size, &packet->move);
+		}
+	}
+
+	net_message = savedMessage;
+	msg_readcount = savedReadcount;
+	msg_badread = savedBadread;
+}
+
+void SV_ReadPacketsQueued(void)
+{
+	if (!sv_packetqueue)
+		sv_packetqueue = (packetqueue_t *)Mem_Malloc(sizeof(packetqueue_t));
+
+	packetqueue_t *queue = sv_packetqueue;
+	qboolean drained = FALSE;
+
+	while (!drained)
+	{
+		queue->numpackets = 0;
+		queue->datasize = 0;
+		queue->numclients = 0;
+		for (int i = 0; i < MAX_CLIENTS; i++)
+			queue->first[i] = -1;
+
+		while (queue->numpackets < SV_PACKETQUEUE_SIZE && queue->datasize + NET_MAX_PAYLOAD <= SV_PACKETQUEUE_BYTES)
+		{
+			if (!NET_GetPacket(NS_SERVER))
 			{
-				if (Netchan_CopyNormalFragments(&cl->netchan))
-				{
-					MSG_BeginReading();
-					SV_ExecuteClientMessage(cl);
-				}
-				if (Netchan_CopyFileFragments(&cl->netchan))
-				{
-					host_client = cl;
-					SV_ProcessFile(cl, cl->netchan.incomingfilename);
-				}
+				drained = TRUE;
+				break;
 			}
+
+			SV_QueuePacket(queue);
+		}
+
+		if (queue->numclients >= SV_PARALLEL_MOVES_MIN)
+			Sys_ParallelFor(queue->numclients, 1, SV_PredecodeWorker, queue);
+
+		for (int i = 0; i < queue->numpackets; i++)
+		{
+			queuedpacket_t *packet = &queue->packets[i];
+
+			net_from = packet->from;
+#ifndef _WIN32
+			net_from_delay = packet->delay;
+#endif // _WIN32
+			net_message.cursize = packet->size;
+			Q_memcpy(net_message.data, &queue->data[packet->offset], packet->size);
+
+			sv_predecodedmove = &packet->move;
+			SV_ProcessPacket();
+			sv_predecodedmove = NULL;
 		}
 	}
 }
+#endif // REHLDS_OPT_PEDANTIC
+
+/* <ab9af> ../engine/sv_main.c:4818 */
+void SV_ReadPackets(void)
+{
+#ifdef REHLDS_OPT_PEDANTIC
+	// a lone client has nothing to run in parallel with
+	if (sv_parallel_moves.value != 0.0f && g_psvs.maxclients > 1 && Sys_ParallelThreads() > 1)
+	{
+		SV_ReadPacketsQueued();
+		return;
+	}
+#endif // REHLDS_OPT_PEDANTIC
+
+	while (NET_GetPacket(NS_SERVER))
+	{
+		SV_ProcessPacket();
+	}
+}
 
 /* <aba20> ../engine/sv_main.c:4842 */
 //NOBODY int ntohl(void);
@@ -3733,6 +3906,97 @@ void SV_EmitEvents(client_t *cl, packet_entities_t *pack, sizebuf_t *ms)
 	g_RehldsHookchains.m_SV_EmitEvents.callChain(SV_EmitEvents_api, GetRehldsApiClient(cl), pack, ms);
 }
 
+#ifdef REHLDS_OPT_PEDANTIC
+/*
+An event played back to many clients usually ends up with the same arguments for all of them.
+Its delta against the null event_args_t is encoded once into this cache and then copied bit for bit
+into every client's message.
+*/
+#define EVENT_ENCODE_CACHE_SIZE	128
+#define EVENT_ENCODE_MAX_BYTES	128
+
+typedef struct eventencode_s
+{
+	qboolean valid;
+	delta_t *delta;
+	double time;				// time window fields are encoded against g_psv.time
+	event_args_t args;
+	int numbits;
+	byte data[EVENT_ENCODE_MAX_BYTES + 4];	// bit writer may touch a dword past the end
+	delta_record_t stats;		// sv_delta_stats of the encode, counted on every send
+} eventencode_t;
+
+eventencode_t g_EventEncodeCache[EVENT_ENCODE_CACHE_SIZE];
+
+static eventencode_t *SV_EventEncodeSlot(const event_args_t *args)
+{
+	const byte *p = (const byte *)args;
+	unsigned int hash = 2166136261u;
+	for (int i = 0; i < sizeof(event_args_t); i++)
+		hash = (hash ^ p[i]) * 16777619u;
+
+	return &g_EventEncodeCache[hash % EVENT_ENCODE_CACHE_SIZE];
+}
+
+static eventencode_t *SV_FindEncodedEvent(const event_args_t *args)
+{
+	eventencode_t *slot = SV_EventEncodeSlot(args);
+	if (slot->valid && slot->delta == g_peventdelta && slot->time == g_psv.time && !Q_memcmp(&slot->args, args, sizeof(event_args_t)))
+		return slot;
+
+	return NULL;
+}
+
+// Must be called outside of bit writing
+static void SV_EncodeEvent(event_args_t *nullargs, event_args_t *args)
+{
+	if (SV_FindEncodedEvent(args))
+		return;
+
+	eventencode_t *slot = SV_EventEncodeSlot(args);
+	sizebuf_t buf;
+
+	buf.buffername = "Event Encode";
+	buf.flags = SIZEBUF_ALLOW_OVERFLOW;
+	buf.data = slot->data;
+	buf.maxsize = EVENT_ENCODE_MAX_BYTES;
+	buf.cursize = 0;
+
+	DELTA_StatsStartRecord(&slot->stats);
+	MSG_StartBitWriting(&buf);
+	DELTA_WriteDelta((byte *)nullargs, (byte *)args, TRUE, g_peventdelta, NULL);
+	slot->numbits = MSG_BitsWritten();
+	MSG_EndBitWriting(&buf);
+	DELTA_StatsEndRecord();
+
+	if (buf.flags & SIZEBUF_OVERFLOWED)
+	{
+		slot->valid = FALSE;
+		return;
+	}
+
+	slot->valid = TRUE;
+	slot->delta = g_peventdelta;
+	slot->time = g_psv.time;
+	Q_memcpy(&slot->args, args, sizeof(event_args_t));
+}
+
+static void SV_WriteEncodedEvent(eventencode_t *slot)
+{
+	int bytes = slot->numbits >> 3;
+	int bits = slot->numbits & 7;
+
+	for (int i = 0; i < bytes; i++)
+		MSG_WriteBits(slot->data[i], 8);
+
+	if (bits)
+		MSG_WriteBits(slot->data[bytes] & ((1 << bits) - 1), bits);
+
+	if (sv_delta_stats.value != 0.0f)
+		DELTA_StatsReplay(slot->delta, &slot->stats);
+}
+#endif // REHLDS_OPT_PEDANTIC
+
 /* <a8995> ../engine/sv_main.c:5027 */
 void SV_EmitEvents_internal(client_t *cl, packet_entities_t *pack, sizebuf_t *msg)
 {
@@ -3814,6 +4078,11 @@ void SV_EmitEvents_internal(client_t *cl, packet_entities_t *pack, sizebuf_t *ms
 			info->args.entindex = etofind;
 			info->packet_index = pack->num_entities;
 		}
+
+#ifdef REHLDS_OPT_PEDANTIC
+		if (Q_memcmp(&nullargs, &info->args, sizeof(event_args_t)))
+			SV_EncodeEvent(&nullargs, &info->args);
+#endif // REHLDS_OPT_PEDANTIC
 	}
 
 	MSG_WriteByte(msg, svc_event);
@@ -3844,7 +4113,16 @@ void SV_EmitEvents_internal(client_t *cl, packet_entities_t *pack, sizebuf_t *ms
 				if (Q_memcmp(&nullargs, &info->args, sizeof(event_args_t)))
 				{
 					MSG_WriteBits(1, 1);
+#ifdef REHLDS_OPT_PEDANTIC
+					// the slot may have been taken by another event of this client, encode in place then
+					eventencode_t *encoded = SV_FindEncodedEvent(&info->args);
+					if (encoded)
+						SV_WriteEncodedEvent(encoded);
+					else
+						DELTA_WriteDelta((byte *)&nullargs, (byte *)&info->args, TRUE, g_peventdelta, NULL);
+#else // REHLDS_OPT_PEDANTIC
 					DELTA_WriteDelta((byte *)&nullargs, (byte *)&info->args, TRUE, g_peventdelta, NULL);
+#endif // REHLDS_OPT_PEDANTIC
 				}
 				else
 				{
@@ -3882,27 +4160,49 @@ int fatpasbytes;
 unsigned char fatpas[1024];
 
 /* <a8a7c> ../engine/sv_main.c:5196 */
+// Children of node within 8 units of org. The PVS and PAS walks evaluate the plane distance
+// in different order, so the result can differ right at the margin; callers pass which one they mirror
+int SV_FatSetSides(const vec_t *org, const mnode_t *node, qboolean pas)
+{
+	mplane_t *plane = node->plane;
+	float d;
+
+	if (pas)
+	{
+		d = org[0] * plane->normal[0] +
+			org[1] * plane->normal[1] +
+			org[2] * plane->normal[2] - plane->dist;
+
+		if (d > 8.0f)
+			return FATSET_FRONT;
+		if (d < -8.0f)
+			return FATSET_BACK;
+		return FATSET_BOTH;
+	}
+
+	d = plane->normal[2] * org[2] + plane->normal[1] * org[1] + plane->normal[0] * org[0] - plane->dist;
+	if (d <= 8.0f)
+	{
+		if (d >= -8.0f)
+			return FATSET_BOTH;
+		return FATSET_BACK;
+	}
+	return FATSET_FRONT;
+}
+
 void SV_AddToFatPVS(vec_t *org, mnode_t *node)
 {
 	while (node->contents >= 0)
 	{
-		mplane_t *plane = node->plane;
-		float d = plane->normal[2] * org[2] + plane->normal[1] * org[1] + plane->normal[0] * org[0] - plane->dist;
-		if (d <= 8.0f)
+		int sides = SV_FatSetSides(org, node, FALSE);
+		if (sides == FATSET_BOTH)
 		{
-			if (d >= -8.0f)
-			{
-				SV_AddToFatPVS(org, node->children[0]);
-				node = node->children[1];
-			}
-			else
-			{
-				node = node->children[1];
-			}
+			SV_AddToFatPVS(org, node->children[0]);
+			node = node->children[1];
 		}
 		else
 		{
-			node = node->children[0];
+			node = node->children[sides == FATSET_BACK];
 		}
 	}
 	if (node->contents != CONTENTS_SOLID)
@@ -3917,8 +4217,15 @@ void SV_AddToFatPVS(vec_t *org, mnode_t *node)
 unsigned char* EXT_FUNC SV_FatPVS(float *org)
 {
 	fatbytes = (g_psv.worldmodel->numleafs + 31) >> 3;
+#ifdef REHLDS_OPT_PEDANTIC
+	if (SV_FatSetFromCache(&sv_fatpvscache, org, fatpvs, fatbytes, FALSE))
+		return fatpvs;
+#endif // REHLDS_OPT_PEDANTIC
 	Q_memset(fatpvs, 0, fatbytes);
 	SV_AddToFatPVS(org, g_psv.worldmodel->nodes);
+#ifdef REHLDS_OPT_PEDANTIC
+	SV_FatSetToCache(&sv_fatpvscache, fatpvs, fatbytes);
+#endif // REHLDS_OPT_PEDANTIC
 	return fatpvs;
 }
 
@@ -3927,28 +4234,19 @@ void SV_AddToFatPAS(vec_t *org, mnode_t *node)
 {
 	int i;
 	unsigned char *pas;
-	mplane_t *plane;
-	float d;
+	int sides;
 
 	while (node->contents >= 0)
 	{
-		plane = node->plane;
-		d = org[0] * plane->normal[0] +
-			org[1] * plane->normal[1] +
-			org[2] * plane->normal[2] - plane->dist;
-
-		if (d > 8.0f)
-		{
-			node = node->children[0];
-		}
-		else if (d < -8.0f)
+		sides = SV_FatSetSides(org, node, TRUE);
+		if (sides == FATSET_BOTH)
 		{
+			SV_AddToFatPAS(org, node->children[0]);
 			node = node->children[1];
 		}
 		else
 		{
-			SV_AddToFatPAS(org, node->children[0]);
-			node = node->children[1];
+			node = node->children[sides == FATSET_BACK];
 		}
 	}
 
@@ -3970,11 +4268,258 @@ void SV_AddToFatPAS(vec_t *org, mnode_t *node)
 unsigned char* EXT_FUNC SV_FatPAS(float *org)
 {
 	fatpasbytes = (g_psv.worldmodel->numleafs + 31) >> 3;
+#ifdef REHLDS_OPT_PEDANTIC
+	if (SV_FatSetFromCache(&sv_fatpascache, org, fatpas, fatpasbytes, TRUE))
+		return fatpas;
+#endif // REHLDS_OPT_PEDANTIC
 	Q_memset(fatpas, 0, fatpasbytes);
 	SV_AddToFatPAS(org, g_psv.worldmodel->nodes);
+#ifdef REHLDS_OPT_PEDANTIC
+	SV_FatSetToCache(&sv_fatpascache, fatpas, fatpasbytes);
+#endif // REHLDS_OPT_PEDANTIC
 	return fatpas;
 }
 
+#ifdef REHLDS_OPT_PEDANTIC
+// Visibility acceleration. Both structures live on the hunk for the current map only:
+// - a leaf bitmask per edict, rebuilt by SV_LinkEdict, so SV_CheckVisibility is an AND over the few bytes the entity touches
+//   instead of a per-leaf test or a CM_HeadnodeVisible walk for entities spanning more than MAX_ENT_LEAFS leafs
+// - fat PVS/PAS rows keyed by the set of leafs within 8 units of the view origin. Vis data doesn't change during a map,
+//   so entries never go stale until the next SV_SpawnServer
+cvar_t sv_vis_maxmem = { "sv_vis_maxmem", "16", 0, 0.0f, NULL }; // megabytes
+
+unsigned char *sv_leafmasks;
+entleafmask_t *sv_leafmaskinfo;
+int sv_leafmaskbytes;
+fatsetcache_t sv_fatpvscache;
+fatsetcache_t sv_fatpascache;
+
+void SV_CollectFatLeafs(vec_t *org, mnode_t *node, fatsetkey_t *key, qboolean pas)
+{
+	// same traversal as SV_AddToFatPVS/SV_AddToFatPAS
+	while (node->contents >= 0)
+	{
+		int sides = SV_FatSetSides(org, node, pas);
+		if (sides == FATSET_BOTH)
+		{
+			SV_CollectFatLeafs(org, node->children[0], key, pas);
+			node = node->children[1];
+		}
+		else
+		{
+			node = node->children[sides == FATSET_BACK];
+		}
+	}
+
+	if (node->contents == CONTENTS_SOLID)
+		return;
+
+	if (key->numleafs < FATSET_MAXLEAFS)
+		key->leafnums[key->numleafs] = (mleaf_t *)node - g_psv.worldmodel->leafs;
+
+	// overflow is detected by the caller
+	key->numleafs++;
+}
+
+qboolean SV_FatSetFromCache(fatsetcache_t *cache, vec_t *org, unsigned char *out, int bytes, qboolean pas)
+{
+	fatsetkey_t *key = &cache->pending;
+
+	cache->pendingslot = -1;
+	if (!cache->rows || bytes > cache->rowbytes)
+		return FALSE;
+
+	key->numleafs = 0;
+	SV_CollectFatLeafs(org, g_psv.worldmodel->nodes, key, pas);
+	if (key->numleafs > FATSET_MAXLEAFS)
+		return FALSE;
+
+	unsigned int hash = key->numleafs;
+	for (int i = 0; i < key->numleafs; i++)
+		hash = hash * 31 + key->leafnums[i];
+
+	int slot = hash & (FATSET_CACHE_SIZE - 1);
+	fatsetkey_t *entry = &cache->keys[slot];
+	if (entry->numleafs == key->numleafs && !Q_memcmp(entry->leafnums, key->leafnums, key->numleafs * sizeof(int)))
+	{
+		cache->hits++;
+		Q_memcpy(out, &cache->rows[slot * cache->rowbytes], bytes);
+		return TRUE;
+	}
+
+	cache->misses++;
+	cache->pendingslot = slot;
+	return FALSE;
+}
+
+void SV_FatSetToCache(fatsetcache_t *cache, const unsigned char *set, int bytes)
+{
+	int slot = cache->pendingslot;
+	if (slot < 0)
+		return;
+
+	cache->keys[slot] = cache->pending;
+	Q_memcpy(&cache->rows[slot * cache->rowbytes], set, bytes);
+	cache->pendingslot = -1;
+}
+
+void SV_SetLeafMaskBit(unsigned char *mask, entleafmask_t *info, int leafnum)
+{
+	int byte = leafnum >> 3;
+
+	mask[byte] |= 1 << (leafnum & 7);
+	if (byte < info->firstbyte)
+		info->firstbyte = byte;
+	if (byte >= info->endbyte)
+		info->endbyte = byte + 1;
+}
+
+void SV_SetHeadnodeLeafMask(mnode_t *node, unsigned char *mask, entleafmask_t *info)
+{
+	// every leaf CM_HeadnodeVisible could report for this headnode
+	mleaf_t *leaf = (mleaf_t *)node;
+	while (leaf && leaf->contents != CONTENTS_SOLID)
+	{
+		if (leaf->contents < 0)
+		{
+			SV_SetLeafMaskBit(mask, info, leaf - g_psv.worldmodel->leafs - 1);
+			return;
+		}
+
+		SV_SetHeadnodeLeafMask(((mnode_t *)leaf)->children[0], mask, info);
+		leaf = (mleaf_t *)((mnode_t *)leaf)->children[1];
+	}
+}
+
+void SV_BuildLeafMask(edict_t *ent)
+{
+	if (!sv_leafmasks)
+		return;
+
+	int e = ent - g_psv.edicts;
+	unsigned char *mask = &sv_leafmasks[e * sv_leafmaskbytes];
+	entleafmask_t *info = &sv_leafmaskinfo[e];
+
+	if (info->endbyte > info->firstbyte)
+		Q_memset(&mask[info->firstbyte], 0, info->endbyte - info->firstbyte);
+
+	info->valid = TRUE;
+	info->headnode = ent->headnode;
+	info->firstbyte = sv_leafmaskbytes;
+	info->endbyte = 0;
+
+	if (ent->headnode < 0)
+	{
+		for (int i = 0; i < ent->num_leafs; i++)
+			SV_SetLeafMaskBit(mask, info, ent->leafnums[i]);
+	}
+	else
+	{
+		SV_SetHeadnodeLeafMask(&g_psv.worldmodel->nodes[ent->headnode], mask, info);
+	}
+}
+
+// Returns first leaf set in both the entity mask and pset, -1 if there's none
+int SV_LeafMaskVisible(const unsigned char *mask, const entleafmask_t *info, const unsigned char *pset)
+{
+	int i = info->firstbyte;
+	int end = info->endbyte;
+
+	for (; i + 16 <= end; i += 16)
+	{
+		__m128i v = _mm_and_si128(_mm_loadu_si128((const __m128i *)&mask[i]), _mm_loadu_si128((const __m128i *)&pset[i]));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) != 0xFFFF)
+			break;
+	}
+
+	for (; i < end; i++)
+	{
+		int bits = mask[i] & pset[i];
+		if (bits)
+		{
+			int bit = 0;
+			while (!(bits & (1 << bit)))
+				bit++;
+
+			return (i << 3) + bit;
+		}
+	}
+
+	return -1;
+}
+
+void SV_InitVisCache(void)
+{
+	sv_leafmasks = NULL;
+	sv_leafmaskinfo = NULL;
+	sv_leafmaskbytes = 0;
+	Q_memset(&sv_fatpvscache, 0, sizeof(sv_fatpvscache));
+	Q_memset(&sv_fatpascache, 0, sizeof(sv_fatpascache));
+
+	// singleplayer maps don't get decompressed vis from CM_CalcPAS
+	if (!gPVS || !gPAS)
+		return;
+
+	int rows = (g_psv.worldmodel->numleafs + 7) >> 3;
+	int fatrowbytes = (((g_psv.worldmodel->numleafs + 31) >> 3) + 15) & ~15;
+	int maskbytes = (rows + 15) & ~15;
+	int fatmem = 2 * FATSET_CACHE_SIZE * fatrowbytes;
+	int maskmem = g_psv.max_edicts * (maskbytes + (int)sizeof(entleafmask_t));
+	int maxmem = (int)(sv_vis_maxmem.value * 1024.0f * 1024.0f);
+
+	if (fatmem <= maxmem)
+	{
+		sv_fatpvscache.rowbytes = fatrowbytes;
+		sv_fatpvscache.rows = (unsigned char *)Hunk_AllocName(FATSET_CACHE_SIZE * fatrowbytes, "fatpvs");
+		sv_fatpascache.rowbytes = fatrowbytes;
+		sv_fatpascache.rows = (unsigned char *)Hunk_AllocName(FATSET_CACHE_SIZE * fatrowbytes, "fatpas");
+		maxmem -= fatmem;
+	}
+
+	if (maskmem <= maxmem)
+	{
+		sv_leafmaskbytes = maskbytes;
+		sv_leafmasks = (unsigned char *)Hunk_AllocName(g_psv.max_edicts * maskbytes, "leafmasks");
+		sv_leafmaskinfo = (entleafmask_t *)Hunk_AllocName(g_psv.max_edicts * sizeof(entleafmask_t), "leafmasks");
+	}
+	else
+	{
+		Con_DPrintf("%s: leaf masks need %i bytes, over sv_vis_maxmem; disabled for this map\n", __FUNCTION__, maskmem);
+	}
+}
+
+void SV_VisStats_f(void)
+{
+	fatsetcache_t *caches[] = { &sv_fatpvscache, &sv_fatpascache };
+	const char *names[] = { "PVS", "PAS" };
+
+	if (!g_psv.active)
+	{
+		Con_Printf("Server is not active\n");
+		return;
+	}
+
+	if (sv_leafmasks)
+		Con_Printf("Leaf masks: %i edicts x %i bytes, %i bytes total\n", g_psv.max_edicts, sv_leafmaskbytes, g_psv.max_edicts * (sv_leafmaskbytes + (int)sizeof(entleafmask_t)));
+	else
+		Con_Printf("Leaf masks: disabled\n");
+
+	for (int i = 0; i < ARRAYSIZE(caches); i++)
+	{
+		fatsetcache_t *cache = caches[i];
+		unsigned int total = cache->hits + cache->misses;
+		if (!cache->rows)
+		{
+			Con_Printf("Fat %s cache: disabled\n", names[i]);
+			continue;
+		}
+
+		Con_Printf("Fat %s cache: %i bytes, hits: %u, misses: %u, hit rate: %.1f%%\n", names[i], FATSET_CACHE_SIZE * cache->rowbytes,
+			cache->hits, cache->misses, total ? cache->hits * 100.0 / total : 0.0);
+	}
+}
+#endif // REHLDS_OPT_PEDANTIC
+
 /* <a6c4c> ../engine/sv_main.c:5304 */
 int SV_PointLeafnum(vec_t *p)
 {
@@ -4110,6 +4655,9 @@ int SV_FindBestBaseline(int index, entity_state_t ** baseline, entity_state_t *t
 	}
 
 	bestbitnumber = DELTA_TestDelta((byte *)*baseline, (byte *)&to[index], delta);
+#ifdef REHLDS_OPT_PEDANTIC
+	int defaultbitnumber = bestbitnumber;
+#endif // REHLDS_OPT_PEDANTIC
 	bestbitnumber -= 6;
 
 	int i = 0;
@@ -4133,6 +4681,12 @@ int SV_FindBestBaseline(int index, entity_state_t ** baseline, entity_state_t *t
 	if (index != bestfound)
 		*baseline = &to[bestfound];
 
+#ifdef REHLDS_OPT_PEDANTIC
+	// The offset to the better baseline costs 6 more bits
+	if (sv_delta_stats.value != 0.0f)
+		DELTA_StatsBaseline(delta, index != bestfound ? defaultbitnumber - (bestbitnumber + 6) : 0);
+#endif // REHLDS_OPT_PEDANTIC
+
 	return index - bestfound;
 }
 
@@ -4203,7 +4757,14 @@ int SV_CreatePacketEntities(sv_delta_t type, client_t *client, packet_entities_t
 			entity_state_t *baseline_ = &to->entities[newnum];
 			qboolean custom = baseline_->entityType & 0x2 ? TRUE : FALSE;
 			SV_SetCallback(newindex, FALSE, custom, &numbase, FALSE, 0);
+#ifdef REHLDS_OPT_PEDANTIC
+			int statsStart = sv_delta_stats.value != 0.0f ? MSG_BitsWritten() : -1;
+			qboolean sent = DELTA_WriteDelta((uint8 *)&from->entities[oldnum], (uint8 *)baseline_, FALSE, custom ? g_pcustomentitydelta : (SV_IsPlayerIndex(newindex) ? g_pplayerdelta : g_pentitydelta), &SV_InvokeCallback);
+			if (statsStart != -1)
+				DELTA_StatsEntity(newindex, MSG_BitsWritten() - statsStart, !sent);
+#else // REHLDS_OPT_PEDANTIC
 			DELTA_WriteDelta((uint8 *)&from->entities[oldnum], (uint8 *)baseline_, FALSE, custom ? g_pcustomentitydelta : (SV_IsPlayerIndex(newindex) ? g_pplayerdelta : g_pentitydelta), &SV_InvokeCallback);
+#endif // REHLDS_OPT_PEDANTIC
 			++oldnum;
 			_mm_prefetch((const char*)&from->entities[oldnum], _MM_HINT_T0);
 			_mm_prefetch(((const char*)&from->entities[oldnum]) + 64, _MM_HINT_T0);
@@ -4266,10 +4827,15 @@ int SV_CreatePacketEntities(sv_delta_t type, client_t *client, packet_entities_t
 
 
 		delta_t* delta = custom ? g_pcustomentitydelta : (SV_IsPlayerIndex(newindex) ? g_pplayerdelta : g_pentitydelta);
+		qboolean sent;
+
+#ifdef REHLDS_OPT_PEDANTIC
+		int statsStart = sv_delta_stats.value != 0.0f ? MSG_BitsWritten() : -1;
+#endif // REHLDS_OPT_PEDANTIC
 
 		// fix for https://github.com/dreamstalker/rehlds/issues/24
 #ifdef REHLDS_FIXES
-		DELTA_WriteDeltaForceMask(
+		sent = DELTA_WriteDeltaForceMask(
 			(uint8 *)baseline_,
 			(uint8 *)&to->entities[newnum],
 			TRUE,
@@ -4288,7 +4854,7 @@ int SV_CreatePacketEntities(sv_delta_t type, client_t *client, packet_entities_t
 		
 		
 #else //REHLDS_FIXES
-		DELTA_WriteDelta(
+		sent = DELTA_WriteDelta(
 			(uint8 *)baseline_,
 			(uint8 *)&to->entities[newnum],
 			TRUE,
@@ -4297,6 +4863,11 @@ int SV_CreatePacketEntities(sv_delta_t type, client_t *client, packet_entities_t
 			);
 #endif //REHLDS_FIXES
 
+#ifdef REHLDS_OPT_PEDANTIC
+		if (statsStart != -1)
+			DELTA_StatsEntity(newindex, MSG_BitsWritten() - statsStart, !sent);
+#endif // REHLDS_OPT_PEDANTIC
+
 		++newnum;
 		
 	}
@@ -4309,7 +4880,15 @@ int SV_CreatePacketEntities(sv_delta_t type, client_t *client, packet_entities_t
 /* <a906b> ../engine/sv_main.c:5685 */
 void SV_EmitPacketEntities(client_t *client, packet_entities_t *to, sizebuf_t *msg)
 {
+#ifdef REHLDS_OPT_PEDANTIC
+	int start = msg->cursize;
+#endif // REHLDS_OPT_PEDANTIC
+
 	SV_CreatePacketEntities(client->delta_sequence == -1 ? sv_packet_nodelta : sv_packet_delta, client, to, msg);
+
+#ifdef REHLDS_OPT_PEDANTIC
+	g_MetricsNet.entityBytes += msg->cursize - start;
+#endif // REHLDS_OPT_PEDANTIC
 }
 
 /* <a90cc> ../engine/sv_main.c:5708 */
@@ -4375,6 +4954,39 @@ int EXT_FUNC SV_CheckVisibility(edict_t *entity, unsigned char *pset)
 	if (!pset)
 		return 1;
 
+#ifdef REHLDS_OPT_PEDANTIC
+	if (sv_leafmasks)
+	{
+		int e = entity - g_psv.edicts;
+		entleafmask_t *info = &sv_leafmaskinfo[e];
+		if (info->valid && info->headnode == entity->headnode)
+		{
+			if (entity->headnode < 0)
+				return SV_LeafMaskVisible(&sv_leafmasks[e * sv_leafmaskbytes], info, pset) != -1 ? 1 : 0;
+
+			for (int i = 0; i < 48; i++)
+			{
+				leaf = entity->leafnums[i];
+				if (leaf == -1)
+					break;
+
+				if (pset[leaf >> 3] & (1 << (leaf & 7)))
+					return 1;
+			}
+
+			leaf = SV_LeafMaskVisible(&sv_leafmasks[e * sv_leafmaskbytes], info, pset);
+			if (leaf != -1)
+			{
+				entity->leafnums[entity->num_leafs] = leaf;
+				entity->num_leafs = (entity->num_leafs + 1) % 48;
+				return 2;
+			}
+
+			return 0;
+		}
+	}
+#endif // REHLDS_OPT_PEDANTIC
+
 	if (entity->headnode < 0)
 	{
 		for (int i = 0; i < entity->num_leafs; i++)
@@ -4436,7 +5048,8 @@ void SV_EmitPings(client_t *client, sizebuf_t *msg)
 /* <a947b> ../engine/sv_main.c:5878 */
 void SV_WriteEntitiesToClient(client_t *client, sizebuf_t *msg)
 {
-	
+	FRAME_PROFILE_SCOPE(FPROF_WRITEENTITIES);
+
 	client_frame_t *frame = &client->frames[SV_UPDATE_MASK & client->netchan.outgoing_sequence];
 
 	unsigned char *pvs = NULL;
@@ -4507,7 +5120,10 @@ void SV_WriteEntitiesToClient(client_t *client, sizebuf_t *msg)
 		Q_memcpy(pack->entities, fullpack.entities, sizeof(entity_state_t) * pack->num_entities);
 #endif
 
-	SV_EmitPacketEntities(client, pack, msg);
+	{
+		FRAME_PROFILE_SCOPE(FPROF_DELTAENCODE);
+		SV_EmitPacketEntities(client, pack, msg);
+	}
 	SV_EmitEvents(client, pack, msg);
 	if (sendping)
 		SV_EmitPings(client, msg);
@@ -4764,6 +5380,10 @@ void SV_SendClientMessages(void)
 			if (!Netchan_CanPacket(&cl->netchan))
 			{
 				++cl->chokecount;
+#ifdef REHLDS_OPT_PEDANTIC
+				if (i < REHLDS_METRICS_MAX_CLIENTS)
+					g_MetricsChoked[i]++;
+#endif // REHLDS_OPT_PEDANTIC
 				continue;
 			}
 
@@ -4778,6 +5398,32 @@ void SV_SendClientMessages(void)
 	SV_CleanupEnts();
 }
 
+#ifdef REHLDS_OPT_PEDANTIC
+// Parsed views of the clients' userinfo and physinfo
+infocache_t g_ClientInfoCache[MAX_CLIENTS][2];
+#endif // REHLDS_OPT_PEDANTIC
+
+const char *SV_ClientInfoValueForKey(const char *s, const char *key)
+{
+#ifdef REHLDS_OPT_PEDANTIC
+	client_t *clients = g_psvs.clients;
+	if (clients && s >= (const char *)clients && s < (const char *)&clients[g_psvs.maxclients])
+	{
+		int index = ((const byte *)s - (const byte *)clients) / sizeof(client_t);
+		if (index < MAX_CLIENTS)
+		{
+			if (s == clients[index].userinfo)
+				return Info_CachedValueForKey(&g_ClientInfoCache[index][0], s, key);
+
+			if (s == clients[index].physinfo)
+				return Info_CachedValueForKey(&g_ClientInfoCache[index][1], s, key);
+		}
+	}
+#endif // REHLDS_OPT_PEDANTIC
+
+	return Info_ValueForKey(s, key);
+}
+
 /* <a976e> ../engine/sv_main.c:6307 */
 void SV_ExtractFromUserinfo(client_t *cl)
 {
@@ -4788,7 +5434,7 @@ void SV_ExtractFromUserinfo(client_t *cl)
 
 	char *userinfo = cl->userinfo;
 
-	val = Info_ValueForKey(userinfo, "name");
+	val = SV_ClientInfoValueForKey(userinfo, "name");
 	Q_strncpy(rawname, val, sizeof(rawname) - 1);
 	rawname[sizeof(rawname) - 1] = 0;
 
@@ -4832,32 +5478,32 @@ void SV_ExtractFromUserinfo(client_t *cl)
 
 	gEntityInterface.pfnClientUserInfoChanged(cl->edict, userinfo);
 
-	val = Info_ValueForKey(userinfo, "name");
+	val = SV_ClientInfoValueForKey(userinfo, "name");
 	Q_strncpy(cl->name, val, sizeof(cl->name) - 1);
 	cl->name[sizeof(cl->name) - 1] = 0;
 
 	ISteamGameServer_BUpdateUserData(cl->network_userid.m_SteamID, cl->name, 0);
 
-	val = Info_ValueForKey(userinfo, "rate");
+	val = SV_ClientInfoValueForKey(userinfo, "rate");
 	if (val[0] != 0)
 	{
 		i = Q_atoi(val);
 		cl->netchan.rate = clamp(i, MIN_RATE, MAX_RATE);
 	}
 
-	val = Info_ValueForKey(userinfo, "topcolor");
+	val = SV_ClientInfoValueForKey(userinfo, "topcolor");
 	if (val[0] != 0)
 		cl->topcolor = Q_atoi(val);
 	else
 		Con_DPrintf("topcolor unchanged for %s\n", cl->name);
 
-	val = Info_ValueForKey(userinfo, "bottomcolor");
+	val = SV_ClientInfoValueForKey(userinfo, "bottomcolor");
 	if (val[0] != 0)
 		cl->bottomcolor = Q_atoi(val);
 	else
 		Con_DPrintf("bottomcolor unchanged for %s\n", cl->name);
 
-	val = Info_ValueForKey(userinfo, "cl_updaterate");
+	val = SV_ClientInfoValueForKey(userinfo, "cl_updaterate");
 	if (val[0] != 0)
 	{
 		i = Q_atoi(val);
@@ -4867,13 +5513,13 @@ void SV_ExtractFromUserinfo(client_t *cl)
 			cl->next_messageinterval = 0.1;
 	}
 
-	val = Info_ValueForKey(userinfo, "cl_lw");
+	val = SV_ClientInfoValueForKey(userinfo, "cl_lw");
 	cl->lw = val[0] != 0 ? Q_atoi(val) != 0 : 0;
 
-	val = Info_ValueForKey(userinfo, "cl_lc");
+	val = SV_ClientInfoValueForKey(userinfo, "cl_lc");
 	cl->lc = val[0] != 0 ? Q_atoi(val) != 0 : 0;
 
-	val = Info_ValueForKey(userinfo, "*hltv");
+	val = SV_ClientInfoValueForKey(userinfo, "*hltv");
 	cl->proxy = val[0] != 0 ? Q_atoi(val) == 1 : 0;
 
 	SV_CheckUpdateRate(&cl->next_messageinterval);
@@ -5317,6 +5963,65 @@ void SetCStrikeFlags(void)
 	}
 }
 
+#ifdef REHLDS_OPT_PEDANTIC
+static const char *sv_maploadphases[MAPLOAD_MAX_PHASES];
+static double sv_maploadtimes[MAPLOAD_MAX_PHASES];
+static int sv_nummaploadphases;
+static double sv_maploadstart;
+static double sv_maploadlast;
+static char sv_maploadname[64];
+
+void SV_MapLoadTimingBegin(void)
+{
+	sv_nummaploadphases = 0;
+	sv_maploadstart = sv_maploadlast = Sys_FloatTime();
+	sv_maploadname[0] = 0;
+}
+
+// Closes the phase that started at the previous mark
+void SV_MapLoadPhase(const char *name)
+{
+	double now = Sys_FloatTime();
+	if (sv_nummaploadphases < MAPLOAD_MAX_PHASES)
+	{
+		sv_maploadphases[sv_nummaploadphases] = name;
+		sv_maploadtimes[sv_nummaploadphases] = now - sv_maploadlast;
+		sv_nummaploadphases++;
+	}
+
+	sv_maploadlast = now;
+}
+
+void SV_MapLoadTimingEnd(void)
+{
+	Q_strncpy(sv_maploadname, g_psv.name, sizeof(sv_maploadname) - 1);
+	sv_maploadname[sizeof(sv_maploadname) - 1] = 0;
+	Con_DPrintf("Map %s loaded in %.1f ms\n", sv_maploadname, (sv_maploadlast - sv_maploadstart) * 1000.0);
+}
+
+void SV_MapLoadTimes_f(void)
+{
+	if (!sv_maploadname[0])
+	{
+		Con_Printf("No map has been loaded yet\n");
+		return;
+	}
+
+	double total = sv_maploadlast - sv_maploadstart;
+	Con_Printf("Map %s load breakdown:\n", sv_maploadname);
+	for (int i = 0; i < sv_nummaploadphases; i++)
+	{
+		Con_Printf("  %-18s %8.2f ms  %5.1f%%\n", sv_maploadphases[i], sv_maploadtimes[i] * 1000.0,
+			total > 0.0 ? sv_maploadtimes[i] * 100.0 / total : 0.0);
+	}
+
+	unsigned int hits, misses;
+	FileHash_Stats(&hits, &misses);
+	Con_Printf("  %-18s %8.2f ms\n", "total", total * 1000.0);
+	Con_Printf("File hash cache: hits: %u, misses: %u\n", hits, misses);
+}
+#endif // REHLDS_OPT_PEDANTIC
+
 /* <a9f01> ../engine/sv_main.c:7107 */
 void SV_ActivateServer(int runPhysics)
 {
@@ -5340,6 +6045,9 @@ void SV_ActivateServer(int runPhysics)
 	ContinueLoadingProgressBar("Server", 8, 0.0f);
 	gEntityInterface.pfnServerActivate(g_psv.edicts, g_psv.num_edicts, g_psvs.maxclients);
 	Steam_Activate();
+#ifdef REHLDS_OPT_PEDANTIC
+	SV_MapLoadPhase("server activate");
+#endif // REHLDS_OPT_PEDANTIC
 	ContinueLoadingProgressBar("Server", 9, 0.0f);
 	SV_CreateGenericResources();
 	g_psv.active = TRUE;
@@ -5366,9 +6074,19 @@ void SV_ActivateServer(int runPhysics)
 				SV_Physics();
 		}
 	}
+#ifdef REHLDS_OPT_PEDANTIC
+	SV_MapLoadPhase("physics");
+	SV_CreateBaseline();
+	SV_MapLoadPhase("baseline");
+	SV_CreateResourceList();
+	SV_MapLoadPhase("resource list");
+	g_psv.num_consistency = SV_TransferConsistencyInfo();
+	SV_MapLoadPhase("consistency hash");
+#else // REHLDS_OPT_PEDANTIC
 	SV_CreateBaseline();
 	SV_CreateResourceList();
 	g_psv.num_consistency = SV_TransferConsistencyInfo();
+#endif // REHLDS_OPT_PEDANTIC
 	for (i = 0, cl = g_psvs.clients; i < g_psvs.maxclients; cl++, i++)
 	{
 		if (!cl->fakeclient && (cl->active || cl->connected))
@@ -5396,6 +6114,10 @@ void SV_ActivateServer(int runPhysics)
 		}
 	}
 	HPAK_FlushHostQueue();
+#ifdef REHLDS_OPT_PEDANTIC
+	SV_MapLoadPhase("reconnect clients");
+	SV_MapLoadTimingEnd();
+#endif // REHLDS_OPT_PEDANTIC
 	if (g_psvs.maxclients <= 1)
 		Con_DPrintf("Game Started\n");
 	else
@@ -5431,6 +6153,10 @@ int SV_SpawnServer(qboolean bIsDemo, char *server, char *startspot)
 	char *pszhost;
 	char oldname[64];
 
+#ifdef REHLDS_OPT_PEDANTIC
+	SV_MapLoadTimingBegin();
+#endif // REHLDS_OPT_PEDANTIC
+
 	if (g_psv.active)
 	{
 		cl = g_psvs.clients;
@@ -5491,6 +6217,9 @@ int SV_SpawnServer(qboolean bIsDemo, char *server, char *startspot)
 	ContinueLoadingProgressBar("Server", 2, 0.0f);
 
 	HPAK_CheckSize("custom");
+#ifdef REHLDS_OPT_PEDANTIC
+	HPAK_StartCompaction("custom");
+#endif // REHLDS_OPT_PEDANTIC
 	oldname[0] = 0;
 	Q_strncpy(oldname, g_psv.name, sizeof(oldname) - 1);
 	oldname[sizeof(oldname) - 1] = 0;
@@ -5505,9 +6234,13 @@ int SV_SpawnServer(qboolean bIsDemo, char *server, char *startspot)
 
 	SV_AllocClientFrames();
 	Q_memset(&g_psv, 0, sizeof(server_t));
+#ifdef REHLDS_OPT_PEDANTIC
+	SV_MapLoadPhase("clear memory");
+#endif // REHLDS_OPT_PEDANTIC
 
 #ifdef REHLDS_OPT_PEDANTIC
 	g_rehlds_sv.modelsMap.clear();
+	Netchan_FlushCompressionCache();
 #endif
 
 	Q_strncpy(g_psv.oldname, oldname, sizeof(oldname) - 1);
@@ -5588,13 +6321,20 @@ int SV_SpawnServer(qboolean bIsDemo, char *server, char *startspot)
 	}
 
 	Sequence_OnLevelLoad(server);
+#ifdef REHLDS_OPT_PEDANTIC
+	SV_MapLoadPhase("world model");
+#endif // REHLDS_OPT_PEDANTIC
 	ContinueLoadingProgressBar("Server", 4, 0.0);
 	if (gmodinfo.clientDllCRC)
 	{
 		char szDllName[64];
 		Q_snprintf(szDllName, sizeof(szDllName), "cl_dlls//client.dll");
 		COM_FixSlashes(szDllName);
+#ifdef REHLDS_OPT_PEDANTIC
+		if (!MD5_Hash_FileCached(g_psv.clientdllmd5, szDllName))
+#else // REHLDS_OPT_PEDANTIC
 		if (!MD5_Hash_File(g_psv.clientdllmd5, szDllName, FALSE, FALSE, NULL))
+#endif // REHLDS_OPT_PEDANTIC
 		{
 			Con_Printf("Couldn't CRC client side dll:  %s\n", szDllName);
 			g_psv.active = FALSE;
@@ -5602,21 +6342,36 @@ int SV_SpawnServer(qboolean bIsDemo, char *server, char *startspot)
 		}
 	}
 	ContinueLoadingProgressBar("Server", 6, 0.0);
+#ifdef REHLDS_OPT_PEDANTIC
+	SV_MapLoadPhase("client dll hash");
+#endif // REHLDS_OPT_PEDANTIC
 
 	if (g_psvs.maxclients <= 1)
 		g_psv.worldmapCRC = 0;
 	else
 	{
+#ifdef REHLDS_OPT_PEDANTIC
+		if (!CRC_MapFileCached(&g_psv.worldmapCRC, g_psv.modelname))
+#else // REHLDS_OPT_PEDANTIC
 		CRC32_Init(&g_psv.worldmapCRC);
 		if (!CRC_MapFile(&g_psv.worldmapCRC, g_psv.modelname))
+#endif // REHLDS_OPT_PEDANTIC
 		{
 			Con_Printf("Couldn't CRC server map:  %s\n", g_psv.modelname);
 			g_psv.active = FALSE;
 			return 0;
 		}
+#ifdef REHLDS_OPT_PEDANTIC
+		SV_MapLoadPhase("map crc");
+#endif // REHLDS_OPT_PEDANTIC
 		CM_CalcPAS(g_psv.worldmodel);
 	}
 
+#ifdef REHLDS_OPT_PEDANTIC
+	SV_InitVisCache();
+	SV_MapLoadPhase("pvs/pas");
+#endif // REHLDS_OPT_PEDANTIC
+
 	g_psv.models[1] = g_psv.worldmodel;
 	SV_ClearWorld();
 	g_psv.model_precache_flags[1] |= RES_FATALIFMISSING;
@@ -5666,6 +6421,9 @@ int SV_SpawnServer(qboolean bIsDemo, char *server, char *startspot)
 	allow_cheats = sv_cheats.value;
 	SV_SetMoveVars();
 
+#ifdef REHLDS_OPT_PEDANTIC
+	SV_MapLoadPhase("submodels");
+#endif // REHLDS_OPT_PEDANTIC
 	return 1;
 }
 
@@ -5673,6 +6431,9 @@ int SV_SpawnServer(qboolean bIsDemo, char *server, char *startspot)
 void SV_LoadEntities(void)
 {
 	ED_LoadFromFile(g_psv.worldmodel->entities);
+#ifdef REHLDS_OPT_PEDANTIC
+	SV_MapLoadPhase("entities");
+#endif // REHLDS_OPT_PEDANTIC
 }
 
 /* <aa17f> ../engine/sv_main.c:7592 */
@@ -6803,22 +7564,48 @@ void SV_Frame(void)
 	if (!g_psv.active)
 		return;
 
+#ifdef REHLDS_OPT_PEDANTIC
+	int64 frameStart = (g_FrameProfileActive || g_MetricsActive) ? FrameProfile_Now() : 0;
+#endif // REHLDS_OPT_PEDANTIC
+
 	gGlobalVariables.frametime = host_frametime;
 	g_psv.oldtime = g_psv.time;
 	SV_CheckCmdTimes();
-	SV_ReadPackets();
+	{
+		FRAME_PROFILE_SCOPE(FPROF_READPACKETS);
+		SV_ReadPackets();
+	}
 	if (SV_IsSimulating())
 	{
-		SV_Physics();
+		{
+			FRAME_PROFILE_SCOPE(FPROF_PHYSICS);
+			SV_Physics();
+		}
 		g_psv.time += host_frametime;
 	}
 	SV_QueryMovevarsChanged();
 	SV_RequestMissingResourcesFromClients();
 	SV_CheckTimeouts();
-	SV_SendClientMessages();
+	{
+		FRAME_PROFILE_SCOPE(FPROF_SENDMESSAGES);
+		SV_SendClientMessages();
+	}
 	SV_CheckMapDifferences();
 	SV_GatherStatistics();
-	Steam_RunFrame();
+	{
+		FRAME_PROFILE_SCOPE(FPROF_STEAM);
+		Steam_RunFrame();
+	}
+#ifdef REHLDS_OPT_PEDANTIC
+	SV_TraceCacheFrameEnd();
+
+	int64 frameEnd = frameStart ? FrameProfile_Now() : 0;
+	if (frameStart && g_FrameProfileActive)
+		FrameProfile_Record(FPROF_FRAME, frameStart, frameEnd);
+
+	DllProfile_Frame();
+	Metrics_Frame(frameEnd - frameStart);
+#endif // REHLDS_OPT_PEDANTIC
 }
 
 /* <a81ca> ../engine/sv_main.c:9252 */
@@ -7059,6 +7846,16 @@ void SV_Init(void)
 	Cvar_RegisterVariable(&sv_downloadurl);
 	Cvar_RegisterVariable(&sv_version);
 	Cvar_RegisterVariable(&sv_allow_dlfile);
+#ifdef REHLDS_OPT_PEDANTIC
+	SV_InitTraceCache();
+	Cvar_RegisterVariable(&sv_vis_maxmem);
+	Cvar_RegisterVariable(&sv_vis_diskcache);
+	Cvar_RegisterVariable(&sv_parallel_moves);
+	Cmd_AddCommand("sv_visstats", SV_VisStats_f);
+	Cmd_AddCommand("sv_maploadtimes", SV_MapLoadTimes_f);
+	Cvar_RegisterVariable(&sv_modelcache_mb);
+	Cmd_AddCommand("sv_modelcache_list", Mod_ResidentList_f);
+#endif // REHLDS_OPT_PEDANTIC
 
 	for (int i = 0; i < 512; i++)
 	{
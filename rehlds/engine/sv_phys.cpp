@@ -1362,7 +1362,10 @@ void SV_Physics_Step(edict_t *ent)
 void SV_Physics(void)
 {
 	gGlobalVariables.time = (float)g_psv.time;
-	gEntityInterface.pfnStartFrame();
+	{
+		FRAME_PROFILE_SCOPE(FPROF_STARTFRAME);
+		gEntityInterface.pfnStartFrame();
+	}
 	for (int i = 0; i < g_psv.num_edicts; i++)
 	{
 		edict_t* ent = &g_psv.edicts[i];
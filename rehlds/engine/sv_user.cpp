@@ -36,6 +36,9 @@ typedef struct command_s
 
 sv_adjusted_positions_t truepositions[MAX_CLIENTS];
 qboolean g_balreadymoved;
+#ifdef REHLDS_OPT_PEDANTIC
+predecodedmove_t *sv_predecodedmove;	// of the packet SV_ReadPackets is handing to SV_ExecuteClientMessage
+#endif // REHLDS_OPT_PEDANTIC
 
 float s_LastFullUpdate[33];
 
@@ -263,11 +266,112 @@ qboolean SV_FileInConsistencyList(const char *filename, consistency_t **ppconsis
 	return 0;
 }
 
+#ifdef REHLDS_OPT_PEDANTIC
+typedef struct prehashjob_s
+{
+	char localpath[MAX_PATH];
+	unsigned char digest[16];
+	BOOL ok;
+	filehash_t *cached;
+	resource_t *res;
+} prehashjob_t;
+
+static void SV_PrehashWorker(void *arg, int first, int last, int)
+{
+	prehashjob_t *jobs = (prehashjob_t *)arg;
+	for (int i = first; i < last; i++)
+		jobs[i].ok = MD5_Hash_LocalFile(jobs[i].digest, jobs[i].localpath);
+}
+
+static void SV_ConsistencyFileName(resource_t *r, char *filename)
+{
+	if (r->type != t_sound)
+	{
+		Q_strncpy(filename, r->szFileName, MAX_PATH - 1);
+		filename[MAX_PATH - 1] = 0;
+	}
+	else
+	{
+		Q_snprintf(filename, MAX_PATH, "sound/%s", r->szFileName);
+	}
+}
+
+// Hashes the files that SV_TransferConsistencyInfo is about to check.
+// Unchanged files come from the hash cache, loose files are hashed on worker threads,
+// the rest (files in paks or GAMECONFIG overrides) are left to the serial path.
+// Marks resources that already have their digest in 'hashed'
+static void SV_PrehashConsistencyFiles(qboolean *hashed)
+{
+	prehashjob_t *jobs = (prehashjob_t *)Mem_Malloc(g_psv.num_resources * sizeof(prehashjob_t));
+	int numjobs = 0;
+
+	for (int i = 0; i < g_psv.num_resources; i++)
+	{
+		resource_t *r = &g_psv.resourcelist[i];
+		if (r->ucFlags == (RES_CUSTOM | RES_REQUESTED | RES_UNK_6) || (r->ucFlags & RES_CHECKFILE))
+			continue;
+
+		if (!SV_FileInConsistencyList(r->szFileName, NULL))
+			continue;
+
+		char filename[MAX_PATH];
+		SV_ConsistencyFileName(r, filename);
+
+		qboolean upToDate;
+		filehash_t *h = FileHash_Lookup(filename, FILEHASH_MD5, &upToDate);
+		if (upToDate)
+		{
+			Q_memcpy(r->rgucMD5_hash, FileHash_MD5(h), sizeof(r->rgucMD5_hash));
+			hashed[i] = TRUE;
+			continue;
+		}
+
+		// MD5_Hash_File prefers GAMECONFIG, keep its lookup order for those
+		FileHandle_t fp = FS_OpenPathID(filename, "rb", "GAMECONFIG");
+		if (fp)
+		{
+			FS_Close(fp);
+			continue;
+		}
+
+		prehashjob_t *job = &jobs[numjobs];
+		if (!FS_GetLocalPath(filename, job->localpath, sizeof(job->localpath)))
+			continue;
+
+		job->ok = FALSE;
+		job->cached = h;
+		job->res = r;
+		numjobs++;
+	}
+
+	Sys_ParallelFor(numjobs, 1, SV_PrehashWorker, jobs);
+
+	for (int i = 0; i < numjobs; i++)
+	{
+		prehashjob_t *job = &jobs[i];
+		if (!job->ok)
+			continue;
+
+		Q_memcpy(job->res->rgucMD5_hash, job->digest, sizeof(job->digest));
+		FileHash_StoreMD5(job->cached, job->digest);
+		hashed[job->res - g_psv.resourcelist] = TRUE;
+	}
+
+	Mem_Free(jobs);
+}
+#endif // REHLDS_OPT_PEDANTIC
+
 /* <bf9a8> ../engine/sv_user.c:298 */
 int SV_TransferConsistencyInfo(void)
 {
 	consistency_t *pc;
 
+#ifdef REHLDS_OPT_PEDANTIC
+	qboolean hashed[ARRAYSIZE(g_psv.resourcelist)];
+	Q_memset(hashed, 0, sizeof(hashed));
+	SV_PrehashConsistencyFiles(hashed);
+#endif // REHLDS_OPT_PEDANTIC
+
 	int c = 0;
 	for (int i = 0; i < g_psv.num_resources; i++)
 	{
@@ -281,6 +385,11 @@ int SV_TransferConsistencyInfo(void)
 		r->ucFlags |= RES_CHECKFILE;
 
 		char filename[MAX_PATH];
+#ifdef REHLDS_OPT_PEDANTIC
+		SV_ConsistencyFileName(r, filename);
+		if (!hashed[i])
+			MD5_Hash_FileCached(r->rgucMD5_hash, filename);
+#else // REHLDS_OPT_PEDANTIC
 		if (r->type != t_sound)
 		{
 			Q_strncpy(filename, r->szFileName, MAX_PATH - 1);
@@ -291,6 +400,7 @@ int SV_TransferConsistencyInfo(void)
 			Q_snprintf(filename, MAX_PATH, "sound/%s", r->szFileName);
 		}
 		MD5_Hash_File(r->rgucMD5_hash, filename, FALSE, FALSE, NULL);
+#endif // REHLDS_OPT_PEDANTIC
 
 		if (r->type == t_model)
 		{
@@ -631,6 +741,8 @@ void SV_AddLinksToPM(areanode_t *node, vec_t *origin)
 /* <bfd01> ../engine/sv_user.c:758 */
 void SV_PlayerRunPreThink(edict_t *player, float time)
 {
+	FRAME_PROFILE_SCOPE(FPROF_PRETHINK);
+
 	gGlobalVariables.time = time;
 	gEntityInterface.pfnPlayerPreThink(player);
 }
@@ -974,7 +1086,10 @@ void SV_RunCmd(usercmd_t *ucmd, int random_seed)
 	}
 	gGlobalVariables.time = (float)host_client->svtimebase;
 	gGlobalVariables.frametime = frametime;
-	gEntityInterface.pfnPlayerPostThink(sv_player);
+	{
+		FRAME_PROFILE_SCOPE(FPROF_POSTTHINK);
+		gEntityInterface.pfnPlayerPostThink(sv_player);
+	}
 	gEntityInterface.pfnCmdEnd(sv_player);
 
 	if (!host_client->fakeclient)
@@ -1472,22 +1587,186 @@ void SV_EstablishTimeBase(client_t *cl, usercmd_t *cmds, int dropped, int numbac
 	cl->svtimebase = host_frametime + g_psv.time - runcmd_time;
 }
 
-/* <bf48b> ../engine/sv_user.c:1835 */
-void SV_ParseMove(client_t *pSenderClient)
+// Decode stage of clc_move: unmunges the message, reads usercmd deltas and verifies the checksum.
+// Touches nothing but the message reading state of the calling thread, so all game facing work is left
+// to SV_ParseMove. With fieldbits set the usercmd delta stats are left there instead of counted
+movedecode_t SV_DecodeMove(int sequence, clientmove_t *move, int (*fieldbits)[2])
 {
-	client_frame_t *frame;
 	int placeholder;
 	int mlen;
 	unsigned int packetLossByte;
-	int numcmds;
 	int totalcmds;
-	byte cbpktchecksum;
-	usercmd_t *cmd;
-	usercmd_t cmds[64];
-	usercmd_t cmdNull;
-	float packet_loss;
 	byte cbchecksum;
+	usercmd_t cmdNull;
+
+	Q_memset(&cmdNull, 0, sizeof(cmdNull));
+
+	placeholder = msg_readcount + 1;
+	mlen = MSG_ReadByte();
+	cbchecksum = MSG_ReadByte();
+	COM_UnMunge(&net_message.data[placeholder + 1], mlen, sequence);
+
+	packetLossByte = MSG_ReadByte();
+	move->numbackup = MSG_ReadByte();
+	move->numcmds = MSG_ReadByte();
+
+	move->packet_loss = float(packetLossByte & 0x7F);
+	move->loopback = (packetLossByte >> 7) & 1;
+	totalcmds = move->numcmds + move->numbackup;
+	if (totalcmds < 0 || totalcmds >= 63)
+		return MOVEDECODE_TOOMANYCMDS;
+
+	usercmd_t* from = &cmdNull;
+	for (int i = totalcmds - 1; i >= 0; i--)
+	{
+#ifdef REHLDS_OPT_PEDANTIC
+		if (fieldbits)
+			DELTA_StatsDeferParse(fieldbits[i]);
+#endif // REHLDS_OPT_PEDANTIC
+		MSG_ReadUsercmd(&move->cmds[i], from);
+		from = &move->cmds[i];
+	}
+
+#ifdef REHLDS_OPT_PEDANTIC
+	if (fieldbits)
+		DELTA_StatsDeferParse(NULL);
+#endif // REHLDS_OPT_PEDANTIC
+
+	if (msg_badread)
+		return MOVEDECODE_BADREAD;
+
+	if (COM_BlockSequenceCRCByte(&net_message.data[placeholder + 1], msg_readcount - placeholder - 1, sequence) != cbchecksum)
+		return MOVEDECODE_BADCHECKSUM;
+
+	return MOVEDECODE_OK;
+}
+
+#ifdef REHLDS_OPT_PEDANTIC
+// MSG_ReadString without keeping the text, its static buffer isn't for worker threads
+static void SV_SkipString(void)
+{
+	int c, l = 0;
+	while ((c = MSG_ReadChar(), c) && c != -1 && l < 8191)
+		l++;
+}
+
+// Walks a queued client packet the way Netchan_Process and SV_ExecuteClientMessage would and decodes its clc_move.
+// Runs on worker threads with this thread's message reading state, so the caller saves the state it needs.
+// Gives up on fragments, netchan filters and commands it can't skip; the main thread decodes those moves itself
+void SV_PredecodeMove(const unsigned char *data, int size, predecodedmove_t *pre)
+{
+	// COM_UnMunge can run up to 255 bytes past the end of the message and the bit reader a few more
+	unsigned char buf[MAX_UDP_PACKET + 512];
+
+	pre->valid = FALSE;
+	if (size < 8 || size > MAX_UDP_PACKET)
+		return;
+
+	Q_memcpy(buf, data, size);
+	net_message.data = buf;
+	net_message.maxsize = sizeof(buf);
+	net_message.cursize = size;
+	net_message.flags = 0;
+	net_message.buffername = "predecode";
+
+	MSG_BeginReading();
+	unsigned int sequence = MSG_ReadLong();
+	unsigned int sequence_ack = MSG_ReadLong();
+	if ((sequence & (1 << 30)) || (sequence_ack & 0x40000000))
+		return;
+
+	COM_UnMunge2(&net_message.data[8], net_message.cursize - 8, sequence & 0xFF);
+	sequence &= ~(1 << 31);
+	sequence &= ~(1 << 30);
+
+	while (1)
+	{
+		if (msg_badread)
+			return;
+
+		int c = MSG_ReadByte();
+		if (c == clc_move)
+			break;
+
+		switch (c)
+		{
+		case clc_nop:
+			break;
+		case clc_stringcmd:
+			SV_SkipString();
+			break;
+		case clc_delta:
+			MSG_ReadByte();
+			break;
+		default:
+			return;
+		}
+	}
+
+	pre->sequence = sequence;
+	pre->cursize = net_message.cursize;
+	pre->start = msg_readcount;
+	CRC32_Init(&pre->crc);
+	CRC32_ProcessBuffer(&pre->crc, &net_message.data[pre->start], net_message.cursize - pre->start);
+	pre->crc = CRC32_Final(pre->crc);
+
+	pre->result = SV_DecodeMove(sequence, &pre->move, pre->fieldbits);
+	pre->end = msg_readcount;
+	pre->badread = msg_badread;
+	pre->numparsed = (pre->result == MOVEDECODE_TOOMANYCMDS) ? 0 : pre->move.numcmds + pre->move.numbackup;
+
+	// the munged length is the first byte of the move
+	pre->mungelen = min((int)net_message.data[pre->start] & ~3, net_message.cursize - (pre->start + 2));
+	if (pre->mungelen < 0)
+		pre->mungelen = 0;
+	Q_memcpy(pre->unmunged, &net_message.data[pre->start + 2], pre->mungelen);
+
+	pre->valid = TRUE;
+}
+
+// Puts net_message and the delta stats in the state SV_DecodeMove would leave them in, if the move
+// SV_ReadPackets decoded ahead is the one about to be parsed
+qboolean SV_TakePredecodedMove(int sequence, clientmove_t **move, movedecode_t *result)
+{
+	predecodedmove_t *pre = sv_predecodedmove;
+	if (!pre || !pre->valid || msg_badread)
+		return FALSE;
+
+	sv_predecodedmove = NULL;
+	if (pre->sequence != sequence || pre->cursize != net_message.cursize || pre->start != msg_readcount)
+		return FALSE;
+
+	CRC32_t crc;
+	CRC32_Init(&crc);
+	CRC32_ProcessBuffer(&crc, &net_message.data[msg_readcount], net_message.cursize - msg_readcount);
+	if (CRC32_Final(crc) != pre->crc)
+		return FALSE;
+
+	Q_memcpy(&net_message.data[pre->start + 2], pre->unmunged, pre->mungelen);
+	msg_readcount = pre->end;
+	msg_badread = pre->badread;
+
+	for (int i = 0; i < pre->numparsed; i++)
+		DELTA_StatsParseReplay(g_pusercmddelta, pre->fieldbits[i]);
+
+	*move = &pre->move;
+	*result = pre->result;
+	return TRUE;
+}
+#endif // REHLDS_OPT_PEDANTIC
+
+/* <bf48b> ../engine/sv_user.c:1835 */
+void SV_ParseMove(client_t *pSenderClient)
+{
+	client_frame_t *frame;
+	int numcmds;
 	int numbackup;
+	usercmd_t *cmd;
+	usercmd_t *cmds;
+	float packet_loss;
+	clientmove_t decoded;
+	clientmove_t *move = &decoded;
+	movedecode_t result;
 
 	if (g_balreadymoved)
 	{
@@ -1497,48 +1776,36 @@ void SV_ParseMove(client_t *pSenderClient)
 	g_balreadymoved = 1;
 
 	frame = &host_client->frames[SV_UPDATE_MASK & host_client->netchan.incoming_acknowledged];
-	Q_memset(&cmdNull, 0, sizeof(cmdNull));
-	
-	placeholder = msg_readcount + 1;
-	mlen = MSG_ReadByte();
-	cbchecksum = MSG_ReadByte();
-	COM_UnMunge(&net_message.data[placeholder + 1], mlen, host_client->netchan.incoming_sequence);
+#ifdef REHLDS_OPT_PEDANTIC
+	if (!SV_TakePredecodedMove(host_client->netchan.incoming_sequence, &move, &result))
+#endif // REHLDS_OPT_PEDANTIC
+		result = SV_DecodeMove(host_client->netchan.incoming_sequence, move, NULL);
 
-	packetLossByte = MSG_ReadByte();
-	numbackup = MSG_ReadByte();
-	numcmds = MSG_ReadByte();
+	numcmds = move->numcmds;
+	numbackup = move->numbackup;
+	packet_loss = move->packet_loss;
+	cmds = move->cmds;
 
-	packet_loss = float(packetLossByte & 0x7F);
-	pSenderClient->m_bLoopback = (packetLossByte >> 7) & 1;
-	totalcmds = numcmds + numbackup;
+	pSenderClient->m_bLoopback = move->loopback;
 	net_drop += 1 - numcmds;
-	if (totalcmds < 0 || totalcmds >= 63)
+	if (result == MOVEDECODE_TOOMANYCMDS)
 	{
-		Con_Printf("SV_ReadClientMessage: too many cmds %i sent for %s/%s\n", totalcmds, host_client->name, NET_AdrToString(host_client->netchan.remote_address));
+		Con_Printf("SV_ReadClientMessage: too many cmds %i sent for %s/%s\n", numcmds + numbackup, host_client->name, NET_AdrToString(host_client->netchan.remote_address));
 		SV_DropClient(host_client, 0, "CMD_MAXBACKUP hit");
 		msg_badread = 1;
 		return;
 	}
-	
-	usercmd_t* from = &cmdNull;
-	for (int i = totalcmds - 1; i >= 0; i--)
-	{
-		MSG_ReadUsercmd(&cmds[i], from);
-		from = &cmds[i];
-	}
 
 	if (!g_psv.active || !(host_client->active || host_client->spawned))
 		return;
 
-
-	if (msg_badread)
+	if (result == MOVEDECODE_BADREAD)
 	{
 		Con_Printf("Client %s:%s sent a bogus command packet\n", host_client->name, NET_AdrToString(host_client->netchan.remote_address));
 		return;
 	}
 
-	cbpktchecksum = COM_BlockSequenceCRCByte(&net_message.data[placeholder + 1], msg_readcount - placeholder - 1, host_client->netchan.incoming_sequence);
-	if (cbpktchecksum != cbchecksum)
+	if (result == MOVEDECODE_BADCHECKSUM)
 	{
 		Con_DPrintf("Failed command checksum for %s:%s\n", host_client->name, NET_AdrToString(host_client->netchan.remote_address));
 		msg_badread = 1;
@@ -1716,6 +1983,10 @@ void SV_ExecuteClientMessage(client_t *cl)
 	g_balreadymoved = 0;
 	client_frame_t * frame = &cl->frames[SV_UPDATE_MASK & cl->netchan.incoming_acknowledged];
 	frame->ping_time = realtime - frame->senttime - cl->next_messageinterval;
+#if defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
+	// time the packet spent queued by the network thread is not network latency
+	frame->ping_time -= net_from_delay;
+#endif // defined(REHLDS_OPT_PEDANTIC) && !defined(_WIN32)
 	if (frame->senttime == 0.0)
 		frame->ping_time = 0;
 
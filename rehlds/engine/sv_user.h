@@ -63,6 +63,48 @@ typedef struct clc_func_s
 	void(*pfnParse)(client_t *);
 } clc_func_t;
 
+// Result of the decode stage of clc_move
+typedef enum movedecode_e
+{
+	MOVEDECODE_OK,
+	MOVEDECODE_TOOMANYCMDS,	// header is read, commands aren't
+	MOVEDECODE_BADREAD,
+	MOVEDECODE_BADCHECKSUM,
+} movedecode_t;
+
+// clc_move contents as sent by client, commands are in reverse order (cmds[0] is the newest one)
+typedef struct clientmove_s
+{
+	int numbackup;
+	int numcmds;
+	float packet_loss;
+	qboolean loopback;
+	usercmd_t cmds[64];
+} clientmove_t;
+
+#ifdef REHLDS_OPT_PEDANTIC
+// clc_move of a queued packet, decoded on a worker thread before the main thread gets to the packet.
+// The main thread uses it only if it reaches the move with the same decode inputs
+typedef struct predecodedmove_s
+{
+	qboolean valid;
+	int sequence;		// incoming_sequence the move was decoded with
+	int cursize;		// net_message.cursize
+	int start;			// msg_readcount when SV_ParseMove starts
+	CRC32_t crc;		// of the message from start on, as Netchan_Process leaves it
+
+	// state SV_DecodeMove leaves behind
+	movedecode_t result;
+	int end;
+	int badread;
+	int mungelen;		// bytes from start + 2 that COM_UnMunge changed, as they are after it
+	unsigned char unmunged[256];
+	int numparsed;		// MSG_ReadUsercmd calls
+	int fieldbits[64][2];	// their delta fields, for the stats
+	clientmove_t move;
+} predecodedmove_t;
+#endif // REHLDS_OPT_PEDANTIC
+
 #ifdef HOOK_ENGINE
 #define sv_player (*psv_player)
 #define clcommands (*pclcommands)
@@ -92,6 +134,9 @@ extern edict_t *sv_player;
 extern command_t clcommands[23];
 extern sv_adjusted_positions_t truepositions[MAX_CLIENTS];
 extern qboolean g_balreadymoved;
+#ifdef REHLDS_OPT_PEDANTIC
+extern predecodedmove_t *sv_predecodedmove;
+#endif // REHLDS_OPT_PEDANTIC
 
 #ifdef HOOK_ENGINE
 extern clc_func_t sv_clcfuncs[12];
@@ -142,6 +187,11 @@ void SV_RestoreMove(client_t *_host_client);
 void SV_ParseStringCommand(client_t *pSenderClient);
 void SV_ParseDelta(client_t *pSenderClient);
 void SV_EstablishTimeBase(client_t *cl, usercmd_t *cmds, int dropped, int numbackup, int numcmds);
+movedecode_t SV_DecodeMove(int sequence, clientmove_t *move, int (*fieldbits)[2]);
+#ifdef REHLDS_OPT_PEDANTIC
+void SV_PredecodeMove(const unsigned char *data, int size, predecodedmove_t *pre);
+qboolean SV_TakePredecodedMove(int sequence, clientmove_t **move, movedecode_t *result);
+#endif // REHLDS_OPT_PEDANTIC
 void SV_ParseMove(client_t *pSenderClient);
 void SV_ParseVoiceData(client_t *cl);
 void SV_IgnoreHLTV(client_t *cl);
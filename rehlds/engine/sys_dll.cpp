@@ -611,9 +611,9 @@ double Sys_FloatTime(void)
 	if ( !bInitialized )
 	{
 		bInitialized = 1;
-		clock_gettime(1, &start_time);
+		CRehldsPlatformHolder::get()->clock_gettime(CLOCK_MONOTONIC, &start_time);
 	}
-	clock_gettime(1, &now);
+	CRehldsPlatformHolder::get()->clock_gettime(CLOCK_MONOTONIC, &now);
 	return (now.tv_sec - start_time.tv_sec) + now.tv_nsec * 0.000000001;
 }
 
@@ -706,6 +706,13 @@ bool CDedicatedServerAPI::Init_noVirt(char *basedir, char *cmdline, CreateInterf
 #else
 	Q_strcpy(this->m_OrigCmd, cmdline);
 #endif
+
+#ifndef _WIN32
+	// There is no hooker dll on Linux, the testsuite must be in place before the first platform call
+	g_RehldsRuntimeConfig.parseFromCommandLine(cmdline);
+	TestSuite_Init(NULL, NULL, NULL);
+#endif // _WIN32
+
 	if (!strstr(cmdline, "-nobreakpad"))
 	{
 		CRehldsPlatformHolder::get()->SteamAPI_UseBreakpadCrashHandler(va("%d", build_number()), "Aug  8 2013", "11:17:26", 0, 0, 0);
@@ -759,6 +766,10 @@ bool CDedicatedServerAPI::RunFrame_noVirt(void)
 	if (eng->GetQuitting())
 		return false;
 
+#ifdef REHLDS_OPT_PEDANTIC
+	Sched_WaitForFrame();
+#endif // REHLDS_OPT_PEDANTIC
+
 	eng->Frame();
 	return true;
 }
@@ -35,6 +35,7 @@ box_planes_t box_planes;
 beam_planes_t beam_planes;
 areanode_t sv_areanodes[32];
 int sv_numareanodes;
+int sv_areaserial;
 
 
 /* <ca50b> ../engine/world.c:48 */
@@ -291,6 +292,7 @@ void SV_ClearWorld(void)
 	SV_InitBoxHull();
 	Q_memset(sv_areanodes, 0, sizeof(sv_areanodes));
 	sv_numareanodes = 0;
+	sv_areaserial++;
 	SV_CreateAreaNode(0, g_psv.worldmodel->mins, g_psv.worldmodel->maxs);
 }
 
@@ -302,6 +304,7 @@ void SV_UnlinkEdict(edict_t *ent)
 		RemoveLink(&ent->area);
 		ent->area.next = NULL;
 		ent->area.prev = NULL;
+		sv_areaserial++;
 	}
 }
 
@@ -553,6 +556,10 @@ void SV_LinkEdict(edict_t *ent, qboolean touch_triggers)
 		}
 	}
 
+#ifdef REHLDS_OPT_PEDANTIC
+	SV_BuildLeafMask(ent);
+#endif // REHLDS_OPT_PEDANTIC
+
 	if (ent->v.solid == SOLID_NOT && ent->v.skin >= -1)
 		return;
 
@@ -577,6 +584,7 @@ void SV_LinkEdict(edict_t *ent, qboolean touch_triggers)
 		}
 
 		InsertLinkBefore(&ent->area, (ent->v.solid == SOLID_TRIGGER) ? &node->trigger_edicts : &node->solid_edicts);
+		sv_areaserial++;
 		if (touch_triggers)
 		{
 			if (!iTouchLinkSemaphore)
@@ -593,6 +601,29 @@ void SV_LinkEdict(edict_t *ent, qboolean touch_triggers)
 	}
 }
 
+#ifdef REHLDS_OPT_PEDANTIC
+int SV_HullPointContents_Packed(const hull_t *hull, const packedclipnode_t *nodes, int num, const vec_t *p)
+{
+	const packedclipnode_t *node;
+	float d;
+
+	int i = num;
+	while (i >= 0)
+	{
+		if (hull->firstclipnode > i || hull->lastclipnode < i)
+			Sys_Error(__FUNCTION__ ": bad node number");
+		node = &nodes[i];
+		if (node->type > 2)
+			d = _DotProduct(node->normal, p) - node->dist;
+		else
+			d = p[node->type] - node->dist;
+		i = node->children[(d >= 0.0f) ? 0 : 1];
+	}
+
+	return i;
+}
+#endif // REHLDS_OPT_PEDANTIC
+
 /* <ca97c> ../engine/world.c:630 */
 int SV_HullPointContents(hull_t *hull, int num, const vec_t *p)
 {
@@ -600,6 +631,12 @@ int SV_HullPointContents(hull_t *hull, int num, const vec_t *p)
 	mplane_t *plane;
 	float d;
 
+#ifdef REHLDS_OPT_PEDANTIC
+	const packedclipnode_t *packed = Mod_FindPackedClipnodes(hull);
+	if (packed)
+		return SV_HullPointContents_Packed(hull, packed, num, p);
+#endif // REHLDS_OPT_PEDANTIC
+
 	int i = num;
 	while (i >= 0)
 	{
@@ -881,7 +918,7 @@ qboolean SV_RecursiveHullCheck(hull_t *hull, int num, float p1f, float p2f, cons
 }
 #else // REHLDS_OPT_PEDANTIC
 // version with unrolled tail recursion
-qboolean SV_RecursiveHullCheck(hull_t *hull, int num, float p1f, float p2f, const vec_t *p1, const vec_t *p2, trace_t *trace)
+qboolean SV_RecursiveHullCheck_Unpacked(hull_t *hull, int num, float p1f, float p2f, const vec_t *p1, const vec_t *p2, trace_t *trace)
 {
 	dclipnode_t *node;
 	mplane_t *plane;
@@ -953,7 +990,7 @@ qboolean SV_RecursiveHullCheck(hull_t *hull, int num, float p1f, float p2f, cons
 			mid[1] = (p2[1] - p1[1]) * midf + p1[1];
 			mid[2] = (p2[2] - p1[2]) * midf + p1[2];
 			side = (t1 < 0.0f) ? 1 : 0;
-			if (SV_RecursiveHullCheck(hull, node->children[side], p1f, frac, p1, mid, trace))
+			if (SV_RecursiveHullCheck_Unpacked(hull, node->children[side], p1f, frac, p1, mid, trace))
 			{
 				if (SV_HullPointContents(hull, node->children[side ^ 1], mid) != CONTENTS_SOLID)
 				{
@@ -1033,6 +1070,167 @@ qboolean SV_RecursiveHullCheck(hull_t *hull, int num, float p1f, float p2f, cons
 	}
 	return TRUE;
 }
+
+// same as above, but walks the packed clipnodes built by Mod_PackHulls
+qboolean SV_RecursiveHullCheck_Packed(const hull_t *hull, const packedclipnode_t *nodes, int num, float p1f, float p2f, const vec_t *p1, const vec_t *p2, trace_t *trace)
+{
+	const packedclipnode_t *node;
+	float t2;
+	vec3_t mid;
+	float frac;
+	float t1;
+	signed int side;
+	float midf;
+	float pdif;
+	vec3_t custom_p1; // for holding custom p1 value
+
+	float DIST_EPSILON = 0.03125f;
+
+	while (num >= 0)
+	{
+		pdif = p2f - p1f;
+
+		if (num < hull->firstclipnode || num > hull->lastclipnode)
+			Sys_Error(__FUNCTION__ ": bad node number");
+
+		node = &nodes[num];
+		if (node->type >= 3)
+		{
+			t1 = _DotProduct(p1, node->normal) - node->dist;
+			t2 = _DotProduct(p2, node->normal) - node->dist;
+		}
+		else
+		{
+			t1 = p1[node->type] - node->dist;
+			t2 = p2[node->type] - node->dist;
+		}
+		if (t1 >= 0.0f && t2 >= 0.0f)
+		{
+			num = node->children[0];
+			continue;
+		}
+
+		if (t1 >= 0.0f)
+		{
+			midf = t1 - DIST_EPSILON;
+		}
+		else
+		{
+			if (t2 < 0.0f)
+			{
+				num = node->children[1];
+				continue;
+			}
+
+			midf = t1 + DIST_EPSILON;
+		}
+
+		midf = midf / (t1 - t2);
+		if (midf >= 0.0f)
+		{
+			if (midf > 1.0f)
+				midf = 1.0f;
+		}
+		else
+		{
+			midf = 0.0f;
+		}
+		if (!IS_NAN(midf)) // not a number
+		{
+			frac = pdif * midf + p1f;
+			mid[0] = (p2[0] - p1[0]) * midf + p1[0];
+			mid[1] = (p2[1] - p1[1]) * midf + p1[1];
+			mid[2] = (p2[2] - p1[2]) * midf + p1[2];
+			side = (t1 < 0.0f) ? 1 : 0;
+			if (SV_RecursiveHullCheck_Packed(hull, nodes, node->children[side], p1f, frac, p1, mid, trace))
+			{
+				if (SV_HullPointContents_Packed(hull, nodes, node->children[side ^ 1], mid) != CONTENTS_SOLID)
+				{
+					num = node->children[side ^ 1];
+					p1f = frac;
+					p1 = custom_p1;
+					custom_p1[0] = mid[0];
+					custom_p1[1] = mid[1];
+					custom_p1[2] = mid[2];
+					continue;
+				}
+
+				if (!trace->allsolid)
+				{
+					if (side)
+					{
+						trace->plane.normal[0] = vec3_origin[0] - node->normal[0];
+						trace->plane.normal[1] = vec3_origin[1] - node->normal[1];
+						trace->plane.normal[2] = vec3_origin[2] - node->normal[2];
+						trace->plane.dist = -node->dist;
+					}
+					else
+					{
+						trace->plane.normal[0] = node->normal[0];
+						trace->plane.normal[1] = node->normal[1];
+						trace->plane.normal[2] = node->normal[2];
+						trace->plane.dist = node->dist;
+					}
+
+					while (1)
+					{
+						if (SV_HullPointContents_Packed(hull, nodes, hull->firstclipnode, mid) != CONTENTS_SOLID)
+						{
+							trace->fraction = frac;
+							trace->endpos[0] = mid[0];
+							trace->endpos[1] = mid[1];
+							trace->endpos[2] = mid[2];
+							return FALSE;
+						}
+						midf -= 0.1f;
+						if (midf < 0.0f)
+							break;
+						frac = pdif * midf + p1f;
+						mid[0] = (p2[0] - p1[1]) * midf + p1[0];
+						mid[1] = (p2[1] - p1[1]) * midf + p1[1];
+						mid[2] = (p2[2] - p1[2]) * midf + p1[2];
+					}
+					trace->fraction = frac;
+					trace->endpos[0] = mid[0];
+					trace->endpos[1] = mid[1];
+					trace->endpos[2] = mid[2];
+					Con_DPrintf("backup past 0\n");
+					return FALSE;
+				}
+			}
+		}
+		return FALSE;
+	}
+
+	if (num == CONTENTS_SOLID)
+	{
+		trace->startsolid = TRUE;
+	}
+	else
+	{
+		trace->allsolid = FALSE;
+		if (num == CONTENTS_EMPTY)
+		{
+			trace->inopen = TRUE;
+			return TRUE;
+		}
+		if (num != CONTENTS_TRANSLUCENT)
+		{
+			trace->inwater = TRUE;
+			return TRUE;
+		}
+	}
+	return TRUE;
+}
+
+qboolean SV_RecursiveHullCheck(hull_t *hull, int num, float p1f, float p2f, const vec_t *p1, const vec_t *p2, trace_t *trace)
+{
+	const packedclipnode_t *packed = Mod_FindPackedClipnodes(hull);
+	if (packed)
+		return SV_RecursiveHullCheck_Packed(hull, packed, num, p1f, p2f, p1, p2, trace);
+
+	return SV_RecursiveHullCheck_Unpacked(hull, num, p1f, p2f, p1, p2, trace);
+}
 #endif // REHLDS_OPT_PEDANTIC
 
 /* <cadd3> ../engine/world.c:948 */
@@ -1160,89 +1358,102 @@ trace_t SV_ClipMoveToEntity(edict_t *ent, const vec_t *start, const vec_t *mins,
 	return goodtrace;
 }
 
-/* <cb027> ../engine/world.c:1148 */
-void SV_ClipToLinks(areanode_t *node, moveclip_t *clip)
-{
-	link_t *l;
-	link_t *next;
+// Clips the move against a single entity linked into an areanode.
+// CLIPLINK_STOP_NODE means the remaining entities of that node must be skipped.
+#define CLIPLINK_NEXT		0
+#define CLIPLINK_STOP_NODE	1
 
-	for (l = node->solid_edicts.next; l != &node->solid_edicts; l = next)
+inline int SV_ClipToLinkedEdict(edict_t *touch, moveclip_t *clip)
+{
+	if (touch->v.groupinfo && clip->passedict && clip->passedict->v.groupinfo)
 	{
-		next = l->next;
-		edict_t *touch = (edict_t *)((char *)l - offsetof(edict_t, area));
-		if (touch->v.groupinfo && clip->passedict && clip->passedict->v.groupinfo)
+		if (g_groupop)
 		{
-			if (g_groupop)
-			{
-				if (g_groupop == GROUP_OP_NAND && (clip->passedict->v.groupinfo & touch->v.groupinfo))
-					continue;
-			}
-			else
-			{
-				if (!(clip->passedict->v.groupinfo & touch->v.groupinfo))
-					continue;
-			}
+			if (g_groupop == GROUP_OP_NAND && (clip->passedict->v.groupinfo & touch->v.groupinfo))
+				return CLIPLINK_NEXT;
+		}
+		else
+		{
+			if (!(clip->passedict->v.groupinfo & touch->v.groupinfo))
+				return CLIPLINK_NEXT;
 		}
+	}
 
-		if (touch->v.solid == SOLID_NOT)
-			continue;
+	if (touch->v.solid == SOLID_NOT)
+		return CLIPLINK_NEXT;
 
-		if (touch == clip->passedict)
-			continue;
+	if (touch == clip->passedict)
+		return CLIPLINK_NEXT;
 
-		if (touch->v.solid == SOLID_TRIGGER)
-			Sys_Error("Trigger in clipping list");
+	if (touch->v.solid == SOLID_TRIGGER)
+		Sys_Error("Trigger in clipping list");
 
-		if (gNewDLLFunctions.pfnShouldCollide && !gNewDLLFunctions.pfnShouldCollide(touch, clip->passedict))
+	if (gNewDLLFunctions.pfnShouldCollide && !gNewDLLFunctions.pfnShouldCollide(touch, clip->passedict))
 #ifdef REHLDS_FIXES
-			// https://github.com/dreamstalker/rehlds/issues/46
-			continue;
+		// https://github.com/dreamstalker/rehlds/issues/46
+		return CLIPLINK_NEXT;
 #else
-			return;
+		return CLIPLINK_STOP_NODE;
 #endif
 
-		if (touch->v.solid == SOLID_BSP)
-		{
-			if ((touch->v.flags & FL_MONSTERCLIP) && !clip->monsterClipBrush)
-				continue;
-		}
+	if (touch->v.solid == SOLID_BSP)
+	{
+		if ((touch->v.flags & FL_MONSTERCLIP) && !clip->monsterClipBrush)
+			return CLIPLINK_NEXT;
+	}
+	else
+	{
+		if (clip->type == 1 && touch->v.movetype != MOVETYPE_PUSHSTEP)
+			return CLIPLINK_NEXT;
+	}
+
+	if ((!clip->ignoretrans || !touch->v.rendermode || (touch->v.flags & FL_WORLDBRUSH))
+		&& clip->boxmins[0] <= touch->v.absmax[0]
+		&& clip->boxmins[1] <= touch->v.absmax[1]
+		&& clip->boxmins[2] <= touch->v.absmax[2]
+		&& clip->boxmaxs[0] >= touch->v.absmin[0]
+		&& clip->boxmaxs[1] >= touch->v.absmin[1]
+		&& clip->boxmaxs[2] >= touch->v.absmin[2]
+		&& (touch->v.solid == SOLID_SLIDEBOX || SV_CheckSphereIntersection(touch, clip->start, clip->end))
+		&& (!clip->passedict || clip->passedict->v.size[0] == 0.0f || touch->v.size[0] != 0.0f))
+	{
+		if (clip->trace.allsolid)
+			return CLIPLINK_STOP_NODE;
+
+		if (clip->passedict && (touch->v.owner == clip->passedict || clip->passedict->v.owner == touch))
+			return CLIPLINK_NEXT;
+
+		trace_t trace;
+		if (touch->v.flags & FL_MONSTER)
+			trace = SV_ClipMoveToEntity(touch, clip->start, clip->mins2, clip->maxs2, clip->end);
 		else
-		{
-			if (clip->type == 1 && touch->v.movetype != MOVETYPE_PUSHSTEP)
-				continue;
-		}
+			trace = SV_ClipMoveToEntity(touch, clip->start, clip->mins, clip->maxs, clip->end);
 
-		if ((!clip->ignoretrans || !touch->v.rendermode || (touch->v.flags & FL_WORLDBRUSH))
-			&& clip->boxmins[0] <= touch->v.absmax[0]
-			&& clip->boxmins[1] <= touch->v.absmax[1]
-			&& clip->boxmins[2] <= touch->v.absmax[2]
-			&& clip->boxmaxs[0] >= touch->v.absmin[0]
-			&& clip->boxmaxs[1] >= touch->v.absmin[1]
-			&& clip->boxmaxs[2] >= touch->v.absmin[2]
-			&& (touch->v.solid == SOLID_SLIDEBOX || SV_CheckSphereIntersection(touch, clip->start, clip->end))
-			&& (!clip->passedict || clip->passedict->v.size[0] == 0.0f || touch->v.size[0] != 0.0f))
+		if (trace.allsolid || trace.startsolid || trace.fraction < clip->trace.fraction)
 		{
-			if (clip->trace.allsolid)
-				return;
+			int oldStartSolid = clip->trace.startsolid;
+			trace.ent = touch;
+			clip->trace = trace;
+			if (oldStartSolid)
+				clip->trace.startsolid = TRUE;
+		}
+	}
 
-			if (clip->passedict && (touch->v.owner == clip->passedict || clip->passedict->v.owner == touch))
-				continue;
+	return CLIPLINK_NEXT;
+}
 
-			trace_t trace;
-			if (touch->v.flags & FL_MONSTER)
-				trace = SV_ClipMoveToEntity(touch, clip->start, clip->mins2, clip->maxs2, clip->end);
-			else
-				trace = SV_ClipMoveToEntity(touch, clip->start, clip->mins, clip->maxs, clip->end);
+/* <cb027> ../engine/world.c:1148 */
+void SV_ClipToLinks(areanode_t *node, moveclip_t *clip)
+{
+	link_t *l;
+	link_t *next;
 
-			if (trace.allsolid || trace.startsolid || trace.fraction < clip->trace.fraction)
-			{
-				int oldStartSolid = clip->trace.startsolid;
-				trace.ent = touch;
-				clip->trace = trace;
-				if (oldStartSolid)
-					clip->trace.startsolid = TRUE;
-			}
-		}
+	for (l = node->solid_edicts.next; l != &node->solid_edicts; l = next)
+	{
+		next = l->next;
+		edict_t *touch = (edict_t *)((char *)l - offsetof(edict_t, area));
+		if (SV_ClipToLinkedEdict(touch, clip) == CLIPLINK_STOP_NODE)
+			return;
 	}
 
 	if (node->axis != -1)
@@ -1368,6 +1579,16 @@ trace_t SV_MoveNoEnts(const vec_t *start, vec_t *mins, vec_t *maxs, const vec_t
 
 /* <cb47e> ../engine/world.c:1415 */
 trace_t SV_Move(const vec_t *start, const vec_t *mins, const vec_t *maxs, const vec_t *end, int type, edict_t *passedict, qboolean monsterClipBrush)
+{
+#ifdef REHLDS_OPT_PEDANTIC
+	if (sv_tracecache.value != 0.0f)
+		return SV_MoveCached(start, mins, maxs, end, type, passedict, monsterClipBrush);
+#endif // REHLDS_OPT_PEDANTIC
+
+	return SV_Move_Uncached(start, mins, maxs, end, type, passedict, monsterClipBrush);
+}
+
+trace_t SV_Move_Uncached(const vec_t *start, const vec_t *mins, const vec_t *maxs, const vec_t *end, int type, edict_t *passedict, qboolean monsterClipBrush)
 {
 	moveclip_t clip;
 	vec3_t worldEndPoint;
@@ -1462,6 +1683,14 @@ void SV_MoveBounds_Point(const vec_t *start, const vec_t *end, vec_t *boxmins, v
 }
 
 trace_t SV_Move_Point(const vec_t *start, const vec_t *end, int type, edict_t *passedict)
+{
+	if (sv_tracecache.value != 0.0f)
+		return SV_MoveCached(start, NULL, NULL, end, type, passedict, FALSE);
+
+	return SV_Move_Point_Uncached(start, end, type, passedict);
+}
+
+trace_t SV_Move_Point_Uncached(const vec_t *start, const vec_t *end, int type, edict_t *passedict)
 {
 	moveclip_t clip;
 	vec3_t worldEndPoint;
@@ -1512,4 +1741,388 @@ trace_t SV_Move_Point(const vec_t *start, const vec_t *end, int type, edict_t *p
 
 	return clip.trace;
 }
+
+// Per-frame memoization of SV_Move/SV_Move_Point results.
+// An entry is valid only for the frame it was stored in and only while no edict was linked or unlinked since,
+// but game dll state that doesn't go through SV_LinkEdict (pfnShouldCollide, solid changes without relink) isn't tracked,
+// so the cache is opt-in per mod
+cvar_t sv_tracecache = { "sv_tracecache", "0", 0, 0.0f, NULL };
+
+#define TRACECACHE_SIZE		512 // must be power of 2
+
+typedef struct tracecachekey_s
+{
+	vec3_t start;
+	vec3_t end;
+	vec3_t mins;
+	vec3_t maxs;
+	int type;
+	edict_t *passedict;
+	qboolean monsterClipBrush;
+	qboolean point;
+
+	// globals the move reads: hull selection for studio models and trace group filtering
+	int traceflags;
+	int groupop;
+	int groupmask;
+	float clienttrace;
+} tracecachekey_t;
+
+typedef struct tracecacheentry_s
+{
+	tracecachekey_t key;
+	int frame;
+	int areaserial;
+	qboolean setTraceEnt; // the move updated gGlobalVariables.trace_ent
+	trace_t trace;
+} tracecacheentry_t;
+
+static tracecacheentry_t sv_tracecacheentries[TRACECACHE_SIZE];
+static int sv_tracecacheframe = 1;
+static unsigned int sv_tracecachehits;
+static unsigned int sv_tracecachemisses;
+
+void SV_TraceCacheFrameEnd(void)
+{
+	// entries from the previous frames become stale, no need to touch them
+	sv_tracecacheframe++;
+}
+
+void SV_TraceCacheStats_f(void)
+{
+	if (Cmd_Argc() == 2 && !Q_stricmp(Cmd_Argv(1), "reset"))
+	{
+		sv_tracecachehits = 0;
+		sv_tracecachemisses = 0;
+		return;
+	}
+
+	unsigned int total = sv_tracecachehits + sv_tracecachemisses;
+	Con_Printf("Trace cache is %s\n", sv_tracecache.value != 0.0f ? "enabled" : "disabled");
+	Con_Printf("  hits: %u, misses: %u, hit rate: %.1f%%\n", sv_tracecachehits, sv_tracecachemisses, total ? sv_tracecachehits * 100.0 / total : 0.0);
+}
+
+void SV_InitTraceCache(void)
+{
+	Cvar_RegisterVariable(&sv_tracecache);
+	Cmd_AddCommand("sv_tracecache_stats", SV_TraceCacheStats_f);
+}
+
+static unsigned int SV_TraceCacheHash(const tracecachekey_t *key)
+{
+	const unsigned int *data = (const unsigned int *)key;
+	unsigned int hash = 2166136261u;
+
+	for (size_t i = 0; i < sizeof(tracecachekey_t) / sizeof(unsigned int); i++)
+		hash = (hash ^ data[i]) * 16777619u;
+
+	return hash ^ (hash >> 16);
+}
+
+// NULL mins/maxs make it a point move
+trace_t SV_MoveCached(const vec_t *start, const vec_t *mins, const vec_t *maxs, const vec_t *end, int type, edict_t *passedict, qboolean monsterClipBrush)
+{
+	tracecachekey_t key;
+	tracecacheentry_t *entry;
+
+	// keys are compared bitwise, so clear the padding
+	Q_memset(&key, 0, sizeof(key));
+	Q_memcpy(key.start, start, sizeof(vec3_t));
+	Q_memcpy(key.end, end, sizeof(vec3_t));
+	if (mins)
+	{
+		Q_memcpy(key.mins, mins, sizeof(vec3_t));
+		Q_memcpy(key.maxs, maxs, sizeof(vec3_t));
+	}
+	key.type = type;
+	key.passedict = passedict;
+	key.monsterClipBrush = monsterClipBrush;
+	key.point = mins ? FALSE : TRUE;
+	key.traceflags = gGlobalVariables.trace_flags;
+	key.groupop = g_groupop;
+	key.groupmask = g_groupmask;
+	key.clienttrace = sv_clienttrace.value;
+
+	entry = &sv_tracecacheentries[SV_TraceCacheHash(&key) & (TRACECACHE_SIZE - 1)];
+	if (entry->frame == sv_tracecacheframe && entry->areaserial == sv_areaserial && !Q_memcmp(&entry->key, &key, sizeof(key)))
+	{
+		sv_tracecachehits++;
+		if (entry->setTraceEnt)
+			gGlobalVariables.trace_ent = entry->trace.ent;
+
+		return entry->trace;
+	}
+
+	sv_tracecachemisses++;
+
+	int areaserial = sv_areaserial;
+
+	// a move that starts solid in the world leaves trace_ent untouched, find out which case it was
+	edict_t *oldTraceEnt = gGlobalVariables.trace_ent;
+	edict_t *unsetTraceEnt = (edict_t *)sv_tracecacheentries;
+	gGlobalVariables.trace_ent = unsetTraceEnt;
+
+	trace_t trace = mins ? SV_Move_Uncached(start, mins, maxs, end, type, passedict, monsterClipBrush) : SV_Move_Point_Uncached(start, end, type, passedict);
+
+	qboolean setTraceEnt = (gGlobalVariables.trace_ent != unsetTraceEnt) ? TRUE : FALSE;
+	if (!setTraceEnt)
+		gGlobalVariables.trace_ent = oldTraceEnt;
+
+	// pfnShouldCollide may have relinked something during the move, the result is already stale then
+	if (areaserial != sv_areaserial)
+		return trace;
+
+	entry->key = key;
+	entry->frame = sv_tracecacheframe;
+	entry->areaserial = sv_areaserial;
+	entry->setTraceEnt = setTraceEnt;
+	entry->trace = trace;
+
+	return trace;
+}
+#endif // REHLDS_OPT_PEDANTIC
+
+// Entities collected from the areanodes once per group of SV_MoveBatch moves,
+// in the same order SV_ClipToLinks would visit them (the links of a subtree are contiguous)
+typedef struct batchlink_s
+{
+	edict_t *ent;
+	int node;
+} batchlink_t;
+
+// Path from the root areanode: a move visits the node only if it passes every split on the way
+// (SV_CreateAreaNode stops splitting at depth 4)
+typedef struct batchnode_s
+{
+	int numsplits;
+	int axis[4];
+	float dist[4];
+	int side[4];
+	int linksend;	// end of the node's subtree in sv_batchlinks
+} batchnode_t;
+
+static batchlink_t *sv_batchlinks;
+static int sv_maxbatchlinks;
+static int sv_numbatchlinks;
+static batchnode_t sv_batchnodes[ARRAYSIZE(sv_areanodes)];
+
+void SV_CollectBatchLinks(areanode_t *node, const batchnode_t *path, const vec_t *boxmins, const vec_t *boxmaxs)
+{
+	link_t *l;
+	int nodenum = node - sv_areanodes;
+	batchnode_t *bnode = &sv_batchnodes[nodenum];
+
+	*bnode = *path;
+	for (l = node->solid_edicts.next; l != &node->solid_edicts; l = l->next)
+	{
+		if (sv_numbatchlinks >= sv_maxbatchlinks)
+		{
+			sv_maxbatchlinks = sv_maxbatchlinks ? sv_maxbatchlinks * 2 : 256;
+			sv_batchlinks = (batchlink_t *)Mem_Realloc(sv_batchlinks, sv_maxbatchlinks * sizeof(batchlink_t));
+		}
+
+		sv_batchlinks[sv_numbatchlinks].ent = (edict_t *)((char *)l - offsetof(edict_t, area));
+		sv_batchlinks[sv_numbatchlinks].node = nodenum;
+		sv_numbatchlinks++;
+	}
+
+	if (node->axis != -1)
+	{
+		batchnode_t child = *bnode;
+		child.axis[child.numsplits] = node->axis;
+		child.dist[child.numsplits] = node->dist;
+		child.numsplits++;
+
+		if (boxmaxs[node->axis] > node->dist)
+		{
+			child.side[child.numsplits - 1] = 0;
+			SV_CollectBatchLinks(node->children[0], &child, boxmins, boxmaxs);
+		}
+
+		if (node->dist > boxmins[node->axis])
+		{
+			child.side[child.numsplits - 1] = 1;
+			SV_CollectBatchLinks(node->children[1], &child, boxmins, boxmaxs);
+		}
+	}
+
+	bnode->linksend = sv_numbatchlinks;
+}
+
+qboolean SV_BatchNodeVisited(const batchnode_t *bnode, const moveclip_t *clip)
+{
+	for (int i = 0; i < bnode->numsplits; i++)
+	{
+		if (bnode->side[i] == 0)
+		{
+			if (!(clip->boxmaxs[bnode->axis[i]] > bnode->dist[i]))
+				return FALSE;
+		}
+		else
+		{
+			if (!(bnode->dist[i] > clip->boxmins[bnode->axis[i]]))
+				return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+// Same as SV_ClipToLinks(sv_areanodes, clip), but over the links collected by SV_CollectBatchLinks
+void SV_ClipToBatchLinks(moveclip_t *clip)
+{
+	int i = 0;
+	while (i < sv_numbatchlinks)
+	{
+		int node = sv_batchlinks[i].node;
+		const batchnode_t *bnode = &sv_batchnodes[node];
+
+		// SV_ClipToLinks doesn't descend below a node it skips or stops in
+		if (!SV_BatchNodeVisited(bnode, clip))
+		{
+			i = bnode->linksend;
+			continue;
+		}
+
+		for (; i < sv_numbatchlinks && sv_batchlinks[i].node == node; i++)
+		{
+			if (SV_ClipToLinkedEdict(sv_batchlinks[i].ent, clip) == CLIPLINK_STOP_NODE)
+			{
+				i = bnode->linksend;
+				break;
+			}
+		}
+	}
+}
+
+void SV_MoveBatchGroup(const movebatch_t *moves, trace_t *traces, int count)
+{
+	moveclip_t clips[MOVEBATCH_GROUP_SIZE];
+	vec3_t worldEndPoints[MOVEBATCH_GROUP_SIZE];
+	float worldFractions[MOVEBATCH_GROUP_SIZE];
+	qboolean needLinks[MOVEBATCH_GROUP_SIZE];
+	int i, j;
+
+	// clip against the world first, it decides how far each move can reach
+	for (i = 0; i < count; i++)
+	{
+		const movebatch_t *move = &moves[i];
+		moveclip_t *clip = &clips[i];
+
+		Q_memset(clip, 0, sizeof(*clip));
+#ifdef REHLDS_OPT_PEDANTIC
+		if (!move->mins)
+			SV_SingleClipMoveToPoint(move->start, move->end, &clip->trace);
+		else
+#endif // REHLDS_OPT_PEDANTIC
+			clip->trace = SV_ClipMoveToEntity(g_psv.edicts, move->start, move->mins ? move->mins : vec3_origin, move->maxs ? move->maxs : vec3_origin, move->end);
+
+		needLinks[i] = (clip->trace.fraction != 0.0f) ? TRUE : FALSE;
+		if (!needLinks[i])
+			continue;
+
+		worldEndPoints[i][0] = clip->trace.endpos[0];
+		worldEndPoints[i][1] = clip->trace.endpos[1];
+		worldEndPoints[i][2] = clip->trace.endpos[2];
+		clip->end = worldEndPoints[i];
+		worldFractions[i] = clip->trace.fraction;
+
+		clip->type = move->type & 0xFF;
+		clip->ignoretrans = move->type >> 8;
+		clip->trace.fraction = 1.0f;
+		clip->start = move->start;
+		clip->mins = move->mins ? move->mins : vec3_origin;
+		clip->maxs = move->maxs ? move->maxs : vec3_origin;
+		clip->passedict = move->passedict;
+		clip->monsterClipBrush = move->monsterClipBrush;
+		if (move->type == 2)
+		{
+			for (j = 0; j < 3; j++)
+			{
+				clip->mins2[j] = -15.0f;
+				clip->maxs2[j] = +15.0f;
+			}
+		}
+		else
+		{
+			for (j = 0; j < 3; j++)
+			{
+				clip->mins2[j] = clip->mins[j];
+				clip->maxs2[j] = clip->maxs[j];
+			}
+		}
+
+#ifdef REHLDS_OPT_PEDANTIC
+		if (!move->mins)
+			SV_MoveBounds_Point(move->start, worldEndPoints[i], clip->boxmins, clip->boxmaxs);
+		else
 #endif // REHLDS_OPT_PEDANTIC
+			SV_MoveBounds(move->start, clip->mins2, clip->maxs2, worldEndPoints[i], clip->boxmins, clip->boxmaxs);
+	}
+
+	// consecutive moves with overlapping bounds share one walk over the areanodes
+	i = 0;
+	while (i < count)
+	{
+		if (!needLinks[i])
+		{
+			traces[i] = clips[i].trace;
+			i++;
+			continue;
+		}
+
+		vec3_t boxmins, boxmaxs;
+		int last;
+
+		boxmins[0] = clips[i].boxmins[0]; boxmins[1] = clips[i].boxmins[1]; boxmins[2] = clips[i].boxmins[2];
+		boxmaxs[0] = clips[i].boxmaxs[0]; boxmaxs[1] = clips[i].boxmaxs[1]; boxmaxs[2] = clips[i].boxmaxs[2];
+		for (last = i + 1; last < count; last++)
+		{
+			if (!needLinks[last])
+				continue;
+
+			const moveclip_t *clip = &clips[last];
+			if (clip->boxmins[0] > boxmaxs[0] || clip->boxmins[1] > boxmaxs[1] || clip->boxmins[2] > boxmaxs[2]
+				|| clip->boxmaxs[0] < boxmins[0] || clip->boxmaxs[1] < boxmins[1] || clip->boxmaxs[2] < boxmins[2])
+				break;
+
+			for (j = 0; j < 3; j++)
+			{
+				if (clip->boxmins[j] < boxmins[j])
+					boxmins[j] = clip->boxmins[j];
+				if (clip->boxmaxs[j] > boxmaxs[j])
+					boxmaxs[j] = clip->boxmaxs[j];
+			}
+		}
+
+		batchnode_t root;
+		root.numsplits = 0;
+		sv_numbatchlinks = 0;
+		SV_CollectBatchLinks(sv_areanodes, &root, boxmins, boxmaxs);
+
+		int serial = sv_areaserial;
+		for (; i < last; i++)
+		{
+			moveclip_t *clip = &clips[i];
+			if (needLinks[i])
+			{
+				// pfnShouldCollide may relink entities, the collected links are stale then
+				if (serial == sv_areaserial)
+					SV_ClipToBatchLinks(clip);
+				else
+					SV_ClipToLinks(sv_areanodes, clip);
+
+				gGlobalVariables.trace_ent = clip->trace.ent;
+				clip->trace.fraction = worldFractions[i] * clip->trace.fraction;
+			}
+
+			traces[i] = clip->trace;
+		}
+	}
+}
+
+void SV_MoveBatch(const movebatch_t *moves, trace_t *traces, int count)
+{
+	for (int first = 0; first < count; first += MOVEBATCH_GROUP_SIZE)
+		SV_MoveBatchGroup(&moves[first], &traces[first], min(count - first, MOVEBATCH_GROUP_SIZE));
+}
@@ -34,6 +34,7 @@
 
 #include "maintypes.h"
 #include "model.h"
+#include "model_rehlds.h"
 
 
 /* <ca280> ../engine/world.h:15 */
@@ -64,6 +65,20 @@ typedef struct moveclip_s	// TODO: Move it to world.cpp someday
 	qboolean monsterClipBrush;
 } moveclip_t;
 
+#define MOVEBATCH_GROUP_SIZE	32
+
+// One move for SV_MoveBatch, arguments as for SV_Move. NULL mins/maxs make it a point move (SV_Move_Point)
+typedef struct movebatch_s
+{
+	const float *start;
+	const float *end;
+	const float *mins;
+	const float *maxs;
+	int type;
+	edict_t *passedict;
+	qboolean monsterClipBrush;
+} movebatch_t;
+
 typedef dclipnode_t box_clipnodes_t[6];
 typedef mplane_t box_planes_t[6];
 typedef mplane_t beam_planes_t[6];
@@ -87,6 +102,7 @@ extern box_planes_t box_planes;
 extern beam_planes_t beam_planes;
 extern areanode_t sv_areanodes[32];
 extern int sv_numareanodes;
+extern int sv_areaserial;
 /*
 hull_t                     box_hull;
 hull_t                     beam_hull;
@@ -123,9 +139,23 @@ void SV_ClipToWorldbrush(areanode_t *node, moveclip_t *clip);
 void SV_MoveBounds(const vec_t *start, const vec_t *mins, const vec_t *maxs, const vec_t *end, vec_t *boxmins, vec_t *boxmaxs);
 trace_t SV_MoveNoEnts(const vec_t *start, vec_t *mins, vec_t *maxs, const vec_t *end, int type, edict_t *passedict);
 trace_t SV_Move(const vec_t *start, const vec_t *mins, const vec_t *maxs, const vec_t *end, int type, edict_t *passedict, qboolean monsterClipBrush);
+trace_t SV_Move_Uncached(const vec_t *start, const vec_t *mins, const vec_t *maxs, const vec_t *end, int type, edict_t *passedict, qboolean monsterClipBrush);
+
+void SV_MoveBatch(const movebatch_t *moves, trace_t *traces, int count);
 
 #ifdef REHLDS_OPT_PEDANTIC
+int SV_HullPointContents_Packed(const hull_t *hull, const packedclipnode_t *nodes, int num, const vec_t *p);
+qboolean SV_RecursiveHullCheck_Unpacked(hull_t *hull, int num, float p1f, float p2f, const vec_t *p1, const vec_t *p2, trace_t *trace);
+qboolean SV_RecursiveHullCheck_Packed(const hull_t *hull, const packedclipnode_t *nodes, int num, float p1f, float p2f, const vec_t *p1, const vec_t *p2, trace_t *trace);
 trace_t SV_Move_Point(const vec_t *start, const vec_t *end, int type, edict_t *passedict);
+trace_t SV_Move_Point_Uncached(const vec_t *start, const vec_t *end, int type, edict_t *passedict);
+
+extern cvar_t sv_tracecache;
+
+void SV_TraceCacheFrameEnd(void);
+void SV_TraceCacheStats_f(void);
+void SV_InitTraceCache(void);
+trace_t SV_MoveCached(const vec_t *start, const vec_t *mins, const vec_t *maxs, const vec_t *end, int type, edict_t *passedict, qboolean monsterClipBrush);
 #endif // REHLDS_OPT_PEDANTIC
 
 #endif // WORLD_H
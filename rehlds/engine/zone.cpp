@@ -80,6 +80,150 @@ cvar_t mem_dbgfile;
 
 memzone_t *mainzone;
 
+#ifdef REHLDS_OPT_PEDANTIC
+/*
+Free blocks of the main zone are also kept in segregated lists, one per power of two of
+their size, so that Z_TagMalloc doesn't walk the block list. The block layout, tags and
+ZONEID markers are unchanged: Z_CheckHeap and Z_Print work as before.
+The list links live in the free block's payload.
+*/
+#define ZONE_NUM_BINS	32
+
+typedef struct zonefreelink_s
+{
+	memblock_t *nextfree;
+	memblock_t *prevfree;
+} zonefreelink_t;
+
+#define ZONE_FREELINK(block) ((zonefreelink_t *)((byte *)(block) + sizeof(memblock_t)))
+
+// smallest block that can hold the free list links
+#define ZONE_MIN_BLOCK	((int)((sizeof(memblock_t) + sizeof(zonefreelink_t) + 4 + 7) & ~7))
+
+memblock_t *zone_bins[ZONE_NUM_BINS];
+unsigned int zone_binmask;
+
+static int Z_BinForSize(int size)
+{
+	int bin = 0;
+	while (size > 1 && bin < ZONE_NUM_BINS - 1)
+	{
+		size >>= 1;
+		bin++;
+	}
+
+	return bin;
+}
+
+static void Z_LinkFree(memblock_t *block)
+{
+	int bin = Z_BinForSize(block->size);
+	zonefreelink_t *link = ZONE_FREELINK(block);
+
+	link->prevfree = NULL;
+	link->nextfree = zone_bins[bin];
+	if (zone_bins[bin])
+		ZONE_FREELINK(zone_bins[bin])->prevfree = block;
+
+	zone_bins[bin] = block;
+	zone_binmask |= 1u << bin;
+}
+
+static void Z_UnlinkFree(memblock_t *block)
+{
+	int bin = Z_BinForSize(block->size);
+	zonefreelink_t *link = ZONE_FREELINK(block);
+
+	if (link->prevfree)
+		ZONE_FREELINK(link->prevfree)->nextfree = link->nextfree;
+	else
+		zone_bins[bin] = link->nextfree;
+
+	if (link->nextfree)
+		ZONE_FREELINK(link->nextfree)->prevfree = link->prevfree;
+
+	if (!zone_bins[bin])
+		zone_binmask &= ~(1u << bin);
+}
+
+// First fit in the block's own bin, any block of a higher one
+static memblock_t *Z_FindFree(int size)
+{
+	int bin = Z_BinForSize(size);
+	for (memblock_t *block = zone_bins[bin]; block; block = ZONE_FREELINK(block)->nextfree)
+	{
+		if (block->size >= size)
+			return block;
+	}
+
+	unsigned int higher = (bin + 1 < ZONE_NUM_BINS) ? (zone_binmask & ~((2u << bin) - 1)) : 0;
+	if (!higher)
+		return NULL;
+
+	bin = 0;
+	while (!(higher & (1u << bin)))
+		bin++;
+
+	return zone_bins[bin];
+}
+
+/* zone_stats: fragmentation and per tag usage of the main zone */
+void Z_Stats_f(void)
+{
+	struct
+	{
+		int tag;
+		int blocks;
+		int bytes;
+	} tags[32];
+	int numtags = 0;
+	int usedblocks = 0, usedbytes = 0;
+	int freeblocks = 0, freebytes = 0, largestfree = 0;
+
+	for (memblock_t *block = mainzone->blocklist.next; block != &mainzone->blocklist; block = block->next)
+	{
+		if (!block->tag)
+		{
+			freeblocks++;
+			freebytes += block->size;
+			if (block->size > largestfree)
+				largestfree = block->size;
+
+			continue;
+		}
+
+		usedblocks++;
+		usedbytes += block->size;
+
+		int i;
+		for (i = 0; i < numtags; i++)
+		{
+			if (tags[i].tag == block->tag)
+				break;
+		}
+
+		if (i == numtags)
+		{
+			if (numtags == ARRAYSIZE(tags))
+				continue;
+
+			tags[numtags].tag = block->tag;
+			tags[numtags].blocks = 0;
+			tags[numtags].bytes = 0;
+			numtags++;
+		}
+
+		tags[i].blocks++;
+		tags[i].bytes += block->size;
+	}
+
+	Con_Printf("zone size: %i, used: %i bytes in %i blocks, free: %i bytes in %i blocks\n", mainzone->size, usedbytes, usedblocks, freebytes, freeblocks);
+	Con_Printf("largest free block: %i, fragmentation: %.1f%%\n", largestfree, freebytes ? (1.0 - (double)largestfree / freebytes) * 100.0 : 0.0);
+	for (int i = 0; i < numtags; i++)
+		Con_Printf("  tag %3i: %6i blocks, %8i bytes\n", tags[i].tag, tags[i].blocks, tags[i].bytes);
+}
+#endif // REHLDS_OPT_PEDANTIC
+
 /* <cd94b> ../engine/zone.c:71 */
 void Z_ClearZone(memzone_t *zone, int size)
 {
@@ -93,6 +237,13 @@ void Z_ClearZone(memzone_t *zone, int size)
 	block->tag = 0;
 	block->id = ZONEID;
 	block->size = size - sizeof(memzone_t);
+
+#ifdef REHLDS_OPT_PEDANTIC
+	zone->size = size;
+	Q_memset(zone_bins, 0, sizeof(zone_bins));
+	zone_binmask = 0;
+	Z_LinkFree(block);
+#endif // REHLDS_OPT_PEDANTIC
 }
 
 /* <cdb66> ../engine/zone.c:96 */
@@ -119,6 +270,15 @@ void Z_Free(void *ptr)
 
 	memblock_t *otherblock = block->prev;
 
+#ifdef REHLDS_OPT_PEDANTIC
+	// neighbours change size when merged, take them out of their bins first
+	if (!otherblock->tag)
+		Z_UnlinkFree(otherblock);
+
+	if (!block->next->tag)
+		Z_UnlinkFree(block->next);
+#endif // REHLDS_OPT_PEDANTIC
+
 	if (!otherblock->tag)
 	{
 		otherblock->size += block->size;
@@ -146,12 +306,19 @@ void Z_Free(void *ptr)
 			mainzone->rover = block;
 		}
 	}
+
+#ifdef REHLDS_OPT_PEDANTIC
+	Z_LinkFree(block);
+#endif // REHLDS_OPT_PEDANTIC
 }
 
 /* <cdbc6> ../engine/zone.c:139 */
 void *Z_Malloc(int size)
 {
+#if !defined(REHLDS_OPT_PEDANTIC) || defined(_DEBUG)
+	// walks the whole zone, keep it for debug builds only
 	Z_CheckHeap();
+#endif
 
 	void *buf = Z_TagMalloc(size, 1);
 
@@ -168,7 +335,10 @@ void *Z_Malloc(int size)
 void *Z_TagMalloc(int size, int tag)
 {
 	int extra;
-	memblock_t *start, *rover, *newz, *base;
+	memblock_t *newz, *base;
+#ifndef REHLDS_OPT_PEDANTIC
+	memblock_t *start, *rover;
+#endif // REHLDS_OPT_PEDANTIC
 
 	if (tag == 0)
 	{
@@ -179,6 +349,40 @@ void *Z_TagMalloc(int size, int tag)
 	size += 4;
 	size = (size + 7) & ~7;
 
+#ifdef REHLDS_OPT_PEDANTIC
+	if (size < ZONE_MIN_BLOCK)
+		size = ZONE_MIN_BLOCK;
+
+	base = Z_FindFree(size);
+	if (!base)
+		return NULL;
+
+	Z_UnlinkFree(base);
+
+	extra = base->size - size;
+	if (extra > MINFRAGMENT)
+	{
+		newz = (memblock_t *)((byte *)base + size);
+		newz->size = extra;
+		newz->tag = 0;
+		newz->prev = base;
+		newz->id = ZONEID;
+		newz->next = base->next;
+		newz->next->prev = newz;
+		base->next = newz;
+		base->size = size;
+		Z_LinkFree(newz);
+	}
+
+	base->tag = tag;
+	mainzone->rover = base->next;
+	base->id = ZONEID;
+
+	// marker for memory trash testing
+	*(int *)((byte *)base + base->size - 4) = ZONEID;
+
+	return (void *)((byte *)base + sizeof(memblock_t));
+#else // REHLDS_OPT_PEDANTIC
 	base = rover = mainzone->rover;
 	start = base->prev;
 
@@ -222,6 +426,7 @@ void *Z_TagMalloc(int size, int tag)
 	*(int *)((byte *)base + base->size - 4) = ZONEID;
 
 	return (void *)((byte *)base + sizeof(memblock_t));
+#endif // REHLDS_OPT_PEDANTIC
 }
 
 /* <cdcc9> ../engine/zone.c:216 */
@@ -972,6 +1177,9 @@ void Cache_Init(void)
 	cache_head.lru_next = cache_head.lru_prev = &cache_head;
 
 	Cmd_AddCommand("flush", Cache_Flush);
+#ifdef REHLDS_OPT_PEDANTIC
+	Cmd_AddCommand("zone_stats", Z_Stats_f);
+#endif // REHLDS_OPT_PEDANTIC
 }
 
 /*
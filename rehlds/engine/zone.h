@@ -72,6 +72,9 @@ void *Z_Malloc(int size);
 void *Z_TagMalloc(int size, int tag);
 NOXREF void Z_Print(memzone_t *zone);
 void Z_CheckHeap(void);
+#ifdef REHLDS_OPT_PEDANTIC
+void Z_Stats_f(void);
+#endif // REHLDS_OPT_PEDANTIC
 
 void Hunk_Check(void);
 NOXREF void Hunk_Print(qboolean all);
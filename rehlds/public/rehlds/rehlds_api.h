@@ -35,7 +35,7 @@
 #include "model.h"
 
 #define REHLDS_API_VERSION_MAJOR 2
-#define REHLDS_API_VERSION_MINOR 2
+#define REHLDS_API_VERSION_MINOR 4
 
 //Steam_NotifyClientConnect hook
 typedef IHookChain<qboolean, IGameClient*, const void*, unsigned int> IRehldsHook_Steam_NotifyClientConnect;
@@ -178,6 +178,15 @@ public:
 	virtual IRehldsHookRegistry_GenericFileConsistencyResponce* GenericFileConsistencyResponce() = 0;
 };
 
+// Request for RehldsFuncs_t::TraceBatch
+struct RehldsTraceRequest_t {
+	vec3_t start;
+	vec3_t end;
+	int hullNumber;		// -1 traces a line like pfnTraceLine, 0..3 traces a hull like pfnTraceHull
+	int fNoMonsters;
+	edict_t* pentToSkip;
+};
+
 struct RehldsFuncs_t {
 	void(*DropClient)(IGameClient* cl, bool crash, const char* fmt, ...);
 	void(*RejectConnection)(netadr_t *adr, char *fmt, ...);
@@ -211,6 +220,9 @@ struct RehldsFuncs_t {
 	void*(*SZ_GetSpace)(sizebuf_t *buf, int length);
 	cvar_t*(*GetCvarVars)();
 	int (*SV_GetChallenge)(const netadr_t& adr);
+
+	// Results match pfnTraceLine/pfnTraceHull called for each request in order; gpGlobals->trace_* keep the values they had before the call
+	void(*TraceBatch)(const RehldsTraceRequest_t* requests, TraceResult* results, int count);
 };
 
 class IRehldsApi {
@@ -101,6 +101,20 @@ public:
 	virtual int GetIndexOfClient_t(client_t* client) = 0;
 };
 
+// CPU usage over the last sv_stats sample (about one second). Percentages are fractions of one core.
+// On Windows only interval and cpuPercent are filled in
+struct RehldsCpuStats_t {
+	double interval;			// wall clock seconds covered by the sample
+	double cpuPercent;			// whole process, over interval (the stats command averages over up to 5 seconds)
+	double mainThreadPercent;
+	double workerPercent;		// parallel load-time workers and the async thread
+	double netThreadPercent;	// -net_thread receive thread
+	int voluntarySwitches;
+	int involuntarySwitches;
+	int minorFaults;
+	int majorFaults;
+};
+
 class IRehldsServerData {
 public:
 	virtual ~IRehldsServerData() { }
@@ -113,4 +127,7 @@ public:
 	virtual sizebuf_t* GetReliableDatagram() = 0;
 
 	virtual void SetModelName(const char* modelname) = 0;
+
+	// Filled in while sv_stats is 1, zeroed otherwise
+	virtual void GetCpuStats(RehldsCpuStats_t* stats) = 0;
 };
@@ -0,0 +1,102 @@
+/*
+*
+*    This program is free software; you can redistribute it and/or modify it
+*    under the terms of the GNU General Public License as published by the
+*    Free Software Foundation; either version 2 of the License, or (at
+*    your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful, but
+*    WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+*    General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program; if not, write to the Free Software Foundation,
+*    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*    In addition, as a special exception, the author gives permission to
+*    link the code of this program with the Half-Life Game Engine ("HL
+*    Engine") and Modified Game Libraries ("MODs") developed by Valve,
+*    L.L.C ("Valve").  You must obey the GNU General Public License in all
+*    respects for all of the code used other than the HL Engine and MODs
+*    from Valve.  If you modify this file, you may extend this exception
+*    to your version of the file, but you are not obligated to do so.  If
+*    you do not wish to do so, delete this exception statement from your
+*    version.
+*
+*/
+#pragma once
+
+#include "archtypes.h"
+#include <atomic>
+
+/*
+Server metrics published for external monitoring agents, enabled with sys_metrics 1.
+The block lives in a shared memory segment named rehlds_metrics_<port>
+(shm_open("/rehlds_metrics_27015") on Linux, OpenFileMapping("Local\\rehlds_metrics_27015")
+on Windows) and is rewritten once per server frame. Counters are monotonic since the
+segment was created, readers derive rates from the difference between two samples.
+
+The writer bumps sequence to an odd value before it touches the block and to the next
+even value when it is done. Readers copy the block and retry when the sequence was odd
+or changed during the copy:
+
+	do {
+		seq = m->sequence.load(std::memory_order_acquire);
+		memcpy(&copy, m, sizeof(copy));
+		std::atomic_thread_fence(std::memory_order_acquire);
+	} while ((seq & 1) || seq != m->sequence.load(std::memory_order_relaxed));
+
+The layout only grows at the end; readers should check magic, version and that size
+is not smaller than the structure they were built against.
+*/
+
+#define REHLDS_METRICS_MAGIC		0x4D444852	// "RHDM"
+#define REHLDS_METRICS_VERSION		1
+#define REHLDS_METRICS_MAX_CLIENTS	32
+
+struct rehlds_metrics_client_t {
+	uint32 active;				// 1 while the slot holds a connected, non-fake client
+	int32 userid;
+	char name[32];
+	int32 ping;					// ms, the value status shows
+	int32 loss;					// percent
+	int32 rate;					// bytes per second
+	int32 updaterate;			// updates per second
+	uint32 sentPackets;			// netchan outgoing sequence
+	uint32 chokedPackets;		// packets skipped by the rate limit since the client connected
+	float inKBytesPerSec;
+	float outKBytesPerSec;
+	float connectedTime;		// seconds
+	int32 reserved;
+};
+
+struct rehlds_metrics_t {
+	uint32 magic;
+	uint32 version;
+	uint32 size;				// sizeof(rehlds_metrics_t) of the writer
+	std::atomic<uint32> sequence;	// odd while the block is being updated
+
+	int64 frameCount;
+	double realtime;
+
+	float frameTimeMs;			// time spent in the last server frame
+	float frameIntervalMs;		// host_frametime
+	float cpuPercent;			// whole process over the last sv_stats sample, fraction of one core
+	float mainThreadPercent;
+
+	int32 numEdicts;
+	int32 maxEdicts;
+	int32 numClients;
+	int32 maxClients;
+
+	int64 packetsIn;			// server socket traffic, including connectionless packets
+	int64 packetsOut;
+	int64 bytesIn;
+	int64 bytesOut;
+	int64 entityBytes;			// delta-encoded packet entities written to clients
+
+	char map[64];
+
+	rehlds_metrics_client_t clients[REHLDS_METRICS_MAX_CLIENTS];
+};
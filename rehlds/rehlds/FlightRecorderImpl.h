@@ -121,4 +121,38 @@ public:
 	virtual void WriteString(const char* s);
 
 	virtual uint16 RegisterMessage(const char* module, const char *message, unsigned int version, bool inOut);
+
+	// Fast path for the engine's own messages: opcode, payload and length are written with a single
+	// space check and no virtual calls. Main thread only, not allowed while a message is open
+	void WriteMessage(uint16 msg, bool entrance, const void* data1, unsigned int len1, const void* data2 = NULL, unsigned int len2 = 0) {
+		if (m_pRecorderState->curMessage != 0) {
+			rehlds_syserror("%s: overlapping messages", __FUNCTION__);
+		}
+
+		unsigned int msgSize = 2 + len1 + len2;
+		if (msgSize > MSG_MAX_SIZE) {
+			rehlds_syserror("%s: too big message %u; size%u", __FUNCTION__, msg, msgSize);
+		}
+
+		if (DATA_REGION_MAIN_SIZE - m_pRecorderState->wpos < msgSize + 2) {
+			MoveToStart();
+		}
+
+		uint8* p = m_DataRegionPtr + m_pRecorderState->wpos;
+		*(uint16*)p = entrance ? (msg | 0x8000) : msg;
+		memcpy(p + 2, data1, len1);
+		if (len2) {
+			memcpy(p + 2 + len1, data2, len2);
+		}
+		*(uint16*)(p + msgSize) = msgSize;
+
+		// wpos moves last so a crash dump never contains a half-written message
+		m_pRecorderState->lastMsgBeginPos = m_pRecorderState->wpos;
+		m_pRecorderState->wpos += msgSize + 2;
+	}
+
+	template<typename T>
+	void WriteMessage(uint16 msg, bool entrance, const T& payload) {
+		WriteMessage(msg, entrance, &payload, sizeof(T));
+	}
 };
@@ -44,6 +44,14 @@ void CRehldsRuntimeConfig::parseFromCommandLine(const char* cmdLine) {
 			testRecordingFileName[sizeof(testRecordingFileName) - 1] = 0;
 			testPlayerMode = TPM_ANONYMIZE;
 		}
+		else if (!strcmp(token, "--rehlds-test-bench"))
+		{
+			const char* fname = getNextToken(&cpos);
+			if (fname == NULL) rehlds_syserror("%s: usage: --rehlds-test-bench <filename>", __FUNCTION__);
+			strncpy(testRecordingFileName, fname, sizeof(testRecordingFileName));
+			testRecordingFileName[sizeof(testRecordingFileName) - 1] = 0;
+			testPlayerMode = TPM_BENCHMARK;
+		}
 		else if (!strcmp(token, "--rehlds-disable-all-hooks"))
 		{
 			disableAllHooks = true;
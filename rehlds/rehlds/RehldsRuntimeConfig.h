@@ -5,6 +5,7 @@ enum TestPlayerMode {
 	TPM_RECORD,
 	TPM_PLAY,
 	TPM_ANONYMIZE,
+	TPM_BENCHMARK,	// TPM_PLAY with the frame profiler forced on, reports frames/sec and phase timings at the end
 };
 
 class CRehldsRuntimeConfig {
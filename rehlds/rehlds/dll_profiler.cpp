@@ -0,0 +1,305 @@
+/*
+*
+*    This program is free software; you can redistribute it and/or modify it
+*    under the terms of the GNU General Public License as published by the
+*    Free Software Foundation; either version 2 of the License, or (at
+*    your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful, but
+*    WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+*    General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program; if not, write to the Free Software Foundation,
+*    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+#include "precompiled.h"
+
+cvar_t sys_profile_dll = { "sys_profile_dll", "0", 0, 0.0f, NULL };
+
+#define DLL_PROFILE_FUNCTIONS(X) \
+	X(pfnGameInit) X(pfnSpawn) X(pfnThink) X(pfnUse) X(pfnTouch) X(pfnBlocked) X(pfnKeyValue) X(pfnSave) \
+	X(pfnRestore) X(pfnSetAbsBox) X(pfnSaveWriteFields) X(pfnSaveReadFields) X(pfnSaveGlobalState) \
+	X(pfnRestoreGlobalState) X(pfnResetGlobalState) X(pfnClientConnect) X(pfnClientDisconnect) X(pfnClientKill) \
+	X(pfnClientPutInServer) X(pfnClientCommand) X(pfnClientUserInfoChanged) X(pfnServerActivate) \
+	X(pfnServerDeactivate) X(pfnPlayerPreThink) X(pfnPlayerPostThink) X(pfnStartFrame) X(pfnParmsNewLevel) \
+	X(pfnParmsChangeLevel) X(pfnGetGameDescription) X(pfnPlayerCustomization) X(pfnSpectatorConnect) \
+	X(pfnSpectatorDisconnect) X(pfnSpectatorThink) X(pfnSys_Error) X(pfnPM_Move) X(pfnPM_Init) \
+	X(pfnPM_FindTextureType) X(pfnSetupVisibility) X(pfnUpdateClientData) X(pfnAddToFullPack) \
+	X(pfnCreateBaseline) X(pfnRegisterEncoders) X(pfnGetWeaponData) X(pfnCmdStart) X(pfnCmdEnd) \
+	X(pfnConnectionlessPacket) X(pfnGetHullBounds) X(pfnCreateInstancedBaselines) X(pfnInconsistentFile) \
+	X(pfnAllowLagCompensation)
+
+#define DLL_PROFILE_NEW_FUNCTIONS(X) \
+	X(pfnOnFreeEntPrivateData) X(pfnGameShutdown) X(pfnShouldCollide) X(pfnCvarValue) X(pfnCvarValue2)
+
+#define DLL_PROFILE_ENUM(name) DLLPROF_##name,
+#define DLL_PROFILE_NEW_ENUM(name) DLLPROF_NEW_##name,
+#define DLL_PROFILE_NAME(name) #name,
+
+enum DllProfileFunc {
+	DLL_PROFILE_FUNCTIONS(DLL_PROFILE_ENUM)
+	DLL_PROFILE_NEW_FUNCTIONS(DLL_PROFILE_NEW_ENUM)
+
+	DLLPROF_NUM_FUNCS
+};
+
+// The lists must follow the table layouts, entries are also looked up by index
+static_assert(DLLPROF_NEW_pfnOnFreeEntPrivateData * sizeof(void *) == sizeof(DLL_FUNCTIONS), "DLL_FUNCTIONS list is out of date");
+static_assert((DLLPROF_NUM_FUNCS - DLLPROF_NEW_pfnOnFreeEntPrivateData) * sizeof(void *) == sizeof(NEW_DLL_FUNCTIONS), "NEW_DLL_FUNCTIONS list is out of date");
+
+static const char *g_DllProfileNames[DLLPROF_NUM_FUNCS] = {
+	DLL_PROFILE_FUNCTIONS(DLL_PROFILE_NAME)
+	DLL_PROFILE_NEW_FUNCTIONS(DLL_PROFILE_NAME)
+};
+
+struct DllProfileCounter {
+	int64 calls;
+	int64 time;	// ns, without nested DLL callbacks
+	int64 lastCalls;
+	int64 lastTime;
+};
+
+static DllProfileCounter g_DllProfileCounters[DLLPROF_NUM_FUNCS];
+
+// Tables the thunks forward to, saved when they were installed
+DLL_FUNCTIONS g_DllProfileEntityInterface;
+NEW_DLL_FUNCTIONS g_DllProfileNewDLLFunctions;
+
+static bool g_DllProfileInstalled;
+static int64 g_DllProfileNestedTime;
+static int64 g_DllProfileWindowStart;
+static double g_DllProfileWindowSeconds;
+
+class CDllProfileScope {
+public:
+	CDllProfileScope(int func) {
+		m_Func = func;
+		m_SavedNestedTime = g_DllProfileNestedTime;
+		m_Start = FrameProfile_Now();
+	}
+
+	~CDllProfileScope() {
+		int64 elapsed = FrameProfile_Now() - m_Start;
+		DllProfileCounter *counter = &g_DllProfileCounters[m_Func];
+		counter->calls++;
+		counter->time += elapsed - (g_DllProfileNestedTime - m_SavedNestedTime);
+		g_DllProfileNestedTime = m_SavedNestedTime + elapsed;
+	}
+
+private:
+	int m_Func;
+	int64 m_Start;
+	int64 m_SavedNestedTime;
+};
+
+// One instantiation per table entry, the signature is taken from the field type
+template<typename Table, typename F, F Table::*Field, Table *Orig, int Func>
+struct CDllProfileThunk;
+
+template<typename Table, typename R, typename ...A, R (*Table::*Field)(A...), Table *Orig, int Func>
+struct CDllProfileThunk<Table, R (*)(A...), Field, Orig, Func> {
+	static R call(A... args) {
+		CDllProfileScope scope(Func);
+		return (Orig->*Field)(args...);
+	}
+};
+
+#define DLL_PROFILE_INSTALL(name) \
+	if (gEntityInterface.name) \
+		gEntityInterface.name = CDllProfileThunk<DLL_FUNCTIONS, decltype(DLL_FUNCTIONS::name), &DLL_FUNCTIONS::name, &g_DllProfileEntityInterface, DLLPROF_##name>::call;
+
+#define DLL_PROFILE_NEW_INSTALL(name) \
+	if (gNewDLLFunctions.name) \
+		gNewDLLFunctions.name = CDllProfileThunk<NEW_DLL_FUNCTIONS, decltype(NEW_DLL_FUNCTIONS::name), &NEW_DLL_FUNCTIONS::name, &g_DllProfileNewDLLFunctions, DLLPROF_NEW_##name>::call;
+
+// Entries replaced since the install (a metamod plugin loading, for one) are left to whoever replaced them
+#define DLL_PROFILE_REMOVE(name) \
+	if (gEntityInterface.name == CDllProfileThunk<DLL_FUNCTIONS, decltype(DLL_FUNCTIONS::name), &DLL_FUNCTIONS::name, &g_DllProfileEntityInterface, DLLPROF_##name>::call) \
+		gEntityInterface.name = g_DllProfileEntityInterface.name;
+
+#define DLL_PROFILE_NEW_REMOVE(name) \
+	if (gNewDLLFunctions.name == CDllProfileThunk<NEW_DLL_FUNCTIONS, decltype(NEW_DLL_FUNCTIONS::name), &NEW_DLL_FUNCTIONS::name, &g_DllProfileNewDLLFunctions, DLLPROF_NEW_##name>::call) \
+		gNewDLLFunctions.name = g_DllProfileNewDLLFunctions.name;
+
+static void DllProfile_Install() {
+	g_DllProfileEntityInterface = gEntityInterface;
+	g_DllProfileNewDLLFunctions = gNewDLLFunctions;
+
+	DLL_PROFILE_FUNCTIONS(DLL_PROFILE_INSTALL)
+	DLL_PROFILE_NEW_FUNCTIONS(DLL_PROFILE_NEW_INSTALL)
+
+	g_DllProfileInstalled = true;
+}
+
+static void DllProfile_Remove() {
+	DLL_PROFILE_FUNCTIONS(DLL_PROFILE_REMOVE)
+	DLL_PROFILE_NEW_FUNCTIONS(DLL_PROFILE_NEW_REMOVE)
+
+	g_DllProfileInstalled = false;
+}
+
+void Sys_ModuleNameForAddress(void *addr, char *buf, int bufSize) {
+	const char *path = NULL;
+
+#ifdef _WIN32
+	char fileName[MAX_PATH];
+	HMODULE module;
+	if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, (LPCSTR)addr, &module)
+		&& GetModuleFileNameA(module, fileName, sizeof(fileName))) {
+		path = fileName;
+	}
+#else // _WIN32
+	Dl_info info;
+	if (dladdr(addr, &info) && info.dli_fname) {
+		path = info.dli_fname;
+	}
+#endif // _WIN32
+
+	if (!path) {
+		Q_snprintf(buf, bufSize, "%p", addr);
+		return;
+	}
+
+	const char *name = path;
+	for (const char *c = path; *c; c++) {
+		if (*c == '/' || *c == '\\')
+			name = c + 1;
+	}
+
+	Q_strncpy(buf, name, bufSize - 1);
+	buf[bufSize - 1] = 0;
+}
+
+static void DllProfile_Roll(int64 now) {
+	g_DllProfileWindowSeconds = (now - g_DllProfileWindowStart) / 1000000000.0;
+	g_DllProfileWindowStart = now;
+
+	for (int i = 0; i < DLLPROF_NUM_FUNCS; i++) {
+		DllProfileCounter *counter = &g_DllProfileCounters[i];
+		counter->lastCalls = counter->calls;
+		counter->lastTime = counter->time;
+		counter->calls = 0;
+		counter->time = 0;
+	}
+
+	for (AbstractHookChainRegistry *reg = AbstractHookChainRegistry::getFirst(); reg; reg = reg->getNext())
+		reg->rollStats();
+}
+
+void DllProfile_Frame() {
+	bool enable = sys_profile_dll.value != 0.0f;
+	if (enable != g_DllProfileInstalled) {
+		if (enable)
+			DllProfile_Install();
+		else
+			DllProfile_Remove();
+	}
+
+	if (!enable && rehlds_hookchain_timing.value == 0.0f)
+		return;
+
+	int64 now = FrameProfile_Now();
+	if (now - g_DllProfileWindowStart >= 1000000000LL)
+		DllProfile_Roll(now);
+}
+
+struct DllProfileEntry {
+	char name[64];
+	char module[64];
+	int64 calls;
+	int64 time;
+};
+
+static int DllProfile_CompareEntries(const void *a, const void *b) {
+	int64 ta = ((const DllProfileEntry *)a)->time;
+	int64 tb = ((const DllProfileEntry *)b)->time;
+	return (ta < tb) ? 1 : (ta > tb) ? -1 : 0;
+}
+
+static void DllProfile_Top_f() {
+	static DllProfileEntry entries[DLLPROF_NUM_FUNCS + 32 * (MAX_HOOKS_IN_CHAIN + 1)];
+	int numEntries = 0;
+
+	if (sys_profile_dll.value == 0.0f && rehlds_hookchain_timing.value == 0.0f) {
+		Con_Printf("Set sys_profile_dll 1 and/or rehlds_hookchain_timing 1 to collect callback times\n");
+		return;
+	}
+
+	if (g_DllProfileWindowSeconds <= 0.0) {
+		Con_Printf("No complete measurement window yet\n");
+		return;
+	}
+
+	int count = (Cmd_Argc() > 1) ? Q_atoi(Cmd_Argv(1)) : 20;
+
+	for (int i = 0; i < DLLPROF_NUM_FUNCS; i++) {
+		DllProfileCounter *counter = &g_DllProfileCounters[i];
+		if (!counter->lastCalls)
+			continue;
+
+		// The saved tables still hold the real callbacks, which may belong to metamod rather than the mod
+		void *func = (i < DLLPROF_NEW_pfnOnFreeEntPrivateData)
+			? ((void **)&g_DllProfileEntityInterface)[i]
+			: ((void **)&g_DllProfileNewDLLFunctions)[i - DLLPROF_NEW_pfnOnFreeEntPrivateData];
+
+		DllProfileEntry *entry = &entries[numEntries++];
+		Q_strncpy(entry->name, g_DllProfileNames[i], sizeof(entry->name) - 1);
+		entry->name[sizeof(entry->name) - 1] = 0;
+		Sys_ModuleNameForAddress(func, entry->module, sizeof(entry->module));
+		entry->calls = counter->lastCalls;
+		entry->time = counter->lastTime;
+	}
+
+	for (AbstractHookChainRegistry *reg = AbstractHookChainRegistry::getFirst(); reg; reg = reg->getNext()) {
+		for (int i = 0; i < reg->getNumHooks() && numEntries < (int)ARRAYSIZE(entries); i++) {
+			const hookchain_stats_t *stats = reg->getStats(i);
+			if (!stats->lastCalls)
+				continue;
+
+			DllProfileEntry *entry = &entries[numEntries++];
+			Q_snprintf(entry->name, sizeof(entry->name), "hook %s #%d", reg->getName(), i);
+			Sys_ModuleNameForAddress(reg->getHook(i), entry->module, sizeof(entry->module));
+			entry->calls = stats->lastCalls;
+			entry->time = stats->lastTime;
+		}
+	}
+
+	qsort(entries, numEntries, sizeof(entries[0]), DllProfile_CompareEntries);
+
+	double window = g_DllProfileWindowSeconds;
+	Con_Printf("%-40s %-24s %10s %10s %8s %10s\n", "callback", "module", "calls/s", "ms/s", "cpu%", "us/call");
+	for (int i = 0; i < numEntries && i < count; i++) {
+		DllProfileEntry *entry = &entries[i];
+		double msPerSec = entry->time / 1000000.0 / window;
+		Con_Printf("%-40s %-24s %10.0f %10.3f %8.2f %10.2f\n", entry->name, entry->module,
+			entry->calls / window, msPerSec, msPerSec / 10.0, entry->time / 1000.0 / entry->calls);
+	}
+
+	// Same entries summed per module
+	Con_Printf("\n%-24s %10s %8s\n", "module", "ms/s", "cpu%");
+	for (int i = 0; i < numEntries; i++) {
+		if (!entries[i].module[0])
+			continue;
+
+		int64 time = 0;
+		for (int j = i; j < numEntries; j++) {
+			if (j != i && Q_strcmp(entries[j].module, entries[i].module))
+				continue;
+
+			time += entries[j].time;
+			if (j != i)
+				entries[j].module[0] = 0;
+		}
+
+		double msPerSec = time / 1000000.0 / window;
+		Con_Printf("%-24s %10.3f %8.2f\n", entries[i].module, msPerSec, msPerSec / 10.0);
+	}
+}
+
+void DllProfile_Init() {
+	Cvar_RegisterVariable(&sys_profile_dll);
+	Cmd_AddCommand("sys_profile_dll_top", DllProfile_Top_f);
+}
@@ -0,0 +1,37 @@
+/*
+*
+*    This program is free software; you can redistribute it and/or modify it
+*    under the terms of the GNU General Public License as published by the
+*    Free Software Foundation; either version 2 of the License, or (at
+*    your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful, but
+*    WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+*    General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program; if not, write to the Free Software Foundation,
+*    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+#pragma once
+#include "osconfig.h"
+#include "archtypes.h"
+
+/*
+Game DLL callback profiler. While sys_profile_dll is set, gEntityInterface and gNewDLLFunctions
+point to thunks that count calls and self time of each callback, then forward to the saved
+table; with the cvar off the original tables are restored and nothing is measured. Counters
+are rolled once per second together with the hookchain timings (rehlds_hookchain_timing).
+*/
+
+extern cvar_t sys_profile_dll;
+
+extern void DllProfile_Init();
+
+// Installs/removes the thunks and closes the per-second window, call after each server frame
+extern void DllProfile_Frame();
+
+// Writes the file name (without path) of the module containing addr into buf
+extern void Sys_ModuleNameForAddress(void *addr, char *buf, int bufSize);
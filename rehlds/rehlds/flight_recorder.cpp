@@ -17,10 +17,22 @@
 */
 #include "precompiled.h"
 
+#include "stdsani_in.h"
+#include <atomic>
+#include <thread>
+#include "stdsani_out.h"
+
 CRehldsFlightRecorder* g_FlightRecorder;
 
+#ifdef REHLDS_FLIGHT_REC
+static std::thread::id g_FRMainThread;
+#endif
+
 void FR_Init() {
 	g_FlightRecorder = new CRehldsFlightRecorder();
+#ifdef REHLDS_FLIGHT_REC
+	g_FRMainThread = std::this_thread::get_id();
+#endif
 }
 
 void FR_Shutdown() {
@@ -39,6 +51,50 @@ uint16 g_FRMsg_Log;
 
 cvar_t rehlds_flrec_frame = { "rehlds_flrec_frame", "1", 0, 1.0f, NULL };
 cvar_t rehlds_flrec_pvdata = { "rehlds_flrec_privdata", "1", 0, 1.0f, NULL };
+
+#pragma pack(push, 1)
+struct fr_frame_start_t {
+	int64 frameCounter;
+	double realtime;
+	double wallTime;
+};
+
+struct fr_frame_end_t {
+	int64 frameCounter;
+	double wallTime;
+};
+
+struct fr_alloc_privdata_t {
+	uint32 pPrivData;
+	int32 size;
+};
+#pragma pack(pop)
+
+#define FR_THREAD_BUFFERS		16
+#define FR_THREAD_BUFFER_SIZE	(16 * 1024) // must be a power of two
+#define FR_THREAD_MSG_MAX		4096
+
+enum fr_threadbuf_state_t {
+	FRTB_FREE,
+	FRTB_CLAIMING,
+	FRTB_OWNED,
+	FRTB_RETIRED,	// owner thread is gone, the main thread frees the slot once it is drained
+};
+
+// Single producer (the owning thread), single consumer (the main thread).
+// Records are [opcode:2][length:2][payload] and get copied into the main region by FR_FlushThreadBuffers
+struct fr_threadbuf_t {
+	std::atomic<int> state;
+	std::thread::id owner;
+	std::atomic<uint32> head;
+	std::atomic<uint32> tail;
+	uint8 data[FR_THREAD_BUFFER_SIZE];
+};
+
+static fr_threadbuf_t g_FRThreadBuffers[FR_THREAD_BUFFERS];
+static std::atomic<int> g_FRThreadBuffersUsed;
+static std::atomic<uint32> g_FRThreadDropped;
+
 void FR_CheckInit() {
 #if defined(HOOK_ENGINE)
 	if (!g_FlightRecorder) {
@@ -47,6 +103,120 @@ void FR_CheckInit() {
 #endif
 }
 
+static fr_threadbuf_t* FR_GetThreadBuffer() {
+	std::thread::id self = std::this_thread::get_id();
+	for (int i = 0; i < FR_THREAD_BUFFERS; i++) {
+		fr_threadbuf_t* buf = &g_FRThreadBuffers[i];
+		if (buf->state.load(std::memory_order_acquire) == FRTB_OWNED && buf->owner == self) {
+			return buf;
+		}
+	}
+
+	for (int i = 0; i < FR_THREAD_BUFFERS; i++) {
+		fr_threadbuf_t* buf = &g_FRThreadBuffers[i];
+		int expected = FRTB_FREE;
+		if (buf->state.compare_exchange_strong(expected, FRTB_CLAIMING)) {
+			buf->owner = self;
+			buf->head.store(0, std::memory_order_relaxed);
+			buf->tail.store(0, std::memory_order_relaxed);
+			g_FRThreadBuffersUsed++;
+			buf->state.store(FRTB_OWNED, std::memory_order_release);
+			return buf;
+		}
+	}
+
+	return NULL;
+}
+
+static void FR_RingWrite(fr_threadbuf_t* buf, uint32 pos, const void* data, unsigned int len) {
+	uint32 offset = pos & (FR_THREAD_BUFFER_SIZE - 1);
+	unsigned int first = min(len, FR_THREAD_BUFFER_SIZE - offset);
+	memcpy(buf->data + offset, data, first);
+	memcpy(buf->data, (const uint8*)data + first, len - first);
+}
+
+static void FR_RingRead(fr_threadbuf_t* buf, uint32 pos, void* data, unsigned int len) {
+	uint32 offset = pos & (FR_THREAD_BUFFER_SIZE - 1);
+	unsigned int first = min(len, FR_THREAD_BUFFER_SIZE - offset);
+	memcpy(data, buf->data + offset, first);
+	memcpy((uint8*)data + first, buf->data, len - first);
+}
+
+static void FR_ThreadWriteMessage(uint16 msg, bool entrance, const void* data1, unsigned int len1, const void* data2, unsigned int len2) {
+	unsigned int len = len1 + len2;
+	fr_threadbuf_t* buf = (len <= FR_THREAD_MSG_MAX) ? FR_GetThreadBuffer() : NULL;
+	if (!buf) {
+		g_FRThreadDropped++;
+		return;
+	}
+
+	uint32 head = buf->head.load(std::memory_order_relaxed);
+	uint32 tail = buf->tail.load(std::memory_order_acquire);
+	if (FR_THREAD_BUFFER_SIZE - (head - tail) < len + 4) {
+		g_FRThreadDropped++;
+		return;
+	}
+
+	uint16 hdr[2] = { (uint16)(entrance ? (msg | 0x8000) : msg), (uint16)len };
+	FR_RingWrite(buf, head, hdr, sizeof(hdr));
+	FR_RingWrite(buf, head + 4, data1, len1);
+	FR_RingWrite(buf, head + 4 + len1, data2, len2);
+	buf->head.store(head + 4 + len, std::memory_order_release);
+}
+
+// Routes a message to the main region or, off the main thread, to the calling thread's buffer
+static void FR_WriteMessage(uint16 msg, bool entrance, const void* data1, unsigned int len1, const void* data2 = NULL, unsigned int len2 = 0) {
+	if (std::this_thread::get_id() == g_FRMainThread) {
+		g_FlightRecorder->WriteMessage(msg, entrance, data1, len1, data2, len2);
+	} else {
+		FR_ThreadWriteMessage(msg, entrance, data1, len1, data2, len2);
+	}
+}
+
+void FR_ThreadExit() {
+	std::thread::id self = std::this_thread::get_id();
+	for (int i = 0; i < FR_THREAD_BUFFERS; i++) {
+		fr_threadbuf_t* buf = &g_FRThreadBuffers[i];
+		if (buf->state.load(std::memory_order_acquire) == FRTB_OWNED && buf->owner == self) {
+			buf->state.store(FRTB_RETIRED, std::memory_order_release);
+			return;
+		}
+	}
+}
+
+void FR_FlushThreadBuffers() {
+	if (!g_FlightRecorder || g_FRThreadBuffersUsed.load(std::memory_order_relaxed) == 0) {
+		return;
+	}
+
+	static uint8 msgData[FR_THREAD_MSG_MAX];
+	for (int i = 0; i < FR_THREAD_BUFFERS; i++) {
+		fr_threadbuf_t* buf = &g_FRThreadBuffers[i];
+
+		// State is read before head: once RETIRED is seen, head is final
+		int state = buf->state.load(std::memory_order_acquire);
+		if (state != FRTB_OWNED && state != FRTB_RETIRED) {
+			continue;
+		}
+
+		uint32 tail = buf->tail.load(std::memory_order_relaxed);
+		uint32 head = buf->head.load(std::memory_order_acquire);
+		while (tail != head) {
+			uint16 hdr[2];
+			FR_RingRead(buf, tail, hdr, sizeof(hdr));
+			FR_RingRead(buf, tail + 4, msgData, hdr[1]);
+			g_FlightRecorder->WriteMessage(hdr[0] & 0x7FFF, (hdr[0] & 0x8000) != 0, msgData, hdr[1]);
+			tail += 4 + hdr[1];
+		}
+		buf->tail.store(tail, std::memory_order_release);
+
+		if (state == FRTB_RETIRED) {
+			g_FRThreadBuffersUsed--;
+			buf->state.store(FRTB_FREE, std::memory_order_release);
+		}
+	}
+}
+
 void FR_Dump_f() {
 	const char* fname = "rehlds_flightrec.bin";
 	if (Cmd_Argc() == 1) {
@@ -55,7 +225,13 @@ void FR_Dump_f() {
 		Con_Printf("usage:  rehlds_flrec_dump < filename >\n");
 	}
 
+	FR_FlushThreadBuffers();
 	g_FlightRecorder->dump(fname);
+
+	uint32 dropped = g_FRThreadDropped;
+	if (dropped) {
+		Con_Printf("%u messages from worker threads were dropped (buffer full)\n", dropped);
+	}
 }
 
 void FR_Rehlds_Init() {
@@ -63,7 +239,7 @@ void FR_Rehlds_Init() {
 	Cvar_RegisterVariable(&rehlds_flrec_pvdata);
 	Cmd_AddCommand("rehlds_flrec_dump", &FR_Dump_f);
 
-	g_FRMsg_Frame = g_FlightRecorder->RegisterMessage("rehlds", "Frame", 2, true);
+	g_FRMsg_Frame = g_FlightRecorder->RegisterMessage("rehlds", "Frame", 3, true);
 	g_FRMsg_FreeEntPrivateData = g_FlightRecorder->RegisterMessage("rehlds", "FreeEntPrivateData", 1, false);
 	g_FRMsg_AllocEntPrivateData = g_FlightRecorder->RegisterMessage("rehlds", "AllocEntPrivateData", 2, false);
 	g_FRMsg_Log = g_FlightRecorder->RegisterMessage("rehlds", "Log", 1, false);
@@ -71,32 +247,37 @@ void FR_Rehlds_Init() {
 
 void FR_StartFrame(long frameCounter) {
 	FR_CheckInit();
-	g_FlightRecorder->StartMessage(g_FRMsg_Frame, true);
-	g_FlightRecorder->WriteInt64(frameCounter);
-	g_FlightRecorder->WriteDouble(realtime);
-	g_FlightRecorder->EndMessage(g_FRMsg_Frame, true);
+
+	fr_frame_start_t msg;
+	msg.frameCounter = frameCounter;
+	msg.realtime = realtime;
+	msg.wallTime = Sys_FloatTime();
+	g_FlightRecorder->WriteMessage(g_FRMsg_Frame, true, msg);
 }
 
 void FR_EndFrame(long frameCounter) {
 	FR_CheckInit();
-	g_FlightRecorder->StartMessage(g_FRMsg_Frame, false);
-	g_FlightRecorder->WriteInt64(frameCounter);
-	g_FlightRecorder->EndMessage(g_FRMsg_Frame, false);
+
+	fr_frame_end_t msg;
+	msg.frameCounter = frameCounter;
+	msg.wallTime = Sys_FloatTime();
+	g_FlightRecorder->WriteMessage(g_FRMsg_Frame, false, msg);
 }
 
 void FR_AllocEntPrivateData(void* res, int size) {
 	FR_CheckInit();
-	g_FlightRecorder->StartMessage(g_FRMsg_AllocEntPrivateData, true);
-	g_FlightRecorder->WriteUInt32((size_t)res);
-	g_FlightRecorder->WriteInt32(size);
-	g_FlightRecorder->EndMessage(g_FRMsg_AllocEntPrivateData, true);
+
+	fr_alloc_privdata_t msg;
+	msg.pPrivData = (uint32)(size_t)res;
+	msg.size = size;
+	FR_WriteMessage(g_FRMsg_AllocEntPrivateData, true, &msg, sizeof(msg));
 }
 
 void FR_FreeEntPrivateData(void* data) {
 	FR_CheckInit();
-	g_FlightRecorder->StartMessage(g_FRMsg_FreeEntPrivateData, true);
-	g_FlightRecorder->WriteUInt32((size_t)data);
-	g_FlightRecorder->EndMessage(g_FRMsg_FreeEntPrivateData, true);
+
+	uint32 pPrivData = (uint32)(size_t)data;
+	FR_WriteMessage(g_FRMsg_FreeEntPrivateData, true, &pPrivData, sizeof(pPrivData));
 }
 
 void FR_Log(const char* prefix, const char* msg) {
@@ -104,10 +285,8 @@ void FR_Log(const char* prefix, const char* msg) {
 	if (g_FlightRecorder == NULL) { 
 		return; //During server initialization some messages could be written in console/log before flightrecorder is initialized
 	}
-	g_FlightRecorder->StartMessage(g_FRMsg_Log, true);
-	g_FlightRecorder->WriteString(prefix);
-	g_FlightRecorder->WriteString(msg);
-	g_FlightRecorder->EndMessage(g_FRMsg_Log, true);
+
+	FR_WriteMessage(g_FRMsg_Log, true, prefix, Q_strlen(prefix) + 1, msg, Q_strlen(msg) + 1);
 }
 
 #endif //REHLDS_FLIGHT_REC
@@ -43,4 +43,10 @@ extern void FR_FreeEntPrivateData(void* data);
 extern void FR_AllocEntPrivateData(void* res, int size);
 extern void FR_Log(const char* prefix, const char* msg);
 
+// Copies messages recorded by other threads into the main region; called by the main thread once per frame
+extern void FR_FlushThreadBuffers();
+
+// Releases the calling thread's buffer, must be called by threads that exit while the server runs
+extern void FR_ThreadExit();
+
 #endif //REHLDS_FLIGHT_REC
@@ -0,0 +1,249 @@
+/*
+*
+*    This program is free software; you can redistribute it and/or modify it
+*    under the terms of the GNU General Public License as published by the
+*    Free Software Foundation; either version 2 of the License, or (at
+*    your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful, but
+*    WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+*    General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program; if not, write to the Free Software Foundation,
+*    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+#include "precompiled.h"
+
+cvar_t sys_profile = { "sys_profile", "0", 0, 0.0f, NULL };
+
+// Updated once per frame from sys_profile and the trace state, read by every scope
+bool g_FrameProfileActive;
+static bool g_FrameProfileForced;
+
+static const char *g_FrameProfileNames[FPROF_NUM_PHASES] = {
+	"SV_Frame",
+	"SV_ReadPackets",
+	"SV_Physics",
+	"StartFrame",
+	"PlayerPreThink",
+	"PlayerPostThink",
+	"SV_SendClientMessages",
+	"SV_WriteEntitiesToClient",
+	"DeltaEncode",
+	"Steam_RunFrame",
+};
+
+// Values below 16ns get a bucket each, above that 16 sub-buckets per power of two
+#define FPROF_SUB_BITS		4
+#define FPROF_SUB_BUCKETS	(1 << FPROF_SUB_BITS)
+#define FPROF_BUCKETS		(64 * FPROF_SUB_BUCKETS)
+
+struct FrameProfileHistogram {
+	int64 count;
+	int64 total;
+	int64 max;
+	int64 buckets[FPROF_BUCKETS];
+};
+
+struct FrameTraceEvent {
+	uint8 phase;
+	int64 start;
+	int64 end;
+};
+
+static FrameProfileHistogram g_FrameProfileHist[FPROF_NUM_PHASES];
+
+static FrameTraceEvent *g_FrameTraceEvents;
+static int g_FrameTraceCount;
+static int g_FrameTraceMax;
+static int g_FrameTraceFramesLeft;
+static int64 g_FrameTraceStart;
+static char g_FrameTraceFile[MAX_PATH];
+
+int64 FrameProfile_Now() {
+#ifdef _WIN32
+	static double ticksToNs;
+	LARGE_INTEGER counter;
+	if (!ticksToNs) {
+		LARGE_INTEGER freq;
+		QueryPerformanceFrequency(&freq);
+		ticksToNs = 1000000000.0 / freq.QuadPart;
+	}
+
+	QueryPerformanceCounter(&counter);
+	return (int64)(counter.QuadPart * ticksToNs);
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+	return (int64)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+static int FrameProfile_Bucket(int64 value) {
+	if (value < FPROF_SUB_BUCKETS)
+		return value < 0 ? 0 : (int)value;
+
+	int msb = 63;
+	while (!(value & (1LL << msb)))
+		msb--;
+
+	int sub = (int)(value >> (msb - FPROF_SUB_BITS)) & (FPROF_SUB_BUCKETS - 1);
+	return (msb - FPROF_SUB_BITS + 1) * FPROF_SUB_BUCKETS + sub;
+}
+
+// Lowest value that falls into the bucket
+static int64 FrameProfile_BucketValue(int bucket) {
+	if (bucket < FPROF_SUB_BUCKETS)
+		return bucket;
+
+	int msb = bucket / FPROF_SUB_BUCKETS + FPROF_SUB_BITS - 1;
+	int64 sub = bucket & (FPROF_SUB_BUCKETS - 1);
+	return (1LL << msb) | (sub << (msb - FPROF_SUB_BITS));
+}
+
+static int64 FrameProfile_Percentile(const FrameProfileHistogram *hist, double fraction) {
+	int64 rank = (int64)(hist->count * fraction);
+	int64 seen = 0;
+
+	for (int i = 0; i < FPROF_BUCKETS; i++) {
+		seen += hist->buckets[i];
+		if (seen > rank)
+			return FrameProfile_BucketValue(i);
+	}
+
+	return hist->max;
+}
+
+void FrameProfile_Record(FrameProfilePhase phase, int64 start, int64 end) {
+	int64 elapsed = end - start;
+	FrameProfileHistogram *hist = &g_FrameProfileHist[phase];
+
+	hist->count++;
+	hist->total += elapsed;
+	if (elapsed > hist->max)
+		hist->max = elapsed;
+
+	hist->buckets[FrameProfile_Bucket(elapsed)]++;
+
+	if (g_FrameTraceEvents && g_FrameTraceCount < g_FrameTraceMax) {
+		FrameTraceEvent *ev = &g_FrameTraceEvents[g_FrameTraceCount++];
+		ev->phase = phase;
+		ev->start = start;
+		ev->end = end;
+	}
+}
+
+static void FrameProfile_UpdateActive() {
+	g_FrameProfileActive = g_FrameProfileForced || sys_profile.value != 0.0f || g_FrameTraceEvents != NULL;
+}
+
+void FrameProfile_ForceEnable() {
+	g_FrameProfileForced = true;
+	g_FrameProfileActive = true;
+}
+
+const char *FrameProfile_PhaseName(FrameProfilePhase phase) {
+	return g_FrameProfileNames[phase];
+}
+
+bool FrameProfile_GetSummary(FrameProfilePhase phase, FrameProfileSummary *summary) {
+	const FrameProfileHistogram *hist = &g_FrameProfileHist[phase];
+	if (!hist->count)
+		return false;
+
+	summary->count = hist->count;
+	summary->meanUs = hist->total / (double)hist->count / 1000.0;
+	summary->p50Us = FrameProfile_Percentile(hist, 0.50) / 1000.0;
+	summary->p99Us = FrameProfile_Percentile(hist, 0.99) / 1000.0;
+	summary->maxUs = hist->max / 1000.0;
+	return true;
+}
+
+static void FrameProfile_WriteTrace() {
+	FileHandle_t f = FS_Open(g_FrameTraceFile, "wt");
+	if (!f) {
+		Con_Printf("Couldn't write frame trace to %s\n", g_FrameTraceFile);
+		return;
+	}
+
+	FS_FPrintf(f, "{\"traceEvents\":[\n");
+	for (int i = 0; i < g_FrameTraceCount; i++) {
+		FrameTraceEvent *ev = &g_FrameTraceEvents[i];
+		FS_FPrintf(f, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+			g_FrameProfileNames[ev->phase],
+			(ev->start - g_FrameTraceStart) / 1000.0,
+			(ev->end - ev->start) / 1000.0,
+			i + 1 < g_FrameTraceCount ? "," : "");
+	}
+
+	FS_FPrintf(f, "],\"displayTimeUnit\":\"ms\"}\n");
+	FS_Close(f);
+
+	Con_Printf("Wrote %d frame trace events to %s%s\n", g_FrameTraceCount, g_FrameTraceFile,
+		g_FrameTraceCount == g_FrameTraceMax ? " (event buffer was full)" : "");
+}
+
+void FrameProfile_EndFrame() {
+	if (g_FrameTraceEvents && --g_FrameTraceFramesLeft <= 0) {
+		FrameProfile_WriteTrace();
+		Mem_Free(g_FrameTraceEvents);
+		g_FrameTraceEvents = NULL;
+	}
+
+	FrameProfile_UpdateActive();
+}
+
+static void FrameProfile_Dump_f() {
+	Con_Printf("%-26s %10s %10s %10s %10s %10s\n", "phase", "count", "mean(us)", "p50(us)", "p99(us)", "max(us)");
+
+	for (int i = 0; i < FPROF_NUM_PHASES; i++) {
+		FrameProfileSummary summary;
+		if (!FrameProfile_GetSummary((FrameProfilePhase)i, &summary))
+			continue;
+
+		Con_Printf("%-26s %10lld %10.1f %10.1f %10.1f %10.1f\n",
+			g_FrameProfileNames[i], (long long)summary.count, summary.meanUs, summary.p50Us, summary.p99Us, summary.maxUs);
+	}
+}
+
+static void FrameProfile_Reset_f() {
+	Q_memset(g_FrameProfileHist, 0, sizeof(g_FrameProfileHist));
+}
+
+static void FrameProfile_Trace_f() {
+	if (Cmd_Argc() < 2) {
+		Con_Printf("usage: sys_profile_trace <frames> [filename]\n");
+		return;
+	}
+
+	if (g_FrameTraceEvents) {
+		Con_Printf("A frame trace is already being captured\n");
+		return;
+	}
+
+	int frames = Q_atoi(Cmd_Argv(1));
+	if (frames <= 0)
+		return;
+
+	// room for every phase of a full server plus per-player think calls
+	g_FrameTraceMax = frames * (FPROF_NUM_PHASES + 4 * MAX_CLIENTS);
+	g_FrameTraceEvents = (FrameTraceEvent *)Mem_Malloc(sizeof(FrameTraceEvent) * g_FrameTraceMax);
+	g_FrameTraceCount = 0;
+	g_FrameTraceFramesLeft = frames;
+	g_FrameTraceStart = FrameProfile_Now();
+
+	Q_strncpy(g_FrameTraceFile, Cmd_Argc() > 2 ? Cmd_Argv(2) : "frametrace.json", sizeof(g_FrameTraceFile) - 1);
+	g_FrameTraceFile[sizeof(g_FrameTraceFile) - 1] = 0;
+
+	FrameProfile_UpdateActive();
+}
+
+void FrameProfile_Init() {
+	Cvar_RegisterVariable(&sys_profile);
+	Cmd_AddCommand("sys_profile_dump", FrameProfile_Dump_f);
+	Cmd_AddCommand("sys_profile_reset", FrameProfile_Reset_f);
+	Cmd_AddCommand("sys_profile_trace", FrameProfile_Trace_f);
+}
@@ -0,0 +1,95 @@
+/*
+*
+*    This program is free software; you can redistribute it and/or modify it
+*    under the terms of the GNU General Public License as published by the
+*    Free Software Foundation; either version 2 of the License, or (at
+*    your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful, but
+*    WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+*    General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program; if not, write to the Free Software Foundation,
+*    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+#pragma once
+#include "osconfig.h"
+#include "archtypes.h"
+
+/*
+Per-phase server frame profiler. Scopes are timed with a raw monotonic clock into
+log-linear histograms (about 6% resolution) while sys_profile is set, or while a
+Chrome trace-event capture started by sys_profile_trace is running.
+*/
+
+enum FrameProfilePhase {
+	FPROF_FRAME,
+	FPROF_READPACKETS,
+	FPROF_PHYSICS,
+	FPROF_STARTFRAME,
+	FPROF_PRETHINK,
+	FPROF_POSTTHINK,
+	FPROF_SENDMESSAGES,
+	FPROF_WRITEENTITIES,
+	FPROF_DELTAENCODE,
+	FPROF_STEAM,
+
+	FPROF_NUM_PHASES
+};
+
+struct FrameProfileSummary {
+	int64 count;
+	double meanUs;
+	double p50Us;
+	double p99Us;
+	double maxUs;
+};
+
+extern cvar_t sys_profile;
+extern bool g_FrameProfileActive;
+
+extern void FrameProfile_Init();
+
+// Keeps the profiler on regardless of sys_profile, used by the testsuite benchmark
+extern void FrameProfile_ForceEnable();
+
+extern const char *FrameProfile_PhaseName(FrameProfilePhase phase);
+
+// Returns false if the phase has no samples yet
+extern bool FrameProfile_GetSummary(FrameProfilePhase phase, FrameProfileSummary *summary);
+
+extern int64 FrameProfile_Now();
+extern void FrameProfile_Record(FrameProfilePhase phase, int64 start, int64 end);
+
+// Closes the trace window once enough frames were captured, call once per host frame whether a server runs or not
+extern void FrameProfile_EndFrame();
+
+class CFrameProfileScope {
+public:
+	CFrameProfileScope(FrameProfilePhase phase) {
+		m_Phase = phase;
+		m_Start = g_FrameProfileActive ? FrameProfile_Now() : 0;
+	}
+
+	~CFrameProfileScope() {
+		if (m_Start)
+			FrameProfile_Record(m_Phase, m_Start, FrameProfile_Now());
+	}
+
+private:
+	FrameProfilePhase m_Phase;
+	int64 m_Start;
+};
+
+#define FRAME_PROFILE_CONCAT2(a, b) a##b
+#define FRAME_PROFILE_CONCAT(a, b) FRAME_PROFILE_CONCAT2(a, b)
+
+// Times the rest of the enclosing block
+#ifdef REHLDS_OPT_PEDANTIC
+#define FRAME_PROFILE_SCOPE(phase) CFrameProfileScope FRAME_PROFILE_CONCAT(frameProfileScope, __LINE__)(phase)
+#else // REHLDS_OPT_PEDANTIC
+#define FRAME_PROFILE_SCOPE(phase)
+#endif // REHLDS_OPT_PEDANTIC
@@ -0,0 +1,288 @@
+/*
+*
+*    This program is free software; you can redistribute it and/or modify it
+*    under the terms of the GNU General Public License as published by the
+*    Free Software Foundation; either version 2 of the License, or (at
+*    your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful, but
+*    WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+*    General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program; if not, write to the Free Software Foundation,
+*    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+#include "precompiled.h"
+
+#ifndef _WIN32
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#endif
+
+cvar_t sys_scheduler = { "sys_scheduler", "0", 0, 0.0f, NULL };
+
+#define SCHED_LATE_BUCKETS 7
+
+// Upper bounds of the wake-up lateness histogram, in microseconds
+static const int g_SchedLateBounds[SCHED_LATE_BUCKETS - 1] = { 50, 100, 250, 500, 1000, 2000 };
+
+struct SchedStats {
+	int64 ticks;
+	int64 inputWakes;
+	int64 skippedTicks;
+	double intervalSum;		// deviation of tick intervals from the nominal one, seconds
+	double intervalSumSq;
+	double intervalMin;
+	double intervalMax;
+	int64 late[SCHED_LATE_BUCKETS];
+};
+
+static SchedStats g_SchedStats;
+
+static void Sched_ResetStats() {
+	Q_memset(&g_SchedStats, 0, sizeof(g_SchedStats));
+	g_SchedStats.intervalMin = 1e9;
+	g_SchedStats.intervalMax = -1e9;
+}
+
+static void Sched_Stats_f() {
+	if (Cmd_Argc() > 1 && !Q_stricmp(Cmd_Argv(1), "reset")) {
+		Sched_ResetStats();
+		return;
+	}
+
+	SchedStats &st = g_SchedStats;
+	if (!st.ticks) {
+		Con_Printf("No scheduled ticks yet (sys_scheduler %s)\n", sys_scheduler.string);
+		return;
+	}
+
+	// first tick has no interval
+	int64 intervals = st.ticks - 1;
+	double mean = intervals ? st.intervalSum / intervals : 0.0;
+	double var = intervals ? st.intervalSumSq / intervals - mean * mean : 0.0;
+	double stddev = var > 0.0 ? sqrt(var) : 0.0;
+
+	Con_Printf("ticks: %lld, skipped: %lld, input wakes: %lld\n", st.ticks, st.skippedTicks, st.inputWakes);
+	if (intervals) {
+		Con_Printf("interval jitter (usec): mean %+.1f, stddev %.1f, min %+.1f, max %+.1f\n",
+			mean * 1000000.0, stddev * 1000000.0, st.intervalMin * 1000000.0, st.intervalMax * 1000000.0);
+	}
+
+	Con_Printf("wake-up lateness:\n");
+	for (int i = 0; i < SCHED_LATE_BUCKETS; i++) {
+		if (i < SCHED_LATE_BUCKETS - 1)
+			Con_Printf("  < %5d usec: %lld\n", g_SchedLateBounds[i], st.late[i]);
+		else
+			Con_Printf("  >= %4d usec: %lld\n", g_SchedLateBounds[i - 1], st.late[i]);
+	}
+}
+
+void Sched_Init() {
+	Sched_ResetStats();
+	Cvar_RegisterVariable(&sys_scheduler);
+	Cmd_AddCommand("sys_schedstats", Sched_Stats_f);
+}
+
+#ifndef _WIN32
+
+static int g_SchedEpoll = -1;
+static int g_SchedTimer = -1;
+static int g_SchedSocket;			// server socket registered in the epoll set, 0 if none
+static unsigned int g_SchedSocketGeneration;	// net_socket_generation when it was registered
+static int64 g_SchedDeadline;		// next tick, CLOCK_MONOTONIC nanoseconds
+static int64 g_SchedLastTick;
+
+static int64 Sched_Now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Same rate Host_FilterTime paces the dedicated server with
+static double Sched_TickRate() {
+	static int command_line_ticrate = -1;
+	if (command_line_ticrate == -1)
+		command_line_ticrate = COM_CheckParm("-sys_ticrate");
+
+	if (command_line_ticrate > 0)
+		return Q_atof(com_argv[command_line_ticrate + 1]);
+
+	return sys_ticrate.value;
+}
+
+static bool Sched_Open() {
+	if (g_SchedEpoll != -1)
+		return true;
+
+	g_SchedEpoll = epoll_create1(EPOLL_CLOEXEC);
+	g_SchedTimer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (g_SchedEpoll == -1 || g_SchedTimer == -1) {
+		Con_Printf("%s: epoll/timerfd unavailable (%s), sys_scheduler disabled\n", __FUNCTION__, strerror(errno));
+		Sched_Shutdown();
+		Cvar_DirectSet(&sys_scheduler, "0");
+		return false;
+	}
+
+	struct epoll_event ev;
+	ev.events = EPOLLIN;
+	ev.data.fd = g_SchedTimer;
+	epoll_ctl(g_SchedEpoll, EPOLL_CTL_ADD, g_SchedTimer, &ev);
+	g_SchedSocket = 0;
+	g_SchedDeadline = 0;
+	return true;
+}
+
+void Sched_Shutdown() {
+	if (g_SchedTimer != -1)
+		close(g_SchedTimer);
+
+	if (g_SchedEpoll != -1)
+		close(g_SchedEpoll);
+
+	g_SchedTimer = g_SchedEpoll = -1;
+	g_SchedSocket = 0;
+}
+
+// Keeps the server socket in the epoll set only while input wake-ups are wanted
+static void Sched_UpdateSocket(bool wantInput) {
+	// the network thread drains the socket itself, its readiness can't be waited on here
+	int sock = (wantInput && !use_thread) ? ip_sockets[NS_SERVER] : 0;
+
+	// a socket reopened by NET_Config can get the old number back, it still has to be added
+	if (sock == g_SchedSocket && (!sock || g_SchedSocketGeneration == net_socket_generation))
+		return;
+
+	// a socket closed by NET_Config has already left the set, the delete then fails harmlessly
+	if (g_SchedSocket)
+		epoll_ctl(g_SchedEpoll, EPOLL_CTL_DEL, g_SchedSocket, NULL);
+
+	g_SchedSocket = 0;
+	if (sock) {
+		struct epoll_event ev;
+		ev.events = EPOLLIN;
+		ev.data.fd = sock;
+		if (epoll_ctl(g_SchedEpoll, EPOLL_CTL_ADD, sock, &ev) == 0) {
+			g_SchedSocket = sock;
+			g_SchedSocketGeneration = net_socket_generation;
+		}
+	}
+}
+
+static void Sched_RecordTick(int64 now, int64 interval) {
+	SchedStats &st = g_SchedStats;
+
+	int64 late = (now - g_SchedDeadline) / 1000;
+	int bucket = 0;
+	while (bucket < SCHED_LATE_BUCKETS - 1 && late >= g_SchedLateBounds[bucket])
+		bucket++;
+
+	st.late[bucket]++;
+
+	if (st.ticks++) {
+		double deviation = (now - g_SchedLastTick - interval) / 1000000000.0;
+		st.intervalSum += deviation;
+		st.intervalSumSq += deviation * deviation;
+		if (deviation < st.intervalMin)
+			st.intervalMin = deviation;
+		if (deviation > st.intervalMax)
+			st.intervalMax = deviation;
+	}
+
+	g_SchedLastTick = now;
+}
+
+// Input between ticks, read with realtime at what Host_FilterTime would make of now.
+// realtime is put back after: the next frame adds the whole interval since the last one itself
+static void Sched_ReadPacketsBetweenTicks() {
+	double frameRealtime = realtime;
+	realtime += sys_timescale.value * (Sys_FloatTime() - eng->GetCurTime());
+
+	{
+		FRAME_PROFILE_SCOPE(FPROF_READPACKETS);
+		SV_ReadPackets();
+	}
+
+	realtime = frameRealtime;
+}
+
+void Sched_WaitForFrame() {
+	int mode = (int)sys_scheduler.value;
+	if (mode <= 0 || g_pcls.state != ca_dedicated || g_RehldsRuntimeConfig.testPlayerMode != TPM_DISABLE) {
+		g_SchedDeadline = 0;
+		return;
+	}
+
+	double rate = Sched_TickRate();
+	if (rate <= 0.0 || !Sched_Open())
+		return;
+
+	int64 interval = (int64)(1000000000.0 / rate);
+	int64 now = Sched_Now();
+
+	if (!g_SchedDeadline) {
+		g_SchedDeadline = now + interval;
+		g_SchedLastTick = 0;
+	}
+
+	Sched_UpdateSocket(mode >= 2 && g_psv.active);
+
+	if (now < g_SchedDeadline) {
+		struct itimerspec its;
+		Q_memset(&its, 0, sizeof(its));
+		its.it_value.tv_sec = g_SchedDeadline / 1000000000LL;
+		its.it_value.tv_nsec = g_SchedDeadline % 1000000000LL;
+		timerfd_settime(g_SchedTimer, TFD_TIMER_ABSTIME, &its, NULL);
+
+		bool due = false;
+		while (!due) {
+			struct epoll_event events[2];
+			int n = epoll_wait(g_SchedEpoll, events, ARRAYSIZE(events), -1);
+			if (n < 0) {
+				if (errno == EINTR)
+					continue;
+
+				break;
+			}
+
+			for (int i = 0; i < n; i++) {
+				if (events[i].data.fd == g_SchedTimer) {
+					uint64 expirations;
+					read(g_SchedTimer, &expirations, sizeof(expirations));
+					due = true;
+				} else if (g_psv.active) {
+					// input between ticks: run usercmds now, simulation waits for the tick
+					g_SchedStats.inputWakes++;
+					Sched_ReadPacketsBetweenTicks();
+				}
+			}
+
+			if (!due && Sched_Now() >= g_SchedDeadline)
+				due = true;
+		}
+
+		now = Sched_Now();
+	}
+
+	Sched_RecordTick(now, interval);
+
+	// absolute deadlines don't drift; if we fell more than a tick behind, restart from now
+	g_SchedDeadline += interval;
+	if (g_SchedDeadline <= now) {
+		g_SchedStats.skippedTicks += (now - g_SchedDeadline) / interval + 1;
+		g_SchedDeadline = now + interval;
+	}
+}
+
+#else // _WIN32
+
+void Sched_Shutdown() {
+}
+
+void Sched_WaitForFrame() {
+}
+
+#endif // _WIN32
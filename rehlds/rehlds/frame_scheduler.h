@@ -0,0 +1,34 @@
+/*
+*
+*    This program is free software; you can redistribute it and/or modify it
+*    under the terms of the GNU General Public License as published by the
+*    Free Software Foundation; either version 2 of the License, or (at
+*    your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful, but
+*    WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+*    General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program; if not, write to the Free Software Foundation,
+*    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+#pragma once
+#include "osconfig.h"
+
+/*
+Frame scheduler for the dedicated server (Linux only).
+sys_scheduler 1: sleep on a CLOCK_MONOTONIC timerfd armed with absolute tick deadlines.
+sys_scheduler 2: same, but also wake on server socket input and read packets right away,
+                 simulation still runs on the tick.
+*/
+
+extern cvar_t sys_scheduler;
+
+extern void Sched_Init();
+extern void Sched_Shutdown();
+
+// Called before each engine frame, returns when the next tick is due
+extern void Sched_WaitForFrame();
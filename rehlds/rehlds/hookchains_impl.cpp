@@ -19,10 +19,58 @@
 #include "precompiled.h"
 #include "hookchains_impl.h"
 
+cvar_t rehlds_hookchain_timing = { "rehlds_hookchain_timing", "0", 0, 0.0f, NULL };
+
+static AbstractHookChainRegistry* g_FirstHookChainRegistry;
+static void* g_NoHooks[1] = { NULL };
+
 AbstractHookChainRegistry::AbstractHookChainRegistry()
 {
-	memset(m_Hooks, 0, sizeof(m_Hooks));
+	memset(m_Stats, 0, sizeof(m_Stats));
+	m_Hooks = g_NoHooks;
 	m_NumHooks = 0;
+	m_RetiredHooks = NULL;
+	m_Name = "unnamed";
+
+	m_Next = g_FirstHookChainRegistry;
+	g_FirstHookChainRegistry = this;
+}
+
+AbstractHookChainRegistry::~AbstractHookChainRegistry()
+{
+	while (m_RetiredHooks) {
+		void** next = (void**)m_RetiredHooks[MAX_HOOKS_IN_CHAIN + 1];
+		delete[] m_RetiredHooks;
+		m_RetiredHooks = next;
+	}
+
+	if (m_Hooks != g_NoHooks)
+		delete[] m_Hooks;
+
+	// Stats walkers must not see registries that went out of scope, e.g. the ones unit tests create
+	for (AbstractHookChainRegistry** link = &g_FirstHookChainRegistry; *link; link = &(*link)->m_Next) {
+		if (*link == this) {
+			*link = m_Next;
+			break;
+		}
+	}
+}
+
+void AbstractHookChainRegistry::publishHooks(void** hooks, int numHooks) {
+	// Copies are sized for the maximum chain plus the terminator and the retired list link
+	void** copy = new void*[MAX_HOOKS_IN_CHAIN + 2];
+	memcpy(copy, hooks, numHooks * sizeof(copy[0]));
+	copy[numHooks] = NULL;
+
+	void** prev = m_Hooks;
+	m_Hooks = copy;
+	m_NumHooks = numHooks;
+
+	// A chain that is being dispatched may still point into the previous copy
+	if (prev != g_NoHooks) {
+		prev[MAX_HOOKS_IN_CHAIN + 1] = m_RetiredHooks;
+		m_RetiredHooks = prev;
+	}
 }
 
 void AbstractHookChainRegistry::addHook(void* hookFunc) {
@@ -30,7 +78,15 @@ void AbstractHookChainRegistry::addHook(void* hookFunc) {
 		rehlds_syserror("MAX_HOOKS_IN_CHAIN limit hit");
 	}
 
-	m_Hooks[m_NumHooks++] = hookFunc;
+	void* hooks[MAX_HOOKS_IN_CHAIN + 1];
+	memcpy(hooks, m_Hooks, m_NumHooks * sizeof(hooks[0]));
+	hooks[m_NumHooks] = hookFunc;
+
+	// The slot after the last hook holds the original function's stats
+	m_Stats[m_NumHooks + 1] = m_Stats[m_NumHooks];
+	memset(&m_Stats[m_NumHooks], 0, sizeof(m_Stats[0]));
+
+	publishHooks(hooks, m_NumHooks + 1);
 }
 
 void AbstractHookChainRegistry::removeHook(void* hookFunc) {
@@ -38,10 +94,80 @@ void AbstractHookChainRegistry::removeHook(void* hookFunc) {
 	// erase hook
 	for (int i = 0; i < m_NumHooks; i++) {
 		if (hookFunc == m_Hooks[i]) {
-			if(--m_NumHooks != i)
-				memmove(&m_Hooks[i], &m_Hooks[i + 1], (m_NumHooks - i) * sizeof(m_Hooks[0]));
+			void* hooks[MAX_HOOKS_IN_CHAIN + 1];
+			memcpy(hooks, m_Hooks, i * sizeof(hooks[0]));
+			memcpy(&hooks[i], &m_Hooks[i + 1], (m_NumHooks - i - 1) * sizeof(hooks[0]));
+
+			memmove(&m_Stats[i], &m_Stats[i + 1], (m_NumHooks - i) * sizeof(m_Stats[0]));
+			memset(&m_Stats[m_NumHooks], 0, sizeof(m_Stats[0]));
 
+			publishHooks(hooks, m_NumHooks - 1);
 			return;
 		}
 	}
 }
+
+void AbstractHookChainRegistry::setName(const char* name) {
+	m_Name = name;
+}
+
+void AbstractHookChainRegistry::printStats() const {
+	if (!m_NumHooks)
+		return;
+
+	Con_Printf("%s:\n", m_Name);
+	for (int i = 0; i <= m_NumHooks; i++) {
+		const hookchain_stats_t* stats = &m_Stats[i];
+		char name[64];
+		if (i < m_NumHooks) {
+			char module[MAX_PATH];
+			Sys_ModuleNameForAddress(m_Hooks[i], module, sizeof(module));
+			Q_snprintf(name, sizeof(name), "  #%d %s", i, module);
+		}
+		else
+			Q_snprintf(name, sizeof(name), "  original");
+
+		Con_Printf("%-24s %10lld %12.3f %10.2f\n", name, (long long)stats->calls, stats->time / 1000000.0,
+			stats->calls ? stats->time / 1000.0 / stats->calls : 0.0);
+	}
+}
+
+void AbstractHookChainRegistry::resetStats() {
+	memset(m_Stats, 0, sizeof(m_Stats));
+}
+
+void AbstractHookChainRegistry::rollStats() {
+	for (int i = 0; i <= m_NumHooks; i++) {
+		hookchain_stats_t* stats = &m_Stats[i];
+		stats->lastCalls = stats->calls - stats->markCalls;
+		stats->lastTime = stats->time - stats->markTime;
+		stats->markCalls = stats->calls;
+		stats->markTime = stats->time;
+	}
+}
+
+AbstractHookChainRegistry* AbstractHookChainRegistry::getFirst() {
+	return g_FirstHookChainRegistry;
+}
+
+void HookChains_Stats_f() {
+	if (Cmd_Argc() == 2 && !Q_stricmp(Cmd_Argv(1), "reset")) {
+		for (AbstractHookChainRegistry* reg = AbstractHookChainRegistry::getFirst(); reg; reg = reg->getNext())
+			reg->resetStats();
+
+		return;
+	}
+
+	if (rehlds_hookchain_timing.value == 0.0f) {
+		Con_Printf("rehlds_hookchain_timing is 0, hook times are not being collected\n");
+	}
+
+	Con_Printf("%-24s %10s %12s %10s\n", "hook", "calls", "self ms", "us/call");
+	for (AbstractHookChainRegistry* reg = AbstractHookChainRegistry::getFirst(); reg; reg = reg->getNext())
+		reg->printStats();
+}
+
+void HookChains_Init() {
+	Cvar_RegisterVariable(&rehlds_hookchain_timing);
+	Cmd_AddCommand("rehlds_hookchain_stats", HookChains_Stats_f);
+}
@@ -30,14 +30,65 @@
 
 #define MAX_HOOKS_IN_CHAIN 63
 
+struct hookchain_stats_t {
+	int64 calls;
+	int64 time;	// ns spent in the hook itself, without the rest of the chain
+
+	// Window closed by the last rollStats() and the totals it started from
+	int64 lastCalls;
+	int64 lastTime;
+	int64 markCalls;
+	int64 markTime;
+};
+
+extern cvar_t rehlds_hookchain_timing;
+
+// State shared by all levels of one dispatch: a single chain object walks the flat hook array.
+// callNext() advances the cursor for the duration of the nested call and restores it afterwards,
+// so a hook may call callNext() more than once
+class AbstractHookChain {
+protected:
+	AbstractHookChain(void** hooks, hookchain_stats_t* stats) : m_Hooks(hooks), m_FirstHook(hooks), m_Stats(stats), m_NestedTime(0) {}
+
+	class CLevelScope {
+	public:
+		CLevelScope(AbstractHookChain* chain) : m_Chain(chain) {
+			m_Chain->m_Hooks++;
+			m_Start = (rehlds_hookchain_timing.value != 0.0f) ? FrameProfile_Now() : 0;
+			m_SavedNestedTime = m_Chain->m_NestedTime;
+		}
+
+		~CLevelScope() {
+			int level = (--m_Chain->m_Hooks) - m_Chain->m_FirstHook;
+			if (m_Start) {
+				int64 elapsed = FrameProfile_Now() - m_Start;
+				hookchain_stats_t* stats = &m_Chain->m_Stats[level];
+				stats->calls++;
+				stats->time += elapsed - (m_Chain->m_NestedTime - m_SavedNestedTime);
+				m_Chain->m_NestedTime = m_SavedNestedTime + elapsed;
+			}
+		}
+
+	private:
+		AbstractHookChain* m_Chain;
+		int64 m_Start;
+		int64 m_SavedNestedTime;
+	};
+
+	void** m_Hooks;
+	void** m_FirstHook;
+	hookchain_stats_t* m_Stats;	// one per hook, the slot after the last hook is for the original function
+	int64 m_NestedTime;
+};
+
 // Implementation for chains in modules
 template<typename t_ret, typename ...t_args>
-class IHookChainImpl : public IHookChain<t_ret, t_args...> {
+class IHookChainImpl : public IHookChain<t_ret, t_args...>, public AbstractHookChain {
 public:
 	typedef t_ret(*hookfunc_t)(IHookChain<t_ret, t_args...>*, t_args...);
 	typedef t_ret(*origfunc_t)(t_args...);
 
-	IHookChainImpl(void** hooks, origfunc_t orig) : m_Hooks(hooks), m_OriginalFunc(orig)
+	IHookChainImpl(void** hooks, hookchain_stats_t* stats, origfunc_t orig) : AbstractHookChain(hooks, stats), m_OriginalFunc(orig)
 	{
 		if (orig == NULL)
 			rehlds_syserror("Non-void HookChain without original function.");
@@ -46,13 +97,11 @@ public:
 	virtual ~IHookChainImpl() {}
 
 	virtual t_ret callNext(t_args... args) {
-		hookfunc_t nexthook = (hookfunc_t)m_Hooks[0];
+		hookfunc_t nexthook = (hookfunc_t)*m_Hooks;
+		CLevelScope scope(this);
 
 		if (nexthook)
-		{
-			IHookChainImpl nextChain(m_Hooks + 1, m_OriginalFunc);
-			return nexthook(&nextChain, args...);
-		}
+			return nexthook(this, args...);
 
 		return m_OriginalFunc(args...);
 	}
@@ -62,27 +111,26 @@ public:
 	}
 
 private:
-	void** m_Hooks;
 	origfunc_t m_OriginalFunc;
 };
 
 // Implementation for void chains in modules
 template<typename ...t_args>
-class IVoidHookChainImpl : public IVoidHookChain<t_args...> {
+class IVoidHookChainImpl : public IVoidHookChain<t_args...>, public AbstractHookChain {
 public:
 	typedef void(*hookfunc_t)(IVoidHookChain<t_args...>*, t_args...);
 	typedef void(*origfunc_t)(t_args...);
 
-	IVoidHookChainImpl(void** hooks, origfunc_t orig) : m_Hooks(hooks), m_OriginalFunc(orig) {}
+	IVoidHookChainImpl(void** hooks, hookchain_stats_t* stats, origfunc_t orig) : AbstractHookChain(hooks, stats), m_OriginalFunc(orig) {}
 	virtual ~IVoidHookChainImpl() {}
 
 	virtual void callNext(t_args... args) {
-		hookfunc_t nexthook = (hookfunc_t)m_Hooks[0];
+		hookfunc_t nexthook = (hookfunc_t)*m_Hooks;
+		CLevelScope scope(this);
 
 		if (nexthook)
 		{
-			IVoidHookChainImpl nextChain(m_Hooks + 1, m_OriginalFunc);
-			nexthook(&nextChain, args...);
+			nexthook(this, args...);
 		}
 		else
 		{
@@ -97,14 +145,20 @@ public:
 	}
 
 private:
-	void** m_Hooks;
 	origfunc_t m_OriginalFunc;
 };
 
 class AbstractHookChainRegistry {
 protected:
-	void* m_Hooks[MAX_HOOKS_IN_CHAIN + 1]; // +1 for null
+	// Null-terminated and never modified in place: [un]registration publishes a new copy, so a hook
+	// that unregisters itself doesn't disturb chains that are being dispatched
+	void** m_Hooks;
 	int m_NumHooks;
+	hookchain_stats_t m_Stats[MAX_HOOKS_IN_CHAIN + 1];
+
+	const char* m_Name;
+	AbstractHookChainRegistry* m_Next;
+	void** m_RetiredHooks;	// previous copies, linked through their last slot
 
 protected:
 	void addHook(void* hookFunc);
@@ -112,6 +166,43 @@ protected:
 
 public:
 	AbstractHookChainRegistry();
+	~AbstractHookChainRegistry();
+
+	bool isEmpty() const {
+		return m_NumHooks == 0;
+	}
+
+	void setName(const char* name);
+	void printStats() const;
+	void resetStats();
+
+	// Closes the current measurement window for every hook
+	void rollStats();
+
+	const char* getName() const {
+		return m_Name;
+	}
+
+	int getNumHooks() const {
+		return m_NumHooks;
+	}
+
+	void* getHook(int i) const {
+		return m_Hooks[i];
+	}
+
+	// i == getNumHooks() is the original function
+	const hookchain_stats_t* getStats(int i) const {
+		return &m_Stats[i];
+	}
+
+	static AbstractHookChainRegistry* getFirst();
+	AbstractHookChainRegistry* getNext() const {
+		return m_Next;
+	}
+
+private:
+	void publishHooks(void** hooks, int numHooks);
 };
 
 template<typename t_ret, typename ...t_args>
@@ -123,7 +214,10 @@ public:
 	virtual ~IHookChainRegistryImpl() { }
 
 	t_ret callChain(origfunc_t origFunc, t_args... args) {
-		IHookChainImpl<t_ret, t_args...> chain(m_Hooks, origFunc);
+		if (isEmpty())
+			return origFunc(args...);
+
+		IHookChainImpl<t_ret, t_args...> chain(m_Hooks, m_Stats, origFunc);
 		return chain.callNext(args...);
 	}
 
@@ -144,7 +238,14 @@ public:
 	virtual ~IVoidHookChainRegistryImpl() { }
 
 	void callChain(origfunc_t origFunc, t_args... args) {
-		IVoidHookChainImpl<t_args...> chain(m_Hooks, origFunc);
+		if (isEmpty()) {
+			if (origFunc)
+				origFunc(args...);
+
+			return;
+		}
+
+		IVoidHookChainImpl<t_args...> chain(m_Hooks, m_Stats, origFunc);
 		chain.callNext(args...);
 	}
 
@@ -156,3 +257,5 @@ public:
 		removeHook((void*)hook);
 	}
 };
+
+extern void HookChains_Init();
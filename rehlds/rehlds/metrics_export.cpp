@@ -0,0 +1,228 @@
+/*
+*
+*    This program is free software; you can redistribute it and/or modify it
+*    under the terms of the GNU General Public License as published by the
+*    Free Software Foundation; either version 2 of the License, or (at
+*    your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful, but
+*    WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+*    General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program; if not, write to the Free Software Foundation,
+*    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+#include "precompiled.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#endif // _WIN32
+
+cvar_t sys_metrics = { "sys_metrics", "0", 0, 0.0f, NULL };
+
+bool g_MetricsActive;
+MetricsNetCounters g_MetricsNet;
+uint32 g_MetricsChoked[REHLDS_METRICS_MAX_CLIENTS];
+
+static_assert(sizeof(rehlds_metrics_client_t) == 80, "rehlds_metrics_client_t layout changed");
+static_assert(sizeof(rehlds_metrics_t) == 2728, "rehlds_metrics_t layout changed");
+static_assert(sizeof(std::atomic<uint32>) == sizeof(uint32) && ATOMIC_INT_LOCK_FREE == 2, "readers in other processes see sequence as a plain uint32");
+
+static rehlds_metrics_t *g_Metrics;
+static char g_MetricsName[64];
+static float g_MetricsConnectTime[REHLDS_METRICS_MAX_CLIENTS];
+
+#ifdef _WIN32
+static HANDLE g_MetricsMapping;
+#endif // _WIN32
+
+static bool Metrics_Open() {
+	int port = (int)iphostport.value;
+	if (!port)
+		port = (int)hostport.value;
+
+#ifdef _WIN32
+	Q_snprintf(g_MetricsName, sizeof(g_MetricsName), "Local\\rehlds_metrics_%d", port);
+
+	g_MetricsMapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(rehlds_metrics_t), g_MetricsName);
+	if (!g_MetricsMapping) {
+		Con_Printf("%s: CreateFileMapping(%s) failed, error %u\n", __FUNCTION__, g_MetricsName, (unsigned)GetLastError());
+		return false;
+	}
+
+	g_Metrics = (rehlds_metrics_t *)MapViewOfFile(g_MetricsMapping, FILE_MAP_WRITE, 0, 0, sizeof(rehlds_metrics_t));
+	if (!g_Metrics) {
+		Con_Printf("%s: MapViewOfFile(%s) failed, error %u\n", __FUNCTION__, g_MetricsName, (unsigned)GetLastError());
+		CloseHandle(g_MetricsMapping);
+		g_MetricsMapping = NULL;
+		return false;
+	}
+#else // _WIN32
+	Q_snprintf(g_MetricsName, sizeof(g_MetricsName), "/rehlds_metrics_%d", port);
+
+	int fd = shm_open(g_MetricsName, O_RDWR | O_CREAT, 0644);
+	if (fd == -1) {
+		Con_Printf("%s: shm_open(%s) failed: %s\n", __FUNCTION__, g_MetricsName, strerror(errno));
+		return false;
+	}
+
+	// A segment left behind by a crashed server is reused, the header is rewritten below
+	if (ftruncate(fd, sizeof(rehlds_metrics_t)) == -1) {
+		Con_Printf("%s: ftruncate(%s) failed: %s\n", __FUNCTION__, g_MetricsName, strerror(errno));
+		close(fd);
+		shm_unlink(g_MetricsName);
+		return false;
+	}
+
+	void *mem = mmap(NULL, sizeof(rehlds_metrics_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (mem == MAP_FAILED) {
+		Con_Printf("%s: mmap(%s) failed: %s\n", __FUNCTION__, g_MetricsName, strerror(errno));
+		shm_unlink(g_MetricsName);
+		return false;
+	}
+
+	g_Metrics = (rehlds_metrics_t *)mem;
+#endif // _WIN32
+
+	// Leave the sequence odd until the first update so readers skip the zeroed block
+	g_Metrics->sequence.store(1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	Q_memset(&g_Metrics->frameCount, 0, sizeof(rehlds_metrics_t) - offsetof(rehlds_metrics_t, frameCount));
+	g_Metrics->magic = REHLDS_METRICS_MAGIC;
+	g_Metrics->version = REHLDS_METRICS_VERSION;
+	g_Metrics->size = sizeof(rehlds_metrics_t);
+
+	Con_DPrintf("Publishing server metrics in %s\n", g_MetricsName);
+	return true;
+}
+
+static void Metrics_Close() {
+	if (!g_Metrics)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(g_Metrics);
+	CloseHandle(g_MetricsMapping);
+	g_MetricsMapping = NULL;
+#else // _WIN32
+	munmap(g_Metrics, sizeof(rehlds_metrics_t));
+	shm_unlink(g_MetricsName);
+#endif // _WIN32
+
+	g_Metrics = NULL;
+	g_MetricsActive = false;
+}
+
+static void Metrics_WriteClients(rehlds_metrics_t *m) {
+	int numClients = 0;
+	int count = min(g_psvs.maxclients, REHLDS_METRICS_MAX_CLIENTS);
+
+	for (int i = 0; i < count; i++) {
+		client_t *cl = &g_psvs.clients[i];
+		rehlds_metrics_client_t *out = &m->clients[i];
+
+		// A new connection in the slot starts its choke count over
+		if (cl->netchan.connect_time != g_MetricsConnectTime[i]) {
+			g_MetricsConnectTime[i] = cl->netchan.connect_time;
+			g_MetricsChoked[i] = 0;
+		}
+
+		if ((!cl->active && !cl->connected && !cl->spawned) || cl->fakeclient) {
+			if (out->active)
+				Q_memset(out, 0, sizeof(*out));
+
+			continue;
+		}
+
+		int ping, loss;
+		SV_GetNetInfo(cl, &ping, &loss);
+
+		out->active = 1;
+		out->userid = cl->userid;
+		Q_strncpy(out->name, cl->name, sizeof(out->name) - 1);
+		out->name[sizeof(out->name) - 1] = '\0';
+		out->ping = ping;
+		out->loss = loss;
+		out->rate = (int32)cl->netchan.rate;
+		out->updaterate = cl->next_messageinterval > 0.0 ? (int32)(1.0 / cl->next_messageinterval + 0.5) : 0;
+		out->sentPackets = cl->netchan.outgoing_sequence;
+		out->chokedPackets = g_MetricsChoked[i];
+		out->inKBytesPerSec = cl->netchan.flow[FLOW_INCOMING].avgkbytespersec;
+		out->outKBytesPerSec = cl->netchan.flow[FLOW_OUTGOING].avgkbytespersec;
+		out->connectedTime = (float)(realtime - cl->netchan.connect_time);
+
+		numClients++;
+	}
+
+	for (int i = count; i < REHLDS_METRICS_MAX_CLIENTS; i++) {
+		if (m->clients[i].active)
+			Q_memset(&m->clients[i], 0, sizeof(m->clients[i]));
+	}
+
+	m->numClients = numClients;
+	m->maxClients = g_psvs.maxclients;
+}
+
+void Metrics_Frame(int64 frameTimeNs) {
+	if (sys_metrics.value == 0.0f) {
+		if (g_Metrics)
+			Metrics_Close();
+
+		return;
+	}
+
+	if (!g_Metrics) {
+		if (!Metrics_Open()) {
+			Cvar_DirectSet(&sys_metrics, "0");
+			return;
+		}
+
+		g_MetricsActive = true;
+	}
+
+	rehlds_metrics_t *m = g_Metrics;
+	uint32 seq = m->sequence.load(std::memory_order_relaxed) | 1;
+
+	// Odd sequence, then the data, then the next even sequence; readers retry on a mismatch.
+	// The fence keeps the data stores after the odd one, the release store keeps them before the even one
+	m->sequence.store(seq, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	m->frameCount++;
+	m->realtime = realtime;
+	m->frameTimeMs = (float)(frameTimeNs / 1000000.0);
+	m->frameIntervalMs = (float)(host_frametime * 1000.0);
+	m->cpuPercent = (float)g_HostCpuStats.cpuPercent;
+	m->mainThreadPercent = (float)g_HostCpuStats.mainThreadPercent;
+
+	m->numEdicts = g_psv.num_edicts;
+	m->maxEdicts = g_psv.max_edicts;
+
+	m->packetsIn = g_MetricsNet.packetsIn;
+	m->packetsOut = g_MetricsNet.packetsOut;
+	m->bytesIn = g_MetricsNet.bytesIn;
+	m->bytesOut = g_MetricsNet.bytesOut;
+	m->entityBytes = g_MetricsNet.entityBytes;
+
+	Q_strncpy(m->map, g_psv.name, sizeof(m->map) - 1);
+	m->map[sizeof(m->map) - 1] = '\0';
+
+	Metrics_WriteClients(m);
+
+	m->sequence.store(seq + 1, std::memory_order_release);
+}
+
+void Metrics_Init() {
+	Cvar_RegisterVariable(&sys_metrics);
+}
+
+void Metrics_Shutdown() {
+	Metrics_Close();
+}
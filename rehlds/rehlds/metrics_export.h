@@ -0,0 +1,48 @@
+/*
+*
+*    This program is free software; you can redistribute it and/or modify it
+*    under the terms of the GNU General Public License as published by the
+*    Free Software Foundation; either version 2 of the License, or (at
+*    your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful, but
+*    WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+*    General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program; if not, write to the Free Software Foundation,
+*    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+#pragma once
+#include "osconfig.h"
+#include "archtypes.h"
+#include "rehlds_metrics.h"
+
+/*
+Publishes rehlds_metrics_t (public/rehlds/rehlds_metrics.h) in a shared memory segment
+while sys_metrics is set. The segment is created on the first frame after the cvar is
+turned on and removed when it is turned off again or the server shuts down.
+*/
+
+struct MetricsNetCounters {
+	int64 packetsIn;
+	int64 packetsOut;
+	int64 bytesIn;
+	int64 bytesOut;
+	int64 entityBytes;
+};
+
+extern cvar_t sys_metrics;
+extern bool g_MetricsActive;
+extern MetricsNetCounters g_MetricsNet;
+
+// Packets each client lost to the rate limit, kept past the svc_choke reset of chokecount
+extern uint32 g_MetricsChoked[REHLDS_METRICS_MAX_CLIENTS];
+
+extern void Metrics_Init();
+extern void Metrics_Shutdown();
+
+// Rewrites the shared block, call at the end of each server frame with its duration
+extern void Metrics_Frame(int64 frameTimeNs);
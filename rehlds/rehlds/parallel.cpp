@@ -0,0 +1,239 @@
+/*
+*
+*    This program is free software; you can redistribute it and/or modify it
+*    under the terms of the GNU General Public License as published by the
+*    Free Software Foundation; either version 2 of the License, or (at
+*    your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful, but
+*    WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+*    General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program; if not, write to the Free Software Foundation,
+*    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+#include "precompiled.h"
+
+#include "stdsani_in.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "stdsani_out.h"
+
+struct ParallelJob {
+	parallelfunc_t func;
+	void* arg;
+	int count;
+	int chunkSize;
+	std::atomic<int> next;
+};
+
+static std::atomic<int64> g_WorkerCpuTime;
+
+static int64 Sys_ThreadCpuTime() {
+#ifdef _WIN32
+	return 0;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (int64)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+int64 Sys_WorkerCpuTime() {
+	return g_WorkerCpuTime;
+}
+
+static void Sys_ParallelWorker(ParallelJob* job, int thread) {
+	while (true) {
+		int first = job->next.fetch_add(job->chunkSize);
+		if (first >= job->count)
+			break;
+
+		int last = first + job->chunkSize;
+		if (last > job->count)
+			last = job->count;
+
+		job->func(job->arg, first, last, thread);
+	}
+}
+
+// Heap allocated and never freed: the workers outlive static destructors at exit
+struct ParallelPool {
+	std::mutex lock;
+	std::condition_variable wake;
+	std::condition_variable idle;
+	ParallelJob* job;
+	unsigned int generation;	// bumped for every job
+	int numWorkers;				// threads [1, numWorkers] take part in the current job
+	int running;				// of those, the ones not done yet
+	std::atomic<bool> busy;
+};
+
+static ParallelPool* g_ParallelPool;
+
+static void Sys_ParallelThread(ParallelPool* pool, int thread) {
+	unsigned int seen = 0;
+
+	while (true) {
+		ParallelJob* job;
+		{
+			std::unique_lock<std::mutex> guard(pool->lock);
+			while (pool->generation == seen)
+				pool->wake.wait(guard);
+
+			// a job is only posted once every worker of the previous one is done,
+			// so a worker that slept through some generations can't owe them anything
+			seen = pool->generation;
+			job = (thread <= pool->numWorkers) ? pool->job : NULL;
+		}
+
+		if (!job)
+			continue;
+
+		int64 start = Sys_ThreadCpuTime();
+		Sys_ParallelWorker(job, thread);
+		g_WorkerCpuTime += Sys_ThreadCpuTime() - start;
+
+		std::lock_guard<std::mutex> guard(pool->lock);
+		if (--pool->running == 0)
+			pool->idle.notify_one();
+	}
+}
+
+int Sys_ParallelThreads() {
+	static int numThreads = 0;
+
+	if (!numThreads) {
+		numThreads = std::thread::hardware_concurrency();
+		if (numThreads < 1)
+			numThreads = 1;
+		if (numThreads > MAX_PARALLEL_THREADS)
+			numThreads = MAX_PARALLEL_THREADS;
+	}
+
+	return numThreads;
+}
+
+void Sys_ParallelFor(int count, int chunkSize, parallelfunc_t func, void* arg) {
+	if (count <= 0)
+		return;
+
+	if (chunkSize < 1)
+		chunkSize = 1;
+
+	ParallelJob job;
+	job.func = func;
+	job.arg = arg;
+	job.count = count;
+	job.chunkSize = chunkSize;
+	job.next = 0;
+
+	int numThreads = Sys_ParallelThreads();
+	int numChunks = (count + chunkSize - 1) / chunkSize;
+	if (numThreads > numChunks)
+		numThreads = numChunks;
+
+	if (!g_ParallelPool && numThreads > 1) {
+		g_ParallelPool = new ParallelPool();
+		g_ParallelPool->job = NULL;
+		g_ParallelPool->generation = 0;
+		g_ParallelPool->numWorkers = 0;
+		g_ParallelPool->running = 0;
+		g_ParallelPool->busy = false;
+
+		for (int i = 1; i < Sys_ParallelThreads(); i++)
+			std::thread(Sys_ParallelThread, g_ParallelPool, i).detach();
+	}
+
+	bool expected = false;
+	if (numThreads <= 1 || !g_ParallelPool->busy.compare_exchange_strong(expected, true)) {
+		Sys_ParallelWorker(&job, 0);
+		return;
+	}
+
+	ParallelPool* pool = g_ParallelPool;
+	{
+		std::lock_guard<std::mutex> guard(pool->lock);
+		pool->job = &job;
+		pool->numWorkers = numThreads - 1;
+		pool->running = numThreads - 1;
+		pool->generation++;
+	}
+	pool->wake.notify_all();
+
+	Sys_ParallelWorker(&job, 0);
+
+	{
+		std::unique_lock<std::mutex> guard(pool->lock);
+		while (pool->running)
+			pool->idle.wait(guard);
+
+		pool->job = NULL;
+	}
+
+	pool->busy = false;
+}
+
+struct AsyncTask {
+	asyncfunc_t func;
+	void* arg;
+	AsyncTask* next;
+};
+
+// Heap allocated and never freed: the worker outlives static destructors at exit
+struct AsyncQueue {
+	std::mutex lock;
+	std::condition_variable wake;
+	AsyncTask* head;
+	AsyncTask* tail;
+};
+
+static AsyncQueue* g_AsyncQueue;
+
+static void Sys_AsyncWorker(AsyncQueue* queue) {
+	while (true) {
+		AsyncTask* task;
+		{
+			std::unique_lock<std::mutex> guard(queue->lock);
+			while (!queue->head)
+				queue->wake.wait(guard);
+
+			task = queue->head;
+			queue->head = task->next;
+			if (!queue->head)
+				queue->tail = NULL;
+		}
+
+		int64 start = Sys_ThreadCpuTime();
+		task->func(task->arg);
+		g_WorkerCpuTime += Sys_ThreadCpuTime() - start;
+		delete task;
+	}
+}
+
+void Sys_QueueAsync(asyncfunc_t func, void* arg) {
+	if (!g_AsyncQueue) {
+		g_AsyncQueue = new AsyncQueue();
+		g_AsyncQueue->head = g_AsyncQueue->tail = NULL;
+		std::thread(Sys_AsyncWorker, g_AsyncQueue).detach();
+	}
+
+	AsyncTask* task = new AsyncTask;
+	task->func = func;
+	task->arg = arg;
+	task->next = NULL;
+
+	std::lock_guard<std::mutex> guard(g_AsyncQueue->lock);
+	if (g_AsyncQueue->tail)
+		g_AsyncQueue->tail->next = task;
+	else
+		g_AsyncQueue->head = task;
+
+	g_AsyncQueue->tail = task;
+	g_AsyncQueue->wake.notify_one();
+}
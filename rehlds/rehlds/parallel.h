@@ -0,0 +1,41 @@
+/*
+*
+*    This program is free software; you can redistribute it and/or modify it
+*    under the terms of the GNU General Public License as published by the
+*    Free Software Foundation; either version 2 of the License, or (at
+*    your option) any later version.
+*
+*    This program is distributed in the hope that it will be useful, but
+*    WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+*    General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with this program; if not, write to the Free Software Foundation,
+*    Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+#pragma once
+#include "osconfig.h"
+#include "archtypes.h"
+
+#define MAX_PARALLEL_THREADS	16
+
+// Processes items [first, last); thread is in [0, Sys_ParallelThreads()) and can index per-thread accumulators
+typedef void (*parallelfunc_t)(void *arg, int first, int last, int thread);
+
+extern int Sys_ParallelThreads();
+
+// Runs func over [0, count) in chunks of chunkSize items on worker threads and the calling one.
+// Returns when all items are done. The workers are started on first use and kept, so it is cheap enough
+// to call every frame. A call made while another one runs (nested or from another thread) does all the work itself
+extern void Sys_ParallelFor(int count, int chunkSize, parallelfunc_t func, void *arg);
+
+typedef void (*asyncfunc_t)(void *arg);
+
+// Runs func(arg) on a single background thread, in queueing order. The caller tracks completion itself
+extern void Sys_QueueAsync(asyncfunc_t func, void *arg);
+
+// CPU time in nanoseconds spent so far by Sys_ParallelFor workers (not the calling thread) and the async thread.
+// Always 0 on Windows
+extern int64 Sys_WorkerCpuTime();
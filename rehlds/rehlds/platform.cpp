@@ -85,6 +85,10 @@ void CSimplePlatform::GetSystemTimeAsFileTime(LPFILETIME lpSystemTimeAsFileTime)
 {
 	::GetSystemTimeAsFileTime(lpSystemTimeAsFileTime);
 }
+#else //WIN32
+int CSimplePlatform::clock_gettime(clockid_t clockId, struct timespec* ts) {
+	return ::clock_gettime(clockId, ts);
+}
 #endif //WIN32
 
 SOCKET CSimplePlatform::socket(int af, int type, int protocol) {
@@ -95,7 +99,7 @@ int CSimplePlatform::setsockopt(SOCKET s, int level, int optname, const char* op
 #ifdef _WIN32
 	return setsockopt_v11(s, level, optname, optval, optlen);
 #else
-	return setsockopt(s, level, optname, optval, optlen);
+	return ::setsockopt(s, level, optname, optval, optlen);
 #endif
 }
 
@@ -131,17 +135,22 @@ int CSimplePlatform::gethostname(char *name, int namelen) {
 	return ::gethostname(name, namelen);
 }
 
-#ifdef _WIN32
-
 int CSimplePlatform::ioctlsocket(SOCKET s, long cmd, u_long *argp) {
+#ifdef _WIN32
 	return ::ioctlsocket(s, cmd, argp);
+#else
+	return ::ioctl(s, cmd, argp);
+#endif
 }
 
 int CSimplePlatform::WSAGetLastError() {
+#ifdef _WIN32
 	return ::WSAGetLastError();
+#else
+	return errno;
+#endif
 }
 
-#endif //WIN32
 void CSimplePlatform::SteamAPI_SetBreakpadAppID(uint32 unAppID) {
 	return ::SteamAPI_SetBreakpadAppID(unAppID);
 }
@@ -25,6 +25,8 @@ public:
 	virtual void GetTimeZoneInfo(LPTIME_ZONE_INFORMATION zinfo) = 0;
 	virtual BOOL GetProcessTimes(HANDLE hProcess, LPFILETIME lpCreationTime, LPFILETIME lpExitTime, LPFILETIME lpKernelTime, LPFILETIME lpUserTime) = 0;
 	virtual void GetSystemTimeAsFileTime(LPFILETIME lpSystemTimeAsFileTime) = 0;
+#else
+	virtual int clock_gettime(clockid_t clockId, struct timespec* ts) = 0;
 #endif
 
 	virtual SOCKET socket(int af, int type, int protocol) = 0;
@@ -37,10 +39,8 @@ public:
 	virtual struct hostent* gethostbyname(const char *name) = 0;
 	virtual int gethostname(char *name, int namelen) = 0;
 
-#ifdef _WIN32
 	virtual int ioctlsocket(SOCKET s, long cmd, u_long *argp) = 0;
 	virtual int WSAGetLastError() = 0;
-#endif
 
 	virtual void SteamAPI_SetBreakpadAppID(uint32 unAppID) = 0;
 	virtual void SteamAPI_UseBreakpadCrashHandler(char const *pchVersion, char const *pchDate, char const *pchTime, bool bFullMemoryDumps, void *pvContext, PFNPreMinidumpCallback m_pfnPreMinidumpCallback) = 0;
@@ -80,6 +80,8 @@ public:
 	virtual void GetTimeZoneInfo(LPTIME_ZONE_INFORMATION zinfo);
 	virtual BOOL GetProcessTimes(HANDLE hProcess, LPFILETIME lpCreationTime, LPFILETIME lpExitTime, LPFILETIME lpKernelTime, LPFILETIME lpUserTime);
 	virtual void GetSystemTimeAsFileTime(LPFILETIME lpSystemTimeAsFileTime);
+#else
+	virtual int clock_gettime(clockid_t clockId, struct timespec* ts);
 #endif
 
 	virtual SOCKET socket(int af, int type, int protocol);
@@ -92,10 +94,8 @@ public:
 	virtual struct hostent* gethostbyname(const char *name);
 	virtual int gethostname(char *name, int namelen);
 
-#ifdef _WIN32
 	virtual int ioctlsocket(SOCKET s, long cmd, u_long *argp);
 	virtual int WSAGetLastError();
-#endif
 
 	virtual void SteamAPI_SetBreakpadAppID(uint32 unAppID);
 	virtual void SteamAPI_UseBreakpadCrashHandler(char const *pchVersion, char const *pchDate, char const *pchTime, bool bFullMemoryDumps, void *pvContext, PFNPreMinidumpCallback m_pfnPreMinidumpCallback);
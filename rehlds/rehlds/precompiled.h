@@ -47,6 +47,9 @@
 #include "sys_linuxwnd.h"
 
 #include "iengine.h"
+#include "frame_profiler.h"
+#include "dll_profiler.h"
+#include "metrics_export.h"
 #include "hookchains_impl.h"
 #include "rehlds_interfaces.h"
 #include "rehlds_interfaces_impl.h"
@@ -54,6 +57,8 @@
 #include "rehlds_api_impl.h"
 #include "FlightRecorderImpl.h"
 #include "flight_recorder.h"
+#include "parallel.h"
+#include "frame_scheduler.h"
 #include "rehlds_security.h"
 
 #include "dlls/cdll_dll.h"
@@ -121,7 +121,8 @@ RehldsFuncs_t g_RehldsApiFuncs =
 	&MSG_EndBitWriting_api,
 	&SZ_GetSpace,
 	&GetCvarVars_api,
-	&SV_GetChallenge
+	&SV_GetChallenge,
+	&TraceBatch
 };
 
 sizebuf_t* EXT_FUNC GetNetMessage_api()
@@ -142,6 +143,37 @@ extern int* EXT_FUNC GetMsgReadCount_api()
 	return &msg_readcount;
 }
 
+CRehldsHookchains::CRehldsHookchains()
+{
+	m_Steam_NotifyClientConnect.setName("Steam_NotifyClientConnect");
+	m_SV_ConnectClient.setName("SV_ConnectClient");
+	m_SV_GetIDString.setName("SV_GetIDString");
+	m_SV_SendServerinfo.setName("SV_SendServerinfo");
+	m_SV_CheckProtocol.setName("SV_CheckProtocol");
+	m_SVC_GetChallenge_mod.setName("SVC_GetChallenge_mod");
+	m_SV_CheckKeyInfo.setName("SV_CheckKeyInfo");
+	m_SV_CheckIPRestrictions.setName("SV_CheckIPRestrictions");
+	m_SV_FinishCertificateCheck.setName("SV_FinishCertificateCheck");
+	m_Steam_NotifyBotConnect.setName("Steam_NotifyBotConnect");
+	m_SerializeSteamId.setName("SerializeSteamId");
+	m_SV_CompareUserID.setName("SV_CompareUserID");
+	m_Steam_NotifyClientDisconnect.setName("Steam_NotifyClientDisconnect");
+	m_PreprocessPacket.setName("PreprocessPacket");
+	m_ValidateCommand.setName("ValidateCommand");
+	m_ClientConnected.setName("ClientConnected");
+	m_HandleNetCommand.setName("HandleNetCommand");
+	m_Mod_LoadBrushModel.setName("Mod_LoadBrushModel");
+	m_Mod_LoadStudioModel.setName("Mod_LoadStudioModel");
+	m_ExecuteServerStringCmd.setName("ExecuteServerStringCmd");
+	m_SV_EmitEvents.setName("SV_EmitEvents");
+	m_EV_PlayReliableEvent.setName("EV_PlayReliableEvent");
+	m_SV_StartSound.setName("SV_StartSound");
+	m_PF_Remove_I.setName("PF_Remove_I");
+	m_PF_BuildSoundMsg_I.setName("PF_BuildSoundMsg_I");
+	m_SV_WriteFullClientUpdate.setName("SV_WriteFullClientUpdate");
+	m_GenericFileConsistencyResponce.setName("GenericFileConsistencyResponce");
+}
+
 IRehldsHookRegistry_Steam_NotifyClientConnect* CRehldsHookchains::Steam_NotifyClientConnect()
 {
 	return &m_Steam_NotifyClientConnect;
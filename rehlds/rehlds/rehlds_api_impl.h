@@ -170,6 +170,8 @@ public:
 	CRehldsHookRegistry_GenericFileConsistencyResponce m_GenericFileConsistencyResponce;
 
 public:
+	CRehldsHookchains();
+
 	virtual IRehldsHookRegistry_Steam_NotifyClientConnect* Steam_NotifyClientConnect();
 	virtual IRehldsHookRegistry_SV_ConnectClient* SV_ConnectClient();
 	virtual IRehldsHookRegistry_SV_GetIDString* SV_GetIDString();
@@ -191,6 +191,10 @@ sizebuf_t* EXT_FUNC CRehldsServerData::GetReliableDatagram() {
 	return &g_psv.reliable_datagram;
 }
 
+void EXT_FUNC CRehldsServerData::GetCpuStats(RehldsCpuStats_t* stats) {
+	*stats = g_HostCpuStats;
+}
+
 void Rehlds_Interfaces_FreeClients() 
 {
 	if (g_GameClients == NULL)
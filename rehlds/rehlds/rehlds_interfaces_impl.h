@@ -99,6 +99,8 @@ public:
 	virtual sizebuf_t* GetReliableDatagram();
 
 	virtual void SetModelName(const char* modelname);
+
+	virtual void GetCpuStats(RehldsCpuStats_t* stats);
 };
 
 extern CGameClient** g_GameClients;
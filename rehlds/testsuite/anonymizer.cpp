@@ -521,6 +521,7 @@ int CAnonymizingEngExtInterceptor::rand()
 	return res;
 }
 
+#ifdef _WIN32
 void CAnonymizingEngExtInterceptor::Sleep(DWORD msec)
 {
 	m_BasePlatform->Sleep(msec);
@@ -569,6 +570,12 @@ void CAnonymizingEngExtInterceptor::GetSystemTimeAsFileTime(LPFILETIME lpSystemT
 {
 	m_BasePlatform->GetSystemTimeAsFileTime(lpSystemTimeAsFileTime);
 }
+#else //_WIN32
+int CAnonymizingEngExtInterceptor::clock_gettime(clockid_t clockId, struct timespec* ts)
+{
+	return m_BasePlatform->clock_gettime(clockId, ts);
+}
+#endif //_WIN32
 
 SOCKET CAnonymizingEngExtInterceptor::socket(int af, int type, int protocol)
 {
@@ -1,5 +1,4 @@
 #pragma once
-#ifdef _WIN32
 
 #include "osconfig.h"
 #include "testsuite.h"
@@ -181,6 +180,7 @@ public:
 	virtual void srand(uint32 seed);
 	virtual int rand();
 
+#ifdef _WIN32
 	virtual void Sleep(DWORD msec);
 	virtual BOOL QueryPerfCounter(LARGE_INTEGER* counter);
 	virtual BOOL QueryPerfFreq(LARGE_INTEGER* freq);
@@ -190,6 +190,9 @@ public:
 	virtual void GetTimeZoneInfo(LPTIME_ZONE_INFORMATION zinfo);
 	virtual BOOL GetProcessTimes(HANDLE hProcess, LPFILETIME lpCreationTime, LPFILETIME lpExitTime, LPFILETIME lpKernelTime, LPFILETIME lpUserTime);
 	virtual void GetSystemTimeAsFileTime(LPFILETIME lpSystemTimeAsFileTime);
+#else
+	virtual int clock_gettime(clockid_t clockId, struct timespec* ts);
+#endif
 
 	virtual SOCKET socket(int af, int type, int protocol);
 	virtual int ioctlsocket(SOCKET s, long cmd, u_long *argp);
@@ -225,5 +228,3 @@ public:
 
 
 };
-
-#endif //_WIN32
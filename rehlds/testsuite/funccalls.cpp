@@ -1,5 +1,6 @@
 #include "precompiled.h"
 
+#ifdef _WIN32
 void PrintSystemTime(LPSYSTEMTIME t, std::stringstream &ss)
 {
 	ss << "{"
@@ -21,6 +22,7 @@ void PrintFileTime(LPFILETIME t, std::stringstream &ss)
 		<< " lowDate: " << t->dwLowDateTime
 		<< " }";
 }
+#endif //_WIN32
 
 void PrintTm(struct tm* t, std::stringstream &ss) {
 	ss << "{"
@@ -72,6 +74,7 @@ bool CompareSockAddrs(void* ps1, void* ps2) {
 	return 0 == memcmp(ps1, ps2, compareSize);
 }
 
+#ifdef _WIN32
 /* ============================================================================
                                  CSleepExtCall
 ============================================================================ */
@@ -305,6 +308,51 @@ void CGetTimeZoneInfoCall::readEpilogue(std::istream &stream) {
 	stream.read((char*)&m_Res, sizeof(m_Res));
 }
 
+#else //_WIN32
+/* ============================================================================
+                               CClockGetTimeCall
+============================================================================ */
+CClockGetTimeCall::CClockGetTimeCall(clockid_t clockId)
+{
+	m_ClockId = clockId;
+	m_Sec = 0;
+	m_Nsec = 0;
+	m_Res = 0;
+}
+
+std::string CClockGetTimeCall::toString()
+{
+	std::stringstream ss;
+	ss << "clock_gettime(" << m_ClockId << ") => { tv_sec: " << m_Sec << " tv_nsec: " << m_Nsec << " } " << m_Res;
+	return ss.str();
+}
+
+bool CClockGetTimeCall::compareInputArgs(IEngExtCall* other, bool strict)
+{
+	CClockGetTimeCall* otherCall = dynamic_cast<CClockGetTimeCall*>(other);
+	if (otherCall == NULL)
+		return false;
+
+	return otherCall->m_ClockId == m_ClockId;
+}
+
+void CClockGetTimeCall::writePrologue(std::ostream &stream) {
+	stream.write((char*)&m_ClockId, 4);
+}
+
+void CClockGetTimeCall::readPrologue(std::istream &stream) {
+	stream.read((char*)&m_ClockId, 4);
+}
+
+void CClockGetTimeCall::writeEpilogue(std::ostream &stream) {
+	stream.write((char*)&m_Sec, 8).write((char*)&m_Nsec, 4).write((char*)&m_Res, 4);
+}
+
+void CClockGetTimeCall::readEpilogue(std::istream &stream) {
+	stream.read((char*)&m_Sec, 8).read((char*)&m_Nsec, 4).read((char*)&m_Res, 4);
+}
+#endif //_WIN32
+
 
 
 
@@ -2783,6 +2831,7 @@ void CGetHostByNameCall::readEpilogue(std::istream &stream) {
 
 
 
+#ifdef _WIN32
 /* ============================================================================
                            CGetProcessTimesCall
 ============================================================================ */
@@ -2871,6 +2920,7 @@ void CGetSystemTimeAsFileTimeCall::writeEpilogue(std::ostream &stream) {
 void CGetSystemTimeAsFileTimeCall::readEpilogue(std::istream &stream) {
 	stream.read((char*)&m_SystemTime, sizeof(m_SystemTime));
 }
+#endif //_WIN32
 
 
 
@@ -3206,6 +3256,7 @@ virtual void readEpilogue(std::istream &stream);
 
 IEngExtCall* IEngExtCallFactory::createByOpcode(ExtCallFuncs opc, void* buf, int ptrSize) {
 	switch (opc) {
+#ifdef _WIN32
 	case ECF_SLEEP:	IEngExtCallFactory_CreateFuncCall(CSleepExtCall, buf, ptrSize);
 	case ECF_QUERY_PERF_FREQ: IEngExtCallFactory_CreateFuncCall(CQueryPerfFreqCall, buf, ptrSize);
 	case ECF_QUERY_PERF_COUNTER: IEngExtCallFactory_CreateFuncCall(CQueryPerfCounterCall, buf, ptrSize);
@@ -3213,6 +3264,9 @@ IEngExtCall* IEngExtCallFactory::createByOpcode(ExtCallFuncs opc, void* buf, int
 	case ECF_GET_LOCAL_TIME: IEngExtCallFactory_CreateFuncCall(CGetLocalTimeCall, buf, ptrSize);
 	case ECF_GET_SYSTEM_TIME: IEngExtCallFactory_CreateFuncCall(CGetSystemTimeCall, buf, ptrSize);
 	case ECF_GET_TIMEZONE_INFO: IEngExtCallFactory_CreateFuncCall(CGetTimeZoneInfoCall, buf, ptrSize);
+#else //_WIN32
+	case ECF_CLOCK_GETTIME: IEngExtCallFactory_CreateFuncCall(CClockGetTimeCall, buf, ptrSize);
+#endif //_WIN32
 
 	case ECF_SOCKET: IEngExtCallFactory_CreateFuncCall(CSocketCall, buf, ptrSize);
 	case ECF_IOCTL_SOCKET: IEngExtCallFactory_CreateFuncCall(CIoCtlSocketCall, buf, ptrSize);
@@ -3264,8 +3318,10 @@ IEngExtCall* IEngExtCallFactory::createByOpcode(ExtCallFuncs opc, void* buf, int
 	case ECF_GET_HOST_BY_NAME: IEngExtCallFactory_CreateFuncCall(CGetHostByNameCall, buf, ptrSize);
 	case ECF_GET_HOST_NAME: IEngExtCallFactory_CreateFuncCall(CGetHostNameCall, buf, ptrSize);
 	
+#ifdef _WIN32
 	case ECF_GET_PROCESS_TIMES: IEngExtCallFactory_CreateFuncCall(CGetProcessTimesCall, buf, ptrSize);
 	case ECF_GET_SYSTEM_TIME_AS_FILE_TIME: IEngExtCallFactory_CreateFuncCall(CGetSystemTimeAsFileTimeCall, buf, ptrSize);
+#endif //_WIN32
 
 	case ECF_CSTD_TIME: IEngExtCallFactory_CreateFuncCall(CStdTimeCall, buf, ptrSize);
 	case ECF_CSTD_LOCALTIME: IEngExtCallFactory_CreateFuncCall(CStdLocalTimeCall, buf, ptrSize);
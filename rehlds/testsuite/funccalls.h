@@ -1,5 +1,4 @@
 #pragma once
-#ifdef _WIN32
 
 #include "osconfig.h"
 
@@ -121,6 +120,8 @@ enum ExtCallFuncs {
 	ECF_STEAM_API_UNREGISTER_CALLBACK = 62,
 
 	ECF_GS_BLOGGEDON = 63,
+
+	ECF_CLOCK_GETTIME = 64,
 };
 
 struct CSteamCallbackState_t {
@@ -169,6 +170,7 @@ public:
 	virtual ExtCallFuncs getOpcode() { return ECF_NONE; }
 };
 
+#ifdef _WIN32
 class CSleepExtCall : public IEngExtCall {
 public:
 	DWORD m_Time;
@@ -276,6 +278,28 @@ public:
 	virtual void writeEpilogue(std::ostream &stream);
 	virtual void readEpilogue(std::istream &stream);
 };
+#else //_WIN32
+class CClockGetTimeCall : public IEngExtCall {
+public:
+	int m_ClockId;
+	int64 m_Sec;
+	int32 m_Nsec;
+	int m_Res;
+
+public:
+	CClockGetTimeCall() { m_ClockId = 0; m_Sec = 0; m_Nsec = 0; m_Res = 0; }
+	CClockGetTimeCall(clockid_t clockId);
+
+	void SetResult(struct timespec* ts, int res) { m_Sec = ts->tv_sec; m_Nsec = ts->tv_nsec; m_Res = res; }
+	virtual bool compareInputArgs(IEngExtCall* other, bool strict);
+	virtual std::string toString();
+	virtual ExtCallFuncs getOpcode() { return ECF_CLOCK_GETTIME; }
+	virtual void writePrologue(std::ostream &stream);
+	virtual void readPrologue(std::istream &stream);
+	virtual void writeEpilogue(std::ostream &stream);
+	virtual void readEpilogue(std::istream &stream);
+};
+#endif //_WIN32
 
 class CSocketCall : public IEngExtCall {
 public:
@@ -1102,6 +1126,7 @@ public:
 	virtual void readEpilogue(std::istream &stream);
 };
 
+#ifdef _WIN32
 class CGetProcessTimesCall : public IEngExtCall {
 public:
 	BOOL m_Res;
@@ -1141,6 +1166,7 @@ public:
 	virtual void writeEpilogue(std::ostream &stream);
 	virtual void readEpilogue(std::istream &stream);
 };
+#endif //_WIN32
 
 class CStdTimeCall : public IEngExtCall {
 public:
@@ -1268,5 +1294,3 @@ public:
 	virtual void writeEpilogue(std::ostream &stream);
 	virtual void readEpilogue(std::istream &stream);
 };
-
-#endif
@@ -1,5 +1,16 @@
 #include "precompiled.h"
 
+static DWORD TestPlayer_GetTickCount()
+{
+#ifdef _WIN32
+	return ::GetTickCount();
+#else
+	struct timespec ts;
+	::clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (DWORD)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+#endif
+}
+
 CPlayingEngExtInterceptor::CPlayingEngExtInterceptor(const char* fname, bool strictChecks)
 {
 	for (int i = 0; i < TESTPLAYER_FUNCTREE_DEPTH; i++)
@@ -51,7 +62,7 @@ CPlayingEngExtInterceptor::CPlayingEngExtInterceptor(const char* fname, bool str
 	m_InStream.read(cmdLine, cmdlineLen);
 	printf("Playing testsuite\nrecorders's cmdline: %s\n", cmdLine);
 
-	m_StartTick = ::GetTickCount();
+	m_StartTick = TestPlayer_GetTickCount();
 	m_NumFrames = 0;
 }
 
@@ -138,6 +149,48 @@ IEngExtCall* CPlayingEngExtInterceptor::getNextCallInternal(bool peek) {
 	return next;
 }
 
+void CPlayingEngExtInterceptor::writeDemoStats(DWORD duration)
+{
+	double framesPerSec = duration ? m_NumFrames * 1000.0 / duration : 0.0;
+	bool benchmark = g_RehldsRuntimeConfig.testPlayerMode == TPM_BENCHMARK;
+
+	FILE* fl = fopen("rehlds_demo_stats.xml", "w");
+	if (fl) {
+		fprintf(fl, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+		fprintf(fl, "<DemoStats>\n");
+		fprintf(fl, "  <Duration>%u</Duration>\n", duration);
+		fprintf(fl, "  <NumFrames>%u</NumFrames>\n", m_NumFrames);
+
+		if (benchmark) {
+			fprintf(fl, "  <FramesPerSec>%.1f</FramesPerSec>\n", framesPerSec);
+			for (int i = 0; i < FPROF_NUM_PHASES; i++) {
+				FrameProfileSummary summary;
+				if (!FrameProfile_GetSummary((FrameProfilePhase)i, &summary))
+					continue;
+
+				fprintf(fl, "  <Phase name=\"%s\" count=\"%lld\" meanUs=\"%.1f\" p50Us=\"%.1f\" p99Us=\"%.1f\" maxUs=\"%.1f\" />\n",
+					FrameProfile_PhaseName((FrameProfilePhase)i), (long long)summary.count, summary.meanUs, summary.p50Us, summary.p99Us, summary.maxUs);
+			}
+		}
+
+		fprintf(fl, "</DemoStats>\n");
+		fclose(fl);
+	}
+
+	if (benchmark) {
+		printf("Benchmark: %u frames in %u ms (%.1f frames/sec)\n", m_NumFrames, duration, framesPerSec);
+		for (int i = 0; i < FPROF_NUM_PHASES; i++) {
+			FrameProfileSummary summary;
+			if (!FrameProfile_GetSummary((FrameProfilePhase)i, &summary))
+				continue;
+
+			printf("  %-22s p50 %8.1f us  p99 %8.1f us  max %8.1f us\n",
+				FrameProfile_PhaseName((FrameProfilePhase)i), summary.p50Us, summary.p99Us, summary.maxUs);
+		}
+		fflush(stdout);
+	}
+}
+
 IEngExtCall* CPlayingEngExtInterceptor::getNextCall(bool peek, bool processCallbacks, ExtCallFuncs expectedOpcode, bool needStart, const char* callSource) {
 	int size = (int)m_InStream.tellg();
 	int sizeLeft = m_inStreamSize - size;
@@ -148,17 +201,13 @@ IEngExtCall* CPlayingEngExtInterceptor::getNextCall(bool peek, bool processCallb
 	}
 
 	if (cmd->getOpcode() == ECF_NONE) {
-		DWORD endTick = ::GetTickCount();
-		FILE* fl = fopen("rehlds_demo_stats.xml", "w");
-		if (fl) {
-			fprintf(fl, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
-			fprintf(fl, "<DemoStats>\n");
-			fprintf(fl, "  <Duration>%u</Duration>\n", (endTick - m_StartTick));
-			fprintf(fl, "  <NumFrames>%u</NumFrames>\n", m_NumFrames);
-			fprintf(fl, "</DemoStats>\n");
-			fclose(fl);
-		}
+		DWORD endTick = TestPlayer_GetTickCount();
+		writeDemoStats(endTick - m_StartTick);
+#ifdef _WIN32
 		TerminateProcess(GetCurrentProcess(), 777);
+#else
+		_exit(777);
+#endif
 	}
 
 	IEngCallbackCall* callback = dynamic_cast<IEngCallbackCall*>(cmd);
@@ -308,6 +357,7 @@ int CPlayingEngExtInterceptor::rand()
 	return res;
 }
 
+#ifdef _WIN32
 void CPlayingEngExtInterceptor::Sleep(DWORD msec) {
 	CSleepExtCall* playCall = dynamic_cast<CSleepExtCall*>(getNextCall(false, false, ECF_SLEEP, true, __FUNCTION__));
 	CSleepExtCall(msec).ensureArgsAreEqual(playCall, m_bStrictChecks, __FUNCTION__);
@@ -395,6 +445,21 @@ void CPlayingEngExtInterceptor::GetSystemTimeAsFileTime(LPFILETIME lpSystemTimeA
 	memcpy(lpSystemTimeAsFileTime, &playEndCall->m_SystemTime, sizeof(FILETIME));
 	freeFuncCall(playCall); freeFuncCall(playEndCall);
 }
+#else //_WIN32
+int CPlayingEngExtInterceptor::clock_gettime(clockid_t clockId, struct timespec* ts) {
+	CClockGetTimeCall* playCall = dynamic_cast<CClockGetTimeCall*>(getNextCall(false, false, ECF_CLOCK_GETTIME, true, __FUNCTION__));
+	CClockGetTimeCall(clockId).ensureArgsAreEqual(playCall, m_bStrictChecks, __FUNCTION__);
+	CClockGetTimeCall* playEndCall = dynamic_cast<CClockGetTimeCall*>(getNextCall(false, true, ECF_CLOCK_GETTIME, false, __FUNCTION__));
+
+	ts->tv_sec = (time_t)playEndCall->m_Sec;
+	ts->tv_nsec = playEndCall->m_Nsec;
+	int res = playEndCall->m_Res;
+	freeFuncCall(playCall); freeFuncCall(playEndCall);
+
+	return res;
+}
+
+#endif //_WIN32
 
 
 SOCKET CPlayingEngExtInterceptor::socket(int af, int type, int protocol) {
@@ -1,5 +1,4 @@
 #pragma once
-#ifdef _WIN32
 
 #define TESTPLAYER_FUNCTREE_DEPTH 8
 #define TESTPLAYER_FUNCCALL_MAXSIZE 17000
@@ -8,8 +7,10 @@
 #include "funccalls.h"
 #include "rehlds/platform.h"
 
+#include "stdsani_in.h"
 #include <queue>
 #include <unordered_map>
+#include "stdsani_out.h"
 
 class CPlayingEngExtInterceptor;
 
@@ -162,6 +163,7 @@ public:
 	void freeFuncCall(void* fcall);
 	CPlayingEngExtInterceptor(const char* fname, bool strictChecks);
 
+	void writeDemoStats(DWORD duration);
 	IEngExtCall* getNextCall(bool peek, bool processCallbacks, ExtCallFuncs expectedOpcode, bool needStart, const char* callSource);
 
 	virtual uint32 time(uint32* pTime);
@@ -169,6 +171,7 @@ public:
 	virtual void srand(uint32 seed);
 	virtual int rand();
 
+#ifdef _WIN32
 	virtual void Sleep(DWORD msec);
 	virtual BOOL QueryPerfCounter(LARGE_INTEGER* counter);
 	virtual BOOL QueryPerfFreq(LARGE_INTEGER* freq);
@@ -178,6 +181,9 @@ public:
 	virtual void GetTimeZoneInfo(LPTIME_ZONE_INFORMATION zinfo);
 	virtual BOOL GetProcessTimes(HANDLE hProcess, LPFILETIME lpCreationTime, LPFILETIME lpExitTime, LPFILETIME lpKernelTime, LPFILETIME lpUserTime);
 	virtual void GetSystemTimeAsFileTime(LPFILETIME lpSystemTimeAsFileTime);
+#else
+	virtual int clock_gettime(clockid_t clockId, struct timespec* ts);
+#endif
 
 
 	virtual SOCKET socket(int af, int type, int protocol);
@@ -205,5 +211,3 @@ public:
 	virtual void SteamGameServer_Shutdown();
 	virtual void SteamAPI_UnregisterCallback(CCallbackBase *pCallback);
 };
-
-#endif //_WIN32
@@ -503,6 +503,34 @@ SteamAPICall_t CSteamGameServerRecordingWrapper::ComputeNewPlayerCompatibility(C
 	return k_uAPICallInvalid;
 }
 
+#ifndef _WIN32
+static const char* TestRecorder_GetCommandLine()
+{
+	static char cmdLine[2048];
+
+	FILE* fl = fopen("/proc/self/cmdline", "rb");
+	if (!fl) {
+		return "";
+	}
+
+	size_t len = fread(cmdLine, 1, sizeof(cmdLine) - 1, fl);
+	fclose(fl);
+
+	// Arguments are NUL-separated, join them the way GetCommandLine() would
+	while (len > 0 && cmdLine[len - 1] == '\0') {
+		len--;
+	}
+
+	for (size_t i = 0; i < len; i++) {
+		if (cmdLine[i] == '\0')
+			cmdLine[i] = ' ';
+	}
+
+	cmdLine[len] = '\0';
+	return cmdLine;
+}
+#endif // _WIN32
+
 CRecordingEngExtInterceptor::CRecordingEngExtInterceptor(const char* fname, IReHLDSPlatform* basePlatform)
 {
 	m_OutStream.exceptions(std::ios::badbit | std::ios::failbit);
@@ -520,7 +548,11 @@ CRecordingEngExtInterceptor::CRecordingEngExtInterceptor(const char* fname, IReH
 	uint16 versionMinor = TESTSUITE_PROTOCOL_VERSION_MINOR;
 	m_OutStream.write((char*)&versionMinor, 2).write((char*)&versionMajor, 2);
 
+#ifdef _WIN32
 	const char* cmdLine = GetCommandLineA();
+#else
+	const char* cmdLine = TestRecorder_GetCommandLine();
+#endif
 	int cmdLineLength = strlen(cmdLine) + 1;
 
 	m_OutStream.write((char*)&cmdLineLength, 4);
@@ -576,7 +608,14 @@ void CRecordingEngExtInterceptor::PopFunc(CRecorderFuncCall* func)
 	if (func != m_LastFunc)
 		rehlds_syserror("%s: stack corrupted", __FUNCTION__);
 
+#ifndef _WIN32
+	// the engine reads errno of the intercepted call after we return, writing the record must not change it
+	int savedErrno = errno;
 	writeCall(!func->m_StartWritten, true, func->m_FuncCall);
+	errno = savedErrno;
+#else
+	writeCall(!func->m_StartWritten, true, func->m_FuncCall);
+#endif
 	if (m_LastFunc->m_Prev == NULL) {
 		m_LastFunc = m_RootFunc = NULL;
 	}
@@ -628,6 +667,7 @@ int CRecordingEngExtInterceptor::rand()
 	return res;
 }
 
+#ifdef _WIN32
 void CRecordingEngExtInterceptor::Sleep(DWORD msec)
 {
 	CSleepExtCall fcall(msec); CRecorderFuncCall frec(&fcall);
@@ -711,6 +751,17 @@ void CRecordingEngExtInterceptor::GetSystemTimeAsFileTime(LPFILETIME lpSystemTim
 	fcall.setResult(lpSystemTimeAsFileTime);
 	PopFunc(&frec);
 }
+#else //_WIN32
+int CRecordingEngExtInterceptor::clock_gettime(clockid_t clockId, struct timespec* ts)
+{
+	CClockGetTimeCall fcall(clockId); CRecorderFuncCall frec(&fcall);
+	PushFunc(&frec);
+	int res = m_BasePlatform->clock_gettime(clockId, ts);
+	fcall.SetResult(ts, res);
+	PopFunc(&frec);
+	return res;
+}
+#endif //_WIN32
 
 SOCKET CRecordingEngExtInterceptor::socket(int af, int type, int protocol)
 {
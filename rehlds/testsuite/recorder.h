@@ -1,5 +1,4 @@
 #pragma once
-#ifdef _WIN32
 
 #include "osconfig.h"
 #include "testsuite.h"
@@ -163,6 +162,7 @@ public:
 	virtual void srand(uint32 seed);
 	virtual int rand();
 
+#ifdef _WIN32
 	virtual void Sleep(DWORD msec);
 	virtual BOOL QueryPerfCounter(LARGE_INTEGER* counter);
 	virtual BOOL QueryPerfFreq(LARGE_INTEGER* freq);
@@ -172,6 +172,9 @@ public:
 	virtual void GetTimeZoneInfo(LPTIME_ZONE_INFORMATION zinfo);
 	virtual BOOL GetProcessTimes(HANDLE hProcess, LPFILETIME lpCreationTime, LPFILETIME lpExitTime, LPFILETIME lpKernelTime, LPFILETIME lpUserTime);
 	virtual void GetSystemTimeAsFileTime(LPFILETIME lpSystemTimeAsFileTime);
+#else
+	virtual int clock_gettime(clockid_t clockId, struct timespec* ts);
+#endif
 
 	virtual SOCKET socket(int af, int type, int protocol);
 	virtual int ioctlsocket(SOCKET s, long cmd, u_long *argp);
@@ -198,4 +201,3 @@ public:
 	virtual void SteamGameServer_Shutdown();
 	virtual void SteamAPI_UnregisterCallback(CCallbackBase *pCallback);
 };
-#endif //_WIN32
\ No newline at end of file
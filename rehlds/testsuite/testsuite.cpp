@@ -1,5 +1,6 @@
 #include "precompiled.h"
 
+#ifdef _WIN32
 
 /* ============================================================================
                                 external function hooks
@@ -485,6 +486,8 @@ void TestSuite_InstallCStdHooks(const AddressRef* funcRefs) {
 	}
 }
 
+#endif //_WIN32
+
 void TestSuite_InitAnonymizer(CAnonymizingEngExtInterceptor& a) {
 
 }
@@ -497,10 +500,13 @@ void TestSuite_Init(const Module* engine, const Module* executable, const Addres
 		CRehldsPlatformHolder::set(new CRecordingEngExtInterceptor(g_RehldsRuntimeConfig.testRecordingFileName, CRehldsPlatformHolder::get()));
 		needInstallImportTableHooks = true;
 	}
-	else if (g_RehldsRuntimeConfig.testPlayerMode == TPM_PLAY)
+	else if (g_RehldsRuntimeConfig.testPlayerMode == TPM_PLAY || g_RehldsRuntimeConfig.testPlayerMode == TPM_BENCHMARK)
 	{
 		CRehldsPlatformHolder::set(new CPlayingEngExtInterceptor(g_RehldsRuntimeConfig.testRecordingFileName, true));
 		needInstallImportTableHooks = true;
+
+		if (g_RehldsRuntimeConfig.testPlayerMode == TPM_BENCHMARK)
+			FrameProfile_ForceEnable();
 	}
 	else if (g_RehldsRuntimeConfig.testPlayerMode == TPM_ANONYMIZE)
 	{
@@ -514,6 +520,7 @@ void TestSuite_Init(const Module* engine, const Module* executable, const Addres
 		needInstallImportTableHooks = true;
 	}
 
+#ifdef _WIN32
 	if (needInstallImportTableHooks) {
 		if (engine != NULL) {
 			TestSuite_InstallHooks(engine);
@@ -525,5 +532,7 @@ void TestSuite_Init(const Module* engine, const Module* executable, const Addres
 			TestSuite_InstallCStdHooks(funcRefs);
 		}
 	}
+#endif //_WIN32
+	// On Linux there's nothing to patch: the engine is built from this tree and makes every recorded call through CRehldsPlatformHolder
 }
 
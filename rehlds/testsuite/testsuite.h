@@ -1,18 +1,17 @@
 #pragma once
-#ifdef _WIN32
 
 #include "osconfig.h"
 #include "memory.h"
 #include "rehlds/platform.h"
 
+#include "stdsani_in.h"
 #include <string>
 #include <iostream>
 #include <fstream>
 #include <unordered_map>
+#include "stdsani_out.h"
 
-#define TESTSUITE_PROTOCOL_VERSION_MINOR 5
+#define TESTSUITE_PROTOCOL_VERSION_MINOR 6
 #define TESTSUITE_PROTOCOL_VERSION_MAJOR 0
 
 void TestSuite_Init(const Module* engine, const Module* executable, const AddressRef* funcRefs);
-
-#endif
\ No newline at end of file
@@ -0,0 +1,232 @@
+#include "precompiled.h"
+#include "rehlds_tests_shared.h"
+#include "cppunitlite/TestHarness.h"
+
+#ifdef REHLDS_OPT_PEDANTIC
+
+#define PASTEST_NUMLEAFS	700
+#define PASTEST_ROWS		((PASTEST_NUMLEAFS + 7) / 8)
+
+// Same run-length scheme CM_DecompressPVS reads: nonzero bytes as is, zero runs as 0, count
+static int PASTest_Compress(const byte *in, int len, byte *out) {
+	int outlen = 0;
+	for (int i = 0; i < len; ) {
+		if (in[i]) {
+			out[outlen++] = in[i++];
+			continue;
+		}
+
+		int run = 0;
+		while (i < len && !in[i] && run < 255) {
+			i++;
+			run++;
+		}
+		out[outlen++] = 0;
+		out[outlen++] = run;
+	}
+	return outlen;
+}
+
+TEST(CalcPASMatchesReference, CModel, 5000) {
+	EngineInitializer engInitGuard;
+
+	static byte pvs[PASTEST_NUMLEAFS + 1][PASTEST_ROWS];
+	static byte pas[PASTEST_NUMLEAFS + 1][PASTEST_ROWS];
+	static byte compressed[PASTEST_NUMLEAFS + 1][PASTEST_ROWS * 2];
+	static mleaf_t leafs[PASTEST_NUMLEAFS + 1];
+	model_t model;
+
+	TestRandom rnd(0x5EED1234);
+	Q_memset(&model, 0, sizeof(model));
+	Q_memset(leafs, 0, sizeof(leafs));
+	Q_memset(pvs, 0, sizeof(pvs));
+	model.numleafs = PASTEST_NUMLEAFS;
+	model.leafs = leafs;
+
+	for (int i = 0; i <= PASTEST_NUMLEAFS; i++) {
+		// leaf 0 has no vis data and is decompressed as "all visible"
+		if (i == 0) {
+			leafs[i].compressed_vis = NULL;
+			Q_memset(pvs[i], 0xFF, PASTEST_ROWS);
+			continue;
+		}
+
+		for (int j = 0; j < PASTEST_NUMLEAFS; j++) {
+			if (rnd.Rand() % 100 < 3)
+				pvs[i][j >> 3] |= 1 << (j & 7);
+		}
+
+		PASTest_Compress(pvs[i], PASTEST_ROWS, compressed[i]);
+		leafs[i].compressed_vis = compressed[i];
+	}
+
+	for (int i = 0; i <= PASTEST_NUMLEAFS; i++) {
+		Q_memcpy(pas[i], pvs[i], PASTEST_ROWS);
+		for (int j = 0; j < PASTEST_NUMLEAFS; j++) {
+			if (pvs[i][j >> 3] & (1 << (j & 7))) {
+				for (int k = 0; k < PASTEST_ROWS; k++)
+					pas[i][k] |= pvs[j + 1][k];
+			}
+		}
+	}
+
+	CM_CalcPAS(&model);
+
+	for (int i = 0; i <= PASTEST_NUMLEAFS; i++) {
+		MEM_EQUAL("PVS row mismatch", pvs[i], CM_LeafPVS(i), PASTEST_ROWS);
+		MEM_EQUAL("PAS row mismatch", pas[i], CM_LeafPAS(i), PASTEST_ROWS);
+	}
+
+	CM_FreePAS();
+}
+
+// Fat rows span (numleafs + 31) >> 3 bytes; with this count they end exactly at the 4-byte aligned vis row
+#define FATTEST_NUMLEAFS	225
+#define FATTEST_ROWS		((FATTEST_NUMLEAFS + 7) / 8)
+#define FATTEST_FATBYTES	((FATTEST_NUMLEAFS + 31) >> 3)
+#define FATTEST_NUMPLANES	64
+#define FATTEST_NUMORIGINS	64
+#define FATTEST_NUMQUERIES	20000
+
+struct fattestworld_t {
+	mnode_t nodes[FATTEST_NUMLEAFS];
+	mleaf_t leafs[FATTEST_NUMLEAFS + 1];
+	mplane_t planes[FATTEST_NUMPLANES];
+	int numnodes;
+};
+
+// Random split of leafs [firstleaf, firstleaf + numleafs) under one subtree
+static mnode_t *FatTest_BuildNode(TestRandom &rnd, fattestworld_t *world, int firstleaf, int numleafs) {
+	if (numleafs == 1)
+		return (mnode_t *)&world->leafs[firstleaf];
+
+	mnode_t *node = &world->nodes[world->numnodes++];
+	int split = 1 + rnd.Rand() % (numleafs - 1);
+
+	node->contents = 0;
+	node->plane = &world->planes[rnd.Rand() % FATTEST_NUMPLANES];
+	node->children[0] = FatTest_BuildNode(rnd, world, firstleaf, split);
+	node->children[1] = FatTest_BuildNode(rnd, world, firstleaf + split, numleafs - split);
+	return node;
+}
+
+// Moves org along a random plane's normal to land on the fat set margin
+static void FatTest_SnapToMargin(TestRandom &rnd, const fattestworld_t *world, vec_t *org) {
+	const mplane_t *plane = &world->planes[rnd.Rand() % FATTEST_NUMPLANES];
+	float d = _DotProduct(org, plane->normal) - plane->dist;
+	float target = (rnd.Rand() & 1) ? 8.0f : -8.0f;
+
+	for (int i = 0; i < 3; i++)
+		org[i] += plane->normal[i] * (target - d);
+}
+
+TEST(FatSetCacheMatchesUncached, CModel, 5000) {
+	EngineInitializer engInitGuard;
+
+	static fattestworld_t world;
+	static byte compressed[FATTEST_NUMLEAFS + 1][FATTEST_ROWS * 2];
+	static byte pvsrows[FATSET_CACHE_SIZE * FATTEST_FATBYTES];
+	static byte pasrows[FATSET_CACHE_SIZE * FATTEST_FATBYTES];
+	byte row[FATTEST_ROWS];
+	byte refpvs[FATTEST_FATBYTES];
+	byte refpas[FATTEST_FATBYTES];
+	vec3_t origins[FATTEST_NUMORIGINS];
+	model_t model;
+
+	TestRandom rnd(0xFA75E7);
+	Q_memset(&world, 0, sizeof(world));
+	Q_memset(&model, 0, sizeof(model));
+
+	for (int i = 0; i < FATTEST_NUMPLANES; i++) {
+		mplane_t *plane = &world.planes[i];
+
+		if (i & 1) {
+			plane->type = (i >> 1) % 3;
+			plane->normal[plane->type] = 1.0f;
+		}
+		else {
+			plane->normal[0] = rnd.RandFloat(-1.0f, 1.0f);
+			plane->normal[1] = rnd.RandFloat(-1.0f, 1.0f);
+			plane->normal[2] = rnd.RandFloat(-1.0f, 1.0f);
+			VectorNormalize(plane->normal);
+			plane->type = 3 + (i >> 1) % 3;
+		}
+
+		plane->dist = rnd.RandFloat(-64.0f, 64.0f);
+	}
+
+	// leaf 0 is the shared solid leaf, as in a compiled map
+	world.leafs[0].contents = CONTENTS_SOLID;
+	for (int i = 1; i <= FATTEST_NUMLEAFS; i++) {
+		world.leafs[i].contents = (rnd.Rand() % 8) ? CONTENTS_EMPTY : CONTENTS_SOLID;
+
+		Q_memset(row, 0, sizeof(row));
+		for (int j = 0; j < FATTEST_NUMLEAFS; j++) {
+			if (rnd.Rand() % 100 < 5)
+				row[j >> 3] |= 1 << (j & 7);
+		}
+
+		PASTest_Compress(row, FATTEST_ROWS, compressed[i]);
+		world.leafs[i].compressed_vis = compressed[i];
+	}
+
+	FatTest_BuildNode(rnd, &world, 1, FATTEST_NUMLEAFS);
+	model.numleafs = FATTEST_NUMLEAFS;
+	model.leafs = world.leafs;
+	model.nodes = world.nodes;
+
+	CM_CalcPAS(&model);
+
+	model_t *savedWorld = g_psv.worldmodel;
+	g_psv.worldmodel = &model;
+
+	Q_memset(&sv_fatpvscache, 0, sizeof(sv_fatpvscache));
+	Q_memset(&sv_fatpascache, 0, sizeof(sv_fatpascache));
+	sv_fatpvscache.rows = pvsrows;
+	sv_fatpvscache.rowbytes = FATTEST_FATBYTES;
+	sv_fatpascache.rows = pasrows;
+	sv_fatpascache.rowbytes = FATTEST_FATBYTES;
+
+	for (int i = 0; i < FATTEST_NUMORIGINS; i++) {
+		for (int j = 0; j < 3; j++)
+			origins[i][j] = rnd.RandFloat(-80.0f, 80.0f);
+
+		if (i & 1)
+			FatTest_SnapToMargin(rnd, &world, origins[i]);
+	}
+
+	for (int i = 0; i < FATTEST_NUMQUERIES; i++) {
+		vec3_t org;
+		const vec_t *base = origins[rnd.Rand() % FATTEST_NUMORIGINS];
+
+		// mostly repeat a few spots so both caches see hits, replaced entries and margin cases
+		for (int j = 0; j < 3; j++)
+			org[j] = base[j] + ((rnd.Rand() % 4) ? 0.0f : rnd.RandFloat(-2.0f, 2.0f));
+
+		if (rnd.Rand() % 8 == 0)
+			FatTest_SnapToMargin(rnd, &world, org);
+
+		fatbytes = FATTEST_FATBYTES;
+		Q_memset(fatpvs, 0, fatbytes);
+		SV_AddToFatPVS(org, model.nodes);
+		Q_memcpy(refpvs, fatpvs, sizeof(refpvs));
+
+		fatpasbytes = FATTEST_FATBYTES;
+		Q_memset(fatpas, 0, fatpasbytes);
+		SV_AddToFatPAS(org, model.nodes);
+		Q_memcpy(refpas, fatpas, sizeof(refpas));
+
+		MEM_EQUAL("Fat PVS mismatch", refpvs, SV_FatPVS(org), FATTEST_FATBYTES);
+		MEM_EQUAL("Fat PAS mismatch", refpas, SV_FatPAS(org), FATTEST_FATBYTES);
+	}
+
+	CHECK("Fat PVS cache never hit", sv_fatpvscache.hits > 0);
+	CHECK("Fat PAS cache never hit", sv_fatpascache.hits > 0);
+
+	Q_memset(&sv_fatpvscache, 0, sizeof(sv_fatpvscache));
+	Q_memset(&sv_fatpascache, 0, sizeof(sv_fatpascache));
+	g_psv.worldmodel = savedWorld;
+	CM_FreePAS();
+}
+
+#endif // REHLDS_OPT_PEDANTIC
@@ -366,3 +366,87 @@ TEST(TestDelta_Test, Delta, 1000) {
 			rehlds_syserror("TestDelta_Test: returned bitcount %i is not equal to true value %i", tested, result[i]);
 	}
 }
+
+#ifdef REHLDS_OPT_PEDANTIC
+TEST(WriteDeltaStats_Test, Delta, 1000) {
+	EngineInitializer engInitGuard;
+
+	delta_t* delta = _CreateTestDeltaDesc();
+	DELTA_ClearStats(delta);
+	sv_delta_stats.value = 1.0f;
+
+	delta_test_struct_t from, to;
+	_FillTestDelta(&from, 0xCC);
+	_FillTestDelta(&to, 0xCC);
+
+	// change byte + short + float
+	to.b_01 = 1;
+	to.s_12 = 1;
+	to.f_08 = 1.0;
+
+	uint8 data[512];
+	sizebuf_t buf;
+	Q_memset(&buf, 0, sizeof(buf));
+	buf.buffername = "WriteDeltaStats_Test";
+	buf.data = data;
+	buf.maxsize = sizeof(data);
+
+	MSG_StartBitWriting(&buf);
+	DELTA_WriteDelta((uint8 *)&from, (uint8 *)&to, FALSE, delta, NULL);
+	DELTA_WriteDelta((uint8 *)&from, (uint8 *)&from, FALSE, delta, NULL);
+	int written = MSG_BitsWritten();
+	MSG_EndBitWriting(&buf);
+
+	sv_delta_stats.value = 0.0f;
+
+	CHECK("Field bits", delta->pdd[1].stats.sentbits == 8 && delta->pdd[8].stats.sentbits == 16 && delta->pdd[4].stats.sentbits == 32);
+	CHECK("Field sends", delta->pdd[1].stats.sendcount == 1 && delta->pdd[0].stats.sendcount == 0);
+	LONGS_EQUAL("Writes", 2, delta->totals.writes);
+	LONGS_EQUAL("Unchanged writes", 1, delta->totals.unchanged);
+	LONGS_EQUAL("Field bits total", 8 + 16 + 32, delta->totals.fieldbits);
+	LONGS_EQUAL("Header bits", 3 + 2 * 8, delta->totals.headerbits);
+	LONGS_EQUAL("Bits written", written, delta->totals.headerbits + delta->totals.fieldbits);
+}
+
+TEST(WriteDeltaStatsReplay_Test, Delta, 1000) {
+	EngineInitializer engInitGuard;
+
+	delta_t* delta = _CreateTestDeltaDesc();
+	DELTA_ClearStats(delta);
+	sv_delta_stats.value = 1.0f;
+
+	delta_test_struct_t from, to;
+	_FillTestDelta(&from, 0xCC);
+	_FillTestDelta(&to, 0xCC);
+	to.b_01 = 1;
+	to.s_12 = 1;
+
+	uint8 data[512];
+	sizebuf_t buf;
+	Q_memset(&buf, 0, sizeof(buf));
+	buf.buffername = "WriteDeltaStatsReplay_Test";
+	buf.data = data;
+	buf.maxsize = sizeof(data);
+
+	delta_record_t record;
+	DELTA_StatsStartRecord(&record);
+	MSG_StartBitWriting(&buf);
+	DELTA_WriteDelta((uint8 *)&from, (uint8 *)&to, FALSE, delta, NULL);
+	int written = MSG_BitsWritten();
+	MSG_EndBitWriting(&buf);
+	DELTA_StatsEndRecord();
+
+	LONGS_EQUAL("Recorded write counted", 0, delta->totals.writes);
+	LONGS_EQUAL("Recorded field counted", 0, delta->pdd[1].stats.sendcount);
+
+	// the cached encoding is sent to two clients
+	DELTA_StatsReplay(delta, &record);
+	DELTA_StatsReplay(delta, &record);
+	sv_delta_stats.value = 0.0f;
+
+	LONGS_EQUAL("Writes", 2, delta->totals.writes);
+	LONGS_EQUAL("Field sends", 2, delta->pdd[8].stats.sendcount);
+	CHECK("Field bits", delta->pdd[1].stats.sentbits == 2 * 8 && delta->pdd[8].stats.sentbits == 2 * 16);
+	LONGS_EQUAL("Bits written", 2 * written, delta->totals.headerbits + delta->totals.fieldbits);
+}
+#endif // REHLDS_OPT_PEDANTIC
@@ -0,0 +1,73 @@
+#include "precompiled.h"
+#include "rehlds_tests_shared.h"
+#include "cppunitlite/TestHarness.h"
+
+typedef IHookChainRegistryImpl<int, int> CTestHookRegistry;
+typedef IHookChain<int, int> CTestHookChain;
+
+static char g_HookTrace[64];
+static CTestHookRegistry* g_TestRegistry;
+
+static int TestHook_Original(int v) {
+	strcat(g_HookTrace, "o");
+	return v * 10;
+}
+
+static int TestHook_A(CTestHookChain* chain, int v) {
+	strcat(g_HookTrace, "a");
+	return chain->callNext(v + 1);
+}
+
+static int TestHook_B(CTestHookChain* chain, int v) {
+	strcat(g_HookTrace, "b");
+	return chain->callNext(v) + chain->callNext(v);
+}
+
+static int TestHook_RemoveSelf(CTestHookChain* chain, int v) {
+	strcat(g_HookTrace, "r");
+	g_TestRegistry->unregisterHook(&TestHook_RemoveSelf);
+	return chain->callNext(v);
+}
+
+TEST(CallOrder, HookChains, 1000) {
+	CTestHookRegistry registry;
+	g_HookTrace[0] = 0;
+
+	LONGS_EQUAL("empty chain result", 50, registry.callChain(&TestHook_Original, 5));
+	ZSTR_EQUAL("empty chain trace", "o", g_HookTrace);
+
+	registry.registerHook(&TestHook_A);
+	registry.registerHook(&TestHook_B);
+	g_HookTrace[0] = 0;
+
+	// b calls the rest of the chain twice, the cursor must be restored in between
+	LONGS_EQUAL("chain result", 120, registry.callChain(&TestHook_Original, 5));
+	ZSTR_EQUAL("chain trace", "aboo", g_HookTrace);
+
+	registry.unregisterHook(&TestHook_B);
+	g_HookTrace[0] = 0;
+	LONGS_EQUAL("last hook removed result", 60, registry.callChain(&TestHook_Original, 5));
+	ZSTR_EQUAL("last hook removed trace", "ao", g_HookTrace);
+
+	registry.unregisterHook(&TestHook_A);
+	CHECK("registry is empty", registry.isEmpty());
+}
+
+TEST(UnregisterDuringCall, HookChains, 1000) {
+	CTestHookRegistry registry;
+	g_TestRegistry = &registry;
+
+	registry.registerHook(&TestHook_RemoveSelf);
+	registry.registerHook(&TestHook_A);
+	g_HookTrace[0] = 0;
+
+	// The running dispatch keeps the hooks it started with
+	LONGS_EQUAL("first call result", 60, registry.callChain(&TestHook_Original, 5));
+	ZSTR_EQUAL("first call trace", "rao", g_HookTrace);
+
+	g_HookTrace[0] = 0;
+	LONGS_EQUAL("second call result", 60, registry.callChain(&TestHook_Original, 5));
+	ZSTR_EQUAL("second call trace", "ao", g_HookTrace);
+
+	g_TestRegistry = NULL;
+}
@@ -166,3 +166,54 @@ TEST(GetKeyValue, Info, 1000) {
 		ZSTR_EQUAL("Invalid info value", d->result, res);
 	}
 }
+
+#ifdef REHLDS_OPT_PEDANTIC
+TEST(GetKeyValueCached, Info, 1000) {
+	EngineInitializer engInitGuard;
+
+	struct testdata_t {
+		const char* info;
+		const char* key;
+	};
+
+	testdata_t testdata[] = {
+		{ "", "a" },
+		{ "\\a\\b", "a" },
+		{ "\\a\\", "a" },
+		{ "\\a\\\\", "a" },
+		{ "\\a", "a" },
+		{ "a\\b", "a" },
+		{ "\\a\\b\\c\\d\\e\\f", "d" },
+		{ "\\a\\b\\c\\d\\e\\f", "c" },
+		{ "a\\b\\c\\d\\e\\f", "e" },
+		{ "\\a\\b\\a\\c", "a" },
+		{ "\\\\b\\a\\c", "" },
+		{ "\\\\b\\a\\c", "a" },
+	};
+
+	static infocache_t cache;
+	Info_InvalidateCache(&cache);
+
+	for (int i = 0; i < ARRAYSIZE(testdata); i++) {
+		testdata_t* d = &testdata[i];
+
+		char expected[MAX_KV_LEN];
+		strcpy(expected, Info_ValueForKey(d->info, d->key));
+
+		const char* res = Info_CachedValueForKey(&cache, d->info, d->key);
+		ZSTR_EQUAL("Invalid cached info value", expected, res);
+	}
+
+	// the view follows changes of the string
+	char localInfo[256];
+	strcpy(localInfo, "\\name\\player\\rate\\25000");
+	ZSTR_EQUAL("Invalid cached info value", "25000", Info_CachedValueForKey(&cache, localInfo, "rate"));
+
+	Info_SetValueForKey(localInfo, "rate", "100000", sizeof(localInfo));
+	ZSTR_EQUAL("Invalid cached info value", "100000", Info_CachedValueForKey(&cache, localInfo, "rate"));
+	ZSTR_EQUAL("Invalid cached info value", "player", Info_CachedValueForKey(&cache, localInfo, "name"));
+
+	Info_RemoveKey(localInfo, "name");
+	ZSTR_EQUAL("Invalid cached info value", "", Info_CachedValueForKey(&cache, localInfo, "name"));
+}
+#endif // REHLDS_OPT_PEDANTIC
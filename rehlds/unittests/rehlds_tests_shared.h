@@ -15,4 +15,23 @@ public:
 	~EngineInitializer() {
 		Tests_ShutdownEngine();
 	}
-};
\ No newline at end of file
+};
+
+// Deterministic LCG for the randomized tests: a fixed seed always rebuilds the same scene
+class TestRandom {
+public:
+	TestRandom(uint32 seed) : m_Seed(seed) {
+	}
+
+	uint32 Rand() {
+		m_Seed = m_Seed * 1103515245 + 12345;
+		return (m_Seed >> 8) & 0xFFFF;
+	}
+
+	float RandFloat(float lo, float hi) {
+		return lo + (hi - lo) * (Rand() / 65535.0f);
+	}
+
+private:
+	uint32 m_Seed;
+};
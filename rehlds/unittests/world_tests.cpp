@@ -0,0 +1,290 @@
+#include "precompiled.h"
+#include "rehlds_tests_shared.h"
+#include "cppunitlite/TestHarness.h"
+
+#ifdef REHLDS_OPT_PEDANTIC
+
+#define HULLTEST_NUMNODES	256
+#define HULLTEST_NUMPLANES	128
+#define HULLTEST_NUMRAYS	20000
+
+// Random but well-formed hull: children always point forward, so every walk terminates
+static void HullTest_BuildHull(TestRandom &rnd, hull_t *hull, dclipnode_t *clipnodes, mplane_t *planes) {
+	static const int leafContents[] = { CONTENTS_EMPTY, CONTENTS_SOLID, CONTENTS_WATER, CONTENTS_SOLID };
+
+	for (int i = 0; i < HULLTEST_NUMPLANES; i++) {
+		mplane_t *plane = &planes[i];
+		Q_memset(plane, 0, sizeof(*plane));
+
+		if (i & 1) {
+			plane->type = (i >> 1) % 3;
+			plane->normal[plane->type] = 1.0f;
+		}
+		else {
+			plane->normal[0] = rnd.RandFloat(-1.0f, 1.0f);
+			plane->normal[1] = rnd.RandFloat(-1.0f, 1.0f);
+			plane->normal[2] = rnd.RandFloat(-1.0f, 1.0f);
+			VectorNormalize(plane->normal);
+			plane->type = 3 + (i >> 1) % 3;
+		}
+
+		plane->dist = rnd.RandFloat(-96.0f, 96.0f);
+	}
+
+	for (int i = 0; i < HULLTEST_NUMNODES; i++) {
+		dclipnode_t *node = &clipnodes[i];
+		node->planenum = rnd.Rand() % HULLTEST_NUMPLANES;
+
+		for (int j = 0; j < 2; j++) {
+			int remaining = HULLTEST_NUMNODES - i - 1;
+			if (remaining > 0 && (rnd.Rand() % 4) != 0)
+				node->children[j] = i + 1 + rnd.Rand() % min(remaining, 8);
+			else
+				node->children[j] = leafContents[rnd.Rand() % ARRAYSIZE(leafContents)];
+		}
+	}
+
+	Q_memset(hull, 0, sizeof(*hull));
+	hull->clipnodes = clipnodes;
+	hull->planes = planes;
+	hull->firstclipnode = 0;
+	hull->lastclipnode = HULLTEST_NUMNODES - 1;
+}
+
+// Reference point contents straight from the dclipnode_t array, independent of the packed nodes
+static int HullTest_PointContents(const hull_t *hull, const vec_t *p) {
+	int num = hull->firstclipnode;
+	while (num >= 0) {
+		const dclipnode_t *node = &hull->clipnodes[num];
+		const mplane_t *plane = &hull->planes[node->planenum];
+
+		float d;
+		if (plane->type >= 3)
+			d = _DotProduct(p, plane->normal) - plane->dist;
+		else
+			d = p[plane->type] - plane->dist;
+
+		num = node->children[(d >= 0.0f) ? 0 : 1];
+	}
+
+	return num;
+}
+
+static void HullTest_RandomRay(TestRandom &rnd, vec3_t start, vec3_t end) {
+	for (int i = 0; i < 3; i++) {
+		start[i] = rnd.RandFloat(-128.0f, 128.0f);
+		end[i] = rnd.RandFloat(-128.0f, 128.0f);
+	}
+
+	// axis-aligned rays are the common case for player movement
+	if (rnd.Rand() % 4 == 0) {
+		int axis = rnd.Rand() % 3;
+		for (int i = 0; i < 3; i++) {
+			if (i != axis)
+				end[i] = start[i];
+		}
+	}
+}
+
+TEST(PackedHullTraceMatchesUnpacked, World, 5000) {
+	EngineInitializer engInitGuard;
+
+	static dclipnode_t clipnodes[HULLTEST_NUMNODES];
+	static mplane_t planes[HULLTEST_NUMPLANES];
+	hull_t hull;
+
+	TestRandom rnd(0x1F2E3D4C);
+	HullTest_BuildHull(rnd, &hull, clipnodes, planes);
+
+	Mod_ClearPackedHulls();
+	CHECK("Unregistered hull must not be packed", Mod_FindPackedClipnodes(&hull) == NULL);
+
+	packedclipnode_t *nodes = Mod_PackClipnodes(clipnodes, HULLTEST_NUMNODES, planes, HULLTEST_NUMPLANES);
+	CHECK("Packing failed", nodes != NULL);
+	CHECK("Packed hull lookup failed", Mod_FindPackedClipnodes(&hull) == nodes);
+	CHECK("Packed nodes are not cache line aligned", ((size_t)nodes & 63) == 0);
+
+	for (int i = 0; i < HULLTEST_NUMRAYS; i++) {
+		vec3_t start, end;
+		HullTest_RandomRay(rnd, start, end);
+
+		trace_t svRef, svPacked;
+		Q_memset(&svRef, 0, sizeof(svRef));
+		svRef.fraction = 1.0f;
+		svRef.allsolid = TRUE;
+		svRef.endpos[0] = end[0];
+		svRef.endpos[1] = end[1];
+		svRef.endpos[2] = end[2];
+		Q_memcpy(&svPacked, &svRef, sizeof(svPacked));
+
+		// the unpacked walks query point contents internally, hide the registration so they stay on dclipnode_t
+		mod_numpackedhulls = 0;
+		SV_RecursiveHullCheck_Unpacked(&hull, hull.firstclipnode, 0.0f, 1.0f, start, end, &svRef);
+		mod_numpackedhulls = 1;
+		SV_RecursiveHullCheck(&hull, hull.firstclipnode, 0.0f, 1.0f, start, end, &svPacked);
+		MEM_EQUAL("SV trace mismatch", (uint8 *)&svRef, (uint8 *)&svPacked, sizeof(trace_t));
+
+		pmtrace_t pmRef, pmPacked;
+		Q_memset(&pmRef, 0, sizeof(pmRef));
+		pmRef.fraction = 1.0f;
+		pmRef.allsolid = TRUE;
+		pmRef.endpos[0] = end[0];
+		pmRef.endpos[1] = end[1];
+		pmRef.endpos[2] = end[2];
+		Q_memcpy(&pmPacked, &pmRef, sizeof(pmPacked));
+
+		mod_numpackedhulls = 0;
+		PM_RecursiveHullCheck_Unpacked(&hull, hull.firstclipnode, 0.0f, 1.0f, start, end, &pmRef);
+		mod_numpackedhulls = 1;
+		PM_RecursiveHullCheck(&hull, hull.firstclipnode, 0.0f, 1.0f, start, end, &pmPacked);
+		MEM_EQUAL("PM trace mismatch", (uint8 *)&pmRef, (uint8 *)&pmPacked, sizeof(pmtrace_t));
+
+		int contents = HullTest_PointContents(&hull, start);
+		LONGS_EQUAL("SV point contents mismatch", contents, SV_HullPointContents(&hull, hull.firstclipnode, start));
+		LONGS_EQUAL("PM point contents mismatch", contents, PM_HullPointContents(&hull, hull.firstclipnode, start));
+	}
+
+	Mod_ClearPackedHulls();
+}
+
+#define BATCHTEST_NUMEDICTS		97
+#define BATCHTEST_NUMREQUESTS	4000
+
+static void BatchTest_SetAbsBox(edict_t *pent) {
+	for (int i = 0; i < 3; i++) {
+		pent->v.absmin[i] = pent->v.origin[i] + pent->v.mins[i];
+		pent->v.absmax[i] = pent->v.origin[i] + pent->v.maxs[i];
+	}
+}
+
+// Refuses some pairs so the CLIPLINK_STOP_NODE path of the clipping walk gets exercised
+static int BatchTest_ShouldCollide(edict_t *pentTouched, edict_t *pentOther) {
+	int touched = pentTouched - g_psv.edicts;
+	int other = pentOther ? pentOther - g_psv.edicts : 0;
+	return ((touched * 7 + other) % 11) != 0;
+}
+
+TEST(TraceBatchMatchesSerial, World, 5000) {
+	EngineInitializer engInitGuard;
+
+	static dclipnode_t clipnodes[HULLTEST_NUMNODES];
+	static mplane_t planes[HULLTEST_NUMPLANES];
+	static edict_t edicts[BATCHTEST_NUMEDICTS];
+	static RehldsTraceRequest_t requests[BATCHTEST_NUMREQUESTS];
+	static TraceResult serial[BATCHTEST_NUMREQUESTS];
+	static TraceResult batch[BATCHTEST_NUMREQUESTS];
+	model_t worldModel, boxModel;
+
+	DLL_FUNCTIONS oldEntityInterface = gEntityInterface;
+	NEW_DLL_FUNCTIONS oldNewDLLFunctions = gNewDLLFunctions;
+	gEntityInterface.pfnSetAbsBox = BatchTest_SetAbsBox;
+	gNewDLLFunctions.pfnShouldCollide = BatchTest_ShouldCollide;
+
+	TestRandom rnd(0x7A3B9C1D);
+	Mod_ClearPackedHulls();
+
+	Q_memset(&worldModel, 0, sizeof(worldModel));
+	worldModel.type = mod_brush;
+	HullTest_BuildHull(rnd, &worldModel.hulls[0], clipnodes, planes);
+	for (int i = 1; i < 4; i++) {
+		worldModel.hulls[i] = worldModel.hulls[0];
+		for (int j = 0; j < 3; j++) {
+			worldModel.hulls[i].clip_mins[j] = gHullMins[i][j];
+			worldModel.hulls[i].clip_maxs[j] = gHullMaxs[i][j];
+		}
+	}
+	for (int i = 0; i < 3; i++) {
+		worldModel.mins[i] = -128.0f;
+		worldModel.maxs[i] = 128.0f;
+	}
+
+	Q_memset(&boxModel, 0, sizeof(boxModel));
+	boxModel.type = mod_sprite;
+
+	Q_memset(edicts, 0, sizeof(edicts));
+	g_psv.edicts = edicts;
+	g_psv.worldmodel = &worldModel;
+	g_psv.models[1] = &worldModel;
+	g_psv.models[2] = &boxModel;
+
+	edicts[0].v.solid = SOLID_BSP;
+	edicts[0].v.movetype = MOVETYPE_PUSH;
+	edicts[0].v.modelindex = 1;
+
+	SV_ClearWorld();
+
+	// small boxes all over the areanode tree, with the flags SV_ClipToLinkedEdict looks at
+	static const int solids[] = { SOLID_BBOX, SOLID_SLIDEBOX, SOLID_BBOX, SOLID_NOT };
+	for (int i = 1; i < BATCHTEST_NUMEDICTS; i++) {
+		edict_t *ent = &edicts[i];
+
+		for (int j = 0; j < 3; j++) {
+			ent->v.origin[j] = rnd.RandFloat(-120.0f, 120.0f);
+			ent->v.mins[j] = -rnd.RandFloat(2.0f, 24.0f);
+			ent->v.maxs[j] = rnd.RandFloat(2.0f, 24.0f);
+			ent->v.size[j] = ent->v.maxs[j] - ent->v.mins[j];
+		}
+
+		ent->v.solid = solids[rnd.Rand() % ARRAYSIZE(solids)];
+		ent->v.movetype = (rnd.Rand() % 4 == 0) ? MOVETYPE_PUSHSTEP : MOVETYPE_STEP;
+		if (rnd.Rand() % 4 == 0)
+			ent->v.flags |= FL_MONSTER;
+		if (rnd.Rand() % 8 == 0)
+			ent->v.rendermode = kRenderTransAlpha;
+		if (rnd.Rand() % 8 == 0)
+			ent->v.owner = &edicts[1 + rnd.Rand() % (BATCHTEST_NUMEDICTS - 1)];
+
+		// SV_LinkEdict looks for touched leafs of entities with a model, the scene has no leafs
+		SV_LinkEdict(ent, FALSE);
+		ent->v.modelindex = 2;
+	}
+
+	// moves come in clusters, as from one entity's think, so the batch shares areanode walks
+	static const int noMonsters[] = { 0, 1, 2, 0x100 };
+	vec3_t center;
+	for (int i = 0; i < BATCHTEST_NUMREQUESTS; i++) {
+		RehldsTraceRequest_t *req = &requests[i];
+
+		if (i % 8 == 0) {
+			for (int j = 0; j < 3; j++)
+				center[j] = rnd.RandFloat(-112.0f, 112.0f);
+		}
+
+		for (int j = 0; j < 3; j++) {
+			req->start[j] = center[j] + rnd.RandFloat(-8.0f, 8.0f);
+			req->end[j] = center[j] + rnd.RandFloat(-64.0f, 64.0f);
+		}
+
+		req->hullNumber = (int)(rnd.Rand() % 5) - 1;
+		req->fNoMonsters = noMonsters[rnd.Rand() % ARRAYSIZE(noMonsters)];
+		req->pentToSkip = (rnd.Rand() % 3 == 0) ? NULL : &edicts[rnd.Rand() % BATCHTEST_NUMEDICTS];
+	}
+
+	Q_memset(serial, 0, sizeof(serial));
+	Q_memset(batch, 0, sizeof(batch));
+
+	for (int i = 0; i < BATCHTEST_NUMREQUESTS; i++) {
+		const RehldsTraceRequest_t *req = &requests[i];
+		if (req->hullNumber < 0)
+			PF_traceline_DLL(req->start, req->end, req->fNoMonsters, req->pentToSkip, &serial[i]);
+		else
+			TraceHull(req->start, req->end, req->fNoMonsters, req->hullNumber, req->pentToSkip, &serial[i]);
+	}
+
+	gGlobalVariables.trace_ent = &edicts[5];
+	TraceBatch(requests, batch, BATCHTEST_NUMREQUESTS);
+	CHECK("TraceBatch changed trace_ent", gGlobalVariables.trace_ent == &edicts[5]);
+
+	for (int i = 0; i < BATCHTEST_NUMREQUESTS; i++) {
+		MEM_EQUAL("TraceBatch result mismatch", (uint8 *)&serial[i], (uint8 *)&batch[i], sizeof(TraceResult));
+	}
+
+	gEntityInterface = oldEntityInterface;
+	gNewDLLFunctions = oldNewDLLFunctions;
+	g_psv.edicts = NULL;
+	g_psv.worldmodel = NULL;
+	g_psv.models[1] = NULL;
+	g_psv.models[2] = NULL;
+}
+
+#endif // REHLDS_OPT_PEDANTIC